@@ -0,0 +1,31 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdlib>
+
+// Shared by the benchmarks, see README.md
+
+class Bench_Timer {
+  std::chrono::steady_clock::time_point start;
+
+public:
+  Bench_Timer() : start(std::chrono::steady_clock::now()) {}
+  double seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+};
+
+// The optional argument at position index, or fallback when it wasn't given.
+inline long bench_arg(int argc, char **argv, int index, long fallback) {
+  return (argc > index) ? atol(argv[index]) : fallback;
+}
+
+// Keeps the optimizer from dropping a result that is never used.
+template <typename T>
+inline void bench_keep(T const &value) {
+  asm volatile(""
+               :
+               : "g"(&value)
+               : "memory");
+}
+
+#endif // BENCH_H
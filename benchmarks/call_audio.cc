@@ -0,0 +1,160 @@
+// Turning a Call's Transmission WAVs into the call WAV and M4A, with the
+// nativeAudio functions and with the sox and fdkaac commands the Call
+// Concluder runs otherwise. The commands are only timed if sox and fdkaac
+// are on the PATH.
+//
+// usage: call_audio [calls] [transmissions per call] [seconds per transmission]
+
+#include "bench.h"
+
+#include "../trunk-recorder/call_concluder/native_audio.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static void write_le(FILE *fp, uint32_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) {
+    fputc((value >> (8 * i)) & 0xff, fp);
+  }
+}
+
+// A 16 bit mono WAV like the ones transmission_sink writes
+static void write_transmission(const char *filename, const std::vector<int16_t> &samples, unsigned int sample_rate) {
+  FILE *fp = fopen(filename, "wb");
+  uint32_t data_size = samples.size() * sizeof(int16_t);
+
+  fwrite("RIFF", 1, 4, fp);
+  write_le(fp, 36 + data_size, 4);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  write_le(fp, 16, 4);
+  write_le(fp, 1, 2);
+  write_le(fp, 1, 2);
+  write_le(fp, sample_rate, 4);
+  write_le(fp, sample_rate * 2, 4);
+  write_le(fp, 2, 2);
+  write_le(fp, 16, 2);
+  fwrite("data", 1, 4, fp);
+  write_le(fp, data_size, 4);
+  for (size_t i = 0; i < samples.size(); i++) {
+    write_le(fp, (uint16_t)samples[i], 2);
+  }
+  fclose(fp);
+}
+
+int main(int argc, char **argv) {
+  long calls = bench_arg(argc, argv, 1, 20);
+  long transmission_count = bench_arg(argc, argv, 2, 10);
+  long seconds = bench_arg(argc, argv, 3, 3);
+  const unsigned int sample_rate = 8000;
+  std::mt19937 rng(1);
+  std::normal_distribution<double> noise(0, 300);
+
+  char dir[] = "/tmp/call_audio_XXXXXX";
+  if (!mkdtemp(dir)) {
+    perror("mkdtemp");
+    return 1;
+  }
+
+  // Speech-like audio: a few tones plus noise, at different levels per transmission
+  std::vector<Transmission> transmissions(transmission_count);
+  std::string files;
+  for (long t = 0; t < transmission_count; t++) {
+    std::vector<int16_t> samples(seconds * sample_rate);
+    double level = 2000 + 1000 * t;
+    for (size_t i = 0; i < samples.size(); i++) {
+      double x = level * (sin(2 * M_PI * 440 * i / sample_rate) + 0.5 * sin(2 * M_PI * 1250 * i / sample_rate)) + noise(rng);
+      samples[i] = (int16_t)std::max(-32767.0, std::min(32767.0, x));
+    }
+    memset(&transmissions[t], 0, sizeof(Transmission));
+    snprintf(transmissions[t].filename, sizeof(transmissions[t].filename), "%s/transmission-%ld.wav", dir, t);
+    write_transmission(transmissions[t].filename, samples, sample_rate);
+    files += std::string(transmissions[t].filename) + " ";
+  }
+
+  char call_wav[300], call_m4a[300];
+  snprintf(call_wav, sizeof(call_wav), "%s/call.wav", dir);
+  snprintf(call_m4a, sizeof(call_m4a), "%s/call.m4a", dir);
+
+  bool have_sox = (system("command -v sox > /dev/null 2>&1") == 0);
+  bool have_fdkaac = (system("command -v fdkaac > /dev/null 2>&1") == 0);
+#ifdef HAVE_FDK_AAC
+  bool have_encoder = true;
+#else
+  bool have_encoder = have_fdkaac;
+#endif
+
+  std::vector<int16_t> samples;
+  unsigned int combined_rate;
+  double combine_seconds = 0, encode_seconds = 0;
+  for (long c = 0; c < calls; c++) {
+    Bench_Timer combine_timer;
+    if (native_combine_wav(transmissions, call_wav, samples, combined_rate) < 0) {
+      std::cerr << "native_combine_wav() failed" << std::endl;
+      return 1;
+    }
+    normalize_samples(samples, -0.01);
+    combine_seconds += combine_timer.seconds();
+
+    if (have_encoder) {
+      Bench_Timer encode_timer;
+      native_convert_media(samples, combined_rate, call_m4a);
+      encode_seconds += encode_timer.seconds();
+    }
+  }
+
+  std::cout << calls << " calls of " << transmission_count << " transmissions, " << seconds << " sec each" << std::endl;
+  std::cout << "native combine + normalize: " << (combine_seconds * 1e3 / calls) << " ms per call" << std::endl;
+  if (have_encoder) {
+    std::cout << "native encode:              " << (encode_seconds * 1e3 / calls) << " ms per call" << std::endl;
+  } else {
+    std::cout << "native encode:              skipped, no libfdk-aac or fdkaac" << std::endl;
+  }
+
+  // The commands from call_concluder.cc, combine_wav() then convert_media()
+  if (have_sox) {
+    std::string combine = "sox " + files + call_wav;
+    std::string convert = std::string("sox ") + call_wav + " --norm=-.01 -t wav - | fdkaac --silent  -p 2 --moov-before-mdat --ignorelength -b 8000 -o " + call_m4a + " -";
+    double sox_combine_seconds = 0, sox_convert_seconds = 0;
+    for (long c = 0; c < calls; c++) {
+      Bench_Timer combine_timer;
+      if (system(combine.c_str()) != 0) {
+        std::cerr << "sox failed" << std::endl;
+        return 1;
+      }
+      sox_combine_seconds += combine_timer.seconds();
+      if (have_fdkaac) {
+        Bench_Timer convert_timer;
+        if (system(convert.c_str()) != 0) {
+          std::cerr << "sox | fdkaac failed" << std::endl;
+          return 1;
+        }
+        sox_convert_seconds += convert_timer.seconds();
+      }
+    }
+    std::cout << "sox combine:                " << (sox_combine_seconds * 1e3 / calls) << " ms per call" << std::endl;
+    if (have_fdkaac) {
+      std::cout << "sox --norm | fdkaac:        " << (sox_convert_seconds * 1e3 / calls) << " ms per call" << std::endl;
+    } else {
+      std::cout << "sox --norm | fdkaac:        skipped, fdkaac is not on the PATH" << std::endl;
+    }
+  } else {
+    std::cout << "sox:                        skipped, not on the PATH" << std::endl;
+  }
+
+  for (long t = 0; t < transmission_count; t++) {
+    unlink(transmissions[t].filename);
+  }
+  unlink(call_wav);
+  unlink(call_m4a);
+  rmdir(dir);
+  return 0;
+}
@@ -0,0 +1,255 @@
+// Heap allocations and time for the two copies that Config_Snapshot and the
+// moves through the Call Concluder removed. The first part is a Call taking
+// its Config, by value as Call::make() and Call_impl used to and as a shared
+// snapshot now. The second hands a 20 transmission Call_Data_t from
+// conclude_call() through the job queue, a worker, upload_call_worker()'s
+// call_end() and the completed list, copying it at each step as before and
+// moving it now. Filling in the Call_Data_t is the same for both and is
+// counted in both.
+//
+// usage: call_data_alloc [iterations] [transmissions]
+
+#include "bench.h"
+
+#include "../trunk-recorder/global_structs.h"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <queue>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+static long allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// The parts of call_concluder.h and call_impl.h being timed
+struct Call_Data_Job {
+  Call_Data_t call_info;
+  long sequence;
+  std::chrono::steady_clock::time_point queued_time;
+};
+
+struct Call_Data_Job_Compare {
+  bool operator()(const Call_Data_Job &a, const Call_Data_Job &b) const {
+    return a.sequence > b.sequence;
+  }
+};
+
+typedef std::priority_queue<Call_Data_Job, std::vector<Call_Data_Job>, Call_Data_Job_Compare> Job_Queue;
+
+struct Call_By_Value {
+  Config config;
+  Call_By_Value(Config c) { config = c; }
+};
+
+struct Call_With_Snapshot {
+  Config_Snapshot config;
+  Call_With_Snapshot(Config_Snapshot c) : config(c) {}
+};
+
+static Call_By_Value *make_by_value(Config c) { return new Call_By_Value(c); }
+static Call_With_Snapshot *make_with_snapshot(Config_Snapshot c) { return new Call_With_Snapshot(c); }
+
+static Config typical_config() {
+  Config config = Config();
+  config.upload_server = "https://api.openmhz.com";
+  config.bcfy_calls_server = "https://api.broadcastify.com/call-upload";
+  config.status_server = "ws://status.example.com:3010/server";
+  config.instance_key = "0123456789abcdef0123456789abcdef";
+  config.instance_id = "trunk-recorder";
+  config.capture_dir = "/home/radio/trunk-recorder/media";
+  config.temp_dir = "/dev/shm/trunk-recorder";
+  config.debug_recorder_address = "127.0.0.1";
+  config.log_dir = "/var/log/trunk-recorder";
+  config.default_mode = "digital";
+  return config;
+}
+
+// create_call_data(), everything it copies out of the Call and System
+static void fill_call_data(Call_Data_t &call_info, const Config &config, int transmissions) {
+  call_info.talkgroup = 4005;
+  call_info.talkgroup_tag = "Fire Dispatch";
+  call_info.talkgroup_alpha_tag = "County Fire Dispatch 1";
+  call_info.talkgroup_description = "County Fire Department Dispatch";
+  call_info.talkgroup_display = "4005 (County Fire Dispatch 1)";
+  call_info.talkgroup_group = "Fire Department";
+  call_info.short_name = "countysystem";
+  call_info.upload_script = config.upload_script;
+  call_info.audio_type = "digital";
+  call_info.status = INITIAL;
+  for (int i = 0; i < transmissions; i++) {
+    Call_Source source = {1000000 + i, 1700000000 + i, i * 2.5, false, "P25", "Engine " + std::to_string(i) + " Portable Radio"};
+    Call_Error error = {1700000000 + i, i * 2.5, 2.5, 0, 0};
+    Transmission t = Transmission();
+    t.source = source.source;
+    t.length = 2.5;
+    snprintf(t.filename, sizeof(t.filename), "%s/countysystem-4005_%d.wav", config.temp_dir.c_str(), i);
+    call_info.transmission_source_list.push_back(source);
+    call_info.transmission_error_list.push_back(error);
+    call_info.transmission_list.push_back(t);
+  }
+}
+
+static long plugin_sum = 0;
+
+// Before: every hand-off took the Call_Data_t or the Config by value
+
+static int call_end_by_value(Call_Data_t call_info) {
+  plugin_sum += call_info.transmission_list.size();
+  return 0;
+}
+
+static int plugman_call_end_by_value(Call_Data_t call_info) { return call_end_by_value(call_info); }
+
+static Call_Data_t upload_call_worker_copied(Call_Data_t call_info) {
+  plugman_call_end_by_value(call_info);
+  call_info.status = SUCCESS;
+  return call_info;
+}
+
+static Call_Data_t create_base_filename_copied(Call_Data_t call_info) {
+  snprintf(call_info.filename, 300, "%s/countysystem/4005-call_1.wav", "/home/radio/trunk-recorder/media");
+  return call_info;
+}
+
+static Call_Data_t create_call_data_copied(Config config, int transmissions) {
+  Call_Data_t call_info;
+  call_info = create_base_filename_copied(call_info);
+  fill_call_data(call_info, config, transmissions);
+  return call_info;
+}
+
+static void enqueue_call_data_copied(Job_Queue &queue, Call_Data_t call_info) {
+  Call_Data_Job job = {call_info, 0, std::chrono::steady_clock::now()};
+  queue.push(job);
+}
+
+static void hand_off_copied(const Config &member, int transmissions, Job_Queue &queue, std::deque<Call_Data_t> &completed) {
+  // Call_impl::conclude_call() passing its Config member by value
+  Config config = member;
+  Call_Data_t call_info = create_call_data_copied(config, transmissions);
+  enqueue_call_data_copied(queue, call_info);
+
+  Call_Data_Job job = queue.top();
+  queue.pop();
+  Call_Data_t done = upload_call_worker_copied(job.call_info);
+  completed.push_back(done);
+}
+
+// Now: const references, moves and filling in place
+
+static int call_end_by_reference(const Call_Data_t &call_info) {
+  plugin_sum += call_info.transmission_list.size();
+  return 0;
+}
+
+static int plugman_call_end_by_reference(const Call_Data_t &call_info) { return call_end_by_reference(call_info); }
+
+static Call_Data_t upload_call_worker_moved(Call_Data_t call_info) {
+  plugman_call_end_by_reference(call_info);
+  call_info.status = SUCCESS;
+  return call_info;
+}
+
+static void create_base_filename_in_place(Call_Data_t &call_info) {
+  snprintf(call_info.filename, 300, "%s/countysystem/4005-call_1.wav", "/home/radio/trunk-recorder/media");
+}
+
+static Call_Data_t create_call_data_in_place(const Config &config, int transmissions) {
+  Call_Data_t call_info;
+  create_base_filename_in_place(call_info);
+  fill_call_data(call_info, config, transmissions);
+  return call_info;
+}
+
+static void enqueue_call_data_moved(Job_Queue &queue, Call_Data_t call_info) {
+  Call_Data_Job job = {std::move(call_info), 0, std::chrono::steady_clock::now()};
+  queue.push(std::move(job));
+}
+
+static void hand_off_moved(const Config &config, int transmissions, Job_Queue &queue, std::deque<Call_Data_t> &completed) {
+  Call_Data_t call_info = create_call_data_in_place(config, transmissions);
+  enqueue_call_data_moved(queue, std::move(call_info));
+
+  Call_Data_Job job = std::move(const_cast<Call_Data_Job &>(queue.top()));
+  queue.pop();
+  Call_Data_t done = upload_call_worker_moved(std::move(job.call_info));
+  completed.push_back(std::move(done));
+}
+
+static void report(const char *name, long allocs, double seconds, long iterations) {
+  double per = seconds / iterations;
+  std::cout << name << (double)allocs / iterations << " allocations, ";
+  if (per < 1e-6) {
+    std::cout << (per * 1e9) << " ns" << std::endl;
+  } else {
+    std::cout << (per * 1e6) << " us" << std::endl;
+  }
+}
+
+int main(int argc, char **argv) {
+  long iterations = bench_arg(argc, argv, 1, 200000);
+  int transmissions = bench_arg(argc, argv, 2, 20);
+  Config config = typical_config();
+  Config_Snapshot snapshot = std::make_shared<const Config>(config);
+
+  std::cout << iterations << " Calls, " << transmissions << " transmissions each" << std::endl;
+
+  long start = allocations;
+  Bench_Timer by_value_timer;
+  for (long i = 0; i < iterations; i++) {
+    Call_By_Value *call = make_by_value(config);
+    bench_keep(call);
+    delete call;
+  }
+  report("Call construction, Config by value:   ", allocations - start, by_value_timer.seconds(), iterations);
+
+  start = allocations;
+  Bench_Timer snapshot_timer;
+  for (long i = 0; i < iterations; i++) {
+    Call_With_Snapshot *call = make_with_snapshot(snapshot);
+    bench_keep(call);
+    delete call;
+  }
+  report("Call construction, Config_Snapshot:   ", allocations - start, snapshot_timer.seconds(), iterations);
+
+  Job_Queue queue;
+  std::deque<Call_Data_t> completed;
+  long hand_offs = iterations / 10;
+
+  start = allocations;
+  Bench_Timer copied_timer;
+  for (long i = 0; i < hand_offs; i++) {
+    hand_off_copied(config, transmissions, queue, completed);
+    completed.clear();
+  }
+  report("Call_Data_t hand-off, copied:         ", allocations - start, copied_timer.seconds(), hand_offs);
+
+  start = allocations;
+  Bench_Timer moved_timer;
+  for (long i = 0; i < hand_offs; i++) {
+    hand_off_moved(config, transmissions, queue, completed);
+    completed.clear();
+  }
+  report("Call_Data_t hand-off, moved:          ", allocations - start, moved_timer.seconds(), hand_offs);
+
+  bench_keep(plugin_sum);
+  return 0;
+}
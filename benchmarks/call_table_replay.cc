@@ -0,0 +1,268 @@
+// Replays grants and updates against the active Calls the way
+// handle_call_grant() and handle_call_update() look them up: once with
+// Call_Table's channel and talkgroup indexes, and once with the scan over
+// every Call that main.cc used before. Calls end and new ones start as the
+// replay goes, so adding and removing Calls is counted too.
+//
+// usage: call_table_replay [active calls] [messages]
+
+#include "bench.h"
+
+#include "../trunk-recorder/call.h"
+#include "../trunk-recorder/call_table.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Only what the lookups read, the rest of Call is never called here.
+class Bench_Call : public Call {
+  long talkgroup;
+  double freq;
+  int sys_num;
+  int tdma_slot;
+  bool phase2;
+  State state;
+
+public:
+  Bench_Call(long tg, double f, int sys, int slot, bool p2) : talkgroup(tg), freq(f), sys_num(sys), tdma_slot(slot), phase2(p2), state(RECORDING) {}
+
+  long get_talkgroup() { return talkgroup; }
+  double get_freq() { return freq; }
+  int get_sys_num() { return sys_num; }
+  int get_tdma_slot() { return tdma_slot; }
+  bool get_phase2_tdma() { return phase2; }
+  State get_state() { return state; }
+
+  long get_call_num() { return 0; }
+  void restart_call() {}
+  void stop_call() {}
+  void conclude_call() {}
+  void set_sigmf_recorder(Recorder *r) {}
+  Recorder *get_sigmf_recorder() { return NULL; }
+  void set_debug_recorder(Recorder *r) {}
+  Recorder *get_debug_recorder() { return NULL; }
+  void set_recorder(Recorder *r) {}
+  Recorder *get_recorder() { return NULL; }
+  std::string get_short_name() { return ""; }
+  std::string get_capture_dir() { return ""; }
+  std::string get_temp_dir() { return ""; }
+  void set_freq(double f) {}
+  bool update(TrunkMessage message) { return false; }
+  int get_idle_count() { return 0; }
+  void increase_idle_count() {}
+  void reset_idle_count() {}
+  int since_last_update() { return 0; }
+  double since_last_voice_update() { return 0; }
+  long elapsed() { return 0; }
+  double get_current_length() { return 0; }
+  long get_stop_time() { return 0; }
+  void set_debug_recording(bool m) {}
+  bool get_debug_recording() { return false; }
+  void set_sigmf_recording(bool m) {}
+  bool get_sigmf_recording() { return false; }
+  void set_state(State s) { state = s; }
+  void set_monitoring_state(MonitoringState s) {}
+  MonitoringState get_monitoring_state() { return UNSPECIFIED; }
+  void set_phase2_tdma(bool m) {}
+  void set_tdma_slot(int s) {}
+  bool get_is_analog() { return false; }
+  void set_is_analog(bool a) {}
+  const char *get_xor_mask() { return NULL; }
+  time_t get_start_time() { return 0; }
+  bool is_conventional() { return false; }
+  void set_encrypted(bool m) {}
+  bool get_encrypted() { return false; }
+  void set_emergency(bool m) {}
+  bool get_emergency() { return false; }
+  int get_priority() { return 0; }
+  bool get_mode() { return false; }
+  bool get_duplex() { return false; }
+  std::string get_talkgroup_display() { return ""; }
+  void set_talkgroup_tag(std::string tag) {}
+  void clear_transmission_list() {}
+  boost::property_tree::ptree get_stats() { return boost::property_tree::ptree(); }
+  nlohmann::json get_stats_json() { return nlohmann::json(); }
+  std::string get_talkgroup_tag() { return ""; }
+  std::string get_system_type() { return ""; }
+  double get_final_length() { return 0; }
+  long get_current_source_id() { return 0; }
+  bool get_conversation_mode() { return false; }
+  System *get_system() { return NULL; }
+  Talkgroups_Snapshot get_talkgroups_snapshot() { return Talkgroups_Snapshot(); }
+  Unit_Tags_Snapshot get_unit_tags_snapshot() { return Unit_Tags_Snapshot(); }
+  std::vector<Transmission> get_transmissions() { return std::vector<Transmission>(); }
+};
+
+struct Replay_Stats {
+  long found;
+  long multisite;
+  long overlapping;
+};
+
+struct Replay_Message {
+  TrunkMessage message;
+  bool grant;
+  Call *ended; // removed by manage_calls() just before this message
+  Call *started; // added if the grant finds no Call
+};
+
+static bool same_slot(Call *call, const TrunkMessage &message) {
+  return (call->get_tdma_slot() == message.tdma_slot) && (call->get_phase2_tdma() == message.phase2_tdma);
+}
+
+static bool same_channel(Call *call, const TrunkMessage &message) {
+  return (call->get_sys_num() == message.sys_num) && (call->get_freq() == message.freq) && same_slot(call, message);
+}
+
+// handle_call_grant() and handle_call_update() before Call_Table: every check against every Call
+static bool scan_message(std::vector<Call *> &calls, const Replay_Message &replay, Replay_Stats &stats) {
+  const TrunkMessage &message = replay.message;
+  bool call_found = false;
+  for (std::vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
+    Call *call = *it;
+    if (replay.grant && (call->get_talkgroup() == message.talkgroup) && (call->get_sys_num() != message.sys_num) && (call->get_state() == RECORDING)) {
+      stats.multisite++;
+    }
+    if ((call->get_talkgroup() == message.talkgroup) && same_channel(call, message)) {
+      call_found = true;
+      stats.found++;
+    }
+    if (replay.grant && (call->get_state() == RECORDING) && (call->get_talkgroup() != message.talkgroup) && same_channel(call, message)) {
+      stats.overlapping++;
+    }
+  }
+  return call_found;
+}
+
+// And now: the Calls on the Talkgroup, then only the Calls on the channel
+static bool indexed_message(Call_Table &calls, const Replay_Message &replay, Replay_Stats &stats) {
+  const TrunkMessage &message = replay.message;
+  bool call_found = false;
+  if (replay.grant) {
+    const std::vector<Call *> &talkgroup_calls = calls.find_talkgroup(message.talkgroup);
+    for (std::vector<Call *>::const_iterator it = talkgroup_calls.begin(); it != talkgroup_calls.end(); it++) {
+      Call *call = *it;
+      if ((call->get_sys_num() != message.sys_num) && (call->get_state() == RECORDING)) {
+        stats.multisite++;
+      }
+    }
+  }
+  const std::vector<Call *> &channel_calls = calls.find_channel(message.sys_num, message.freq);
+  for (std::vector<Call *>::const_iterator it = channel_calls.begin(); it != channel_calls.end(); it++) {
+    Call *call = *it;
+    if (!same_slot(call, message)) {
+      continue;
+    }
+    if (call->get_talkgroup() == message.talkgroup) {
+      call_found = true;
+      stats.found++;
+    }
+    if (replay.grant && (call->get_state() == RECORDING) && (call->get_talkgroup() != message.talkgroup)) {
+      stats.overlapping++;
+    }
+  }
+  return call_found;
+}
+
+int main(int argc, char **argv) {
+  long active = bench_arg(argc, argv, 1, 150);
+  long message_count = bench_arg(argc, argv, 2, 2000000);
+  const int systems = 4;
+  const int channels = 60;
+  std::mt19937 rng(1);
+  std::vector<Bench_Call *> all_calls;
+
+  // A new Call on a random channel and slot. Talkgroups are shared by the Systems, so some Calls are multi-site.
+  auto make_call = [&]() {
+    int sys = rng() % systems;
+    bool phase2 = (sys & 1);
+    all_calls.push_back(new Bench_Call(1000 + rng() % 400, 851000000 + 12500 * (rng() % channels), sys, phase2 ? rng() % 2 : 0, phase2));
+    return all_calls.back();
+  };
+
+  std::vector<Call *> initial;
+  for (long i = 0; i < active; i++) {
+    initial.push_back(make_call());
+  }
+
+  // Mostly UPDATEs and repeated GRANTs for the active Calls, and 1 in 20 a GRANT for a new Call that takes the place of an ended one
+  std::vector<Replay_Message> messages(message_count);
+  std::vector<Call *> playing = initial;
+  for (long m = 0; m < message_count; m++) {
+    Replay_Message &replay = messages[m];
+    long pick = rng() % active;
+    Call *call = playing[pick];
+    replay.grant = (rng() % 3) == 0;
+    replay.ended = NULL;
+    replay.started = NULL;
+    if ((rng() % 20) == 0) {
+      replay.grant = true;
+      replay.ended = call;
+      playing[pick] = NULL;
+      // The grant has to start a Call, so not one that matches another active Call
+      bool matches;
+      do {
+        call = make_call();
+        matches = false;
+        for (long i = 0; i < active; i++) {
+          matches |= playing[i] && (playing[i]->get_talkgroup() == call->get_talkgroup()) && (playing[i]->get_sys_num() == call->get_sys_num()) && (playing[i]->get_freq() == call->get_freq()) && (playing[i]->get_tdma_slot() == call->get_tdma_slot());
+        }
+      } while (matches);
+      replay.started = call;
+      playing[pick] = call;
+    }
+    replay.message.talkgroup = call->get_talkgroup();
+    replay.message.sys_num = call->get_sys_num();
+    replay.message.freq = call->get_freq();
+    replay.message.tdma_slot = call->get_tdma_slot();
+    replay.message.phase2_tdma = call->get_phase2_tdma();
+  }
+
+  Replay_Stats scan_stats = {0, 0, 0};
+  std::vector<Call *> scan_calls = initial;
+  Bench_Timer scan_timer;
+  for (long m = 0; m < message_count; m++) {
+    const Replay_Message &replay = messages[m];
+    if (replay.ended) {
+      scan_calls.erase(std::find(scan_calls.begin(), scan_calls.end(), replay.ended));
+    }
+    if (!scan_message(scan_calls, replay, scan_stats) && replay.started) {
+      scan_calls.push_back(replay.started);
+    }
+  }
+  double scan_seconds = scan_timer.seconds();
+
+  Replay_Stats indexed_stats = {0, 0, 0};
+  Call_Table indexed_calls;
+  for (long i = 0; i < active; i++) {
+    indexed_calls.add(initial[i]);
+  }
+  Bench_Timer indexed_timer;
+  for (long m = 0; m < message_count; m++) {
+    const Replay_Message &replay = messages[m];
+    if (replay.ended) {
+      indexed_calls.remove(replay.ended);
+    }
+    if (!indexed_message(indexed_calls, replay, indexed_stats) && replay.started) {
+      indexed_calls.add(replay.started);
+    }
+  }
+  double indexed_seconds = indexed_timer.seconds();
+
+  if ((scan_stats.found != indexed_stats.found) || (scan_stats.multisite != indexed_stats.multisite) || (scan_stats.overlapping != indexed_stats.overlapping) || (scan_calls.size() != indexed_calls.size())) {
+    std::cerr << "The scan and Call_Table matched different Calls" << std::endl;
+    return 1;
+  }
+
+  std::cout << message_count << " messages, " << active << " active Calls" << std::endl;
+  std::cout << scan_stats.found << " matched a Call, " << scan_stats.multisite << " multi-site and " << scan_stats.overlapping << " overlapping matches" << std::endl;
+  std::cout << "scan:       " << (scan_seconds * 1e9 / message_count) << " ns per message" << std::endl;
+  std::cout << "Call_Table: " << (indexed_seconds * 1e9 / message_count) << " ns per message" << std::endl;
+
+  for (size_t i = 0; i < all_calls.size(); i++) {
+    delete all_calls[i];
+  }
+  return 0;
+}
@@ -0,0 +1,126 @@
+// The frame sync search of rx_sync on its own: frame_sync_scanner over the
+// buffer followed by check_frame_sync() where it flagged a candidate,
+// against check_frame_sync() on all 13 patterns at every dibit as
+// process_sym() did before. The idle run is noise with no receiver locked,
+// the busy run has a P25 sync with up to 2 bit errors every 864 dibits and
+// the receiver locked to P25 so the 2 error threshold applies. Both searches
+// must find the same syncs at the same positions.
+//
+// usage: frame_sync_scan [million dibits] [dibits per buffer]
+
+#include "bench.h"
+
+#include "check_frame_sync.h"
+#include "frame_sync_magics.h"
+#include "frame_sync_scanner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// The patterns of rx_sync's SYNC_MAGIC with the sync_len of their MODE_DATA
+static const int KNOWN_MAGICS = 13;
+static const int P25P1_MAGIC = 0;
+static const uint64_t magics[KNOWN_MAGICS] = {P25_FRAME_SYNC_MAGIC, P25P2_FRAME_SYNC_MAGIC, DMR_BS_VOICE_SYNC_MAGIC, DMR_BS_DATA_SYNC_MAGIC, DMR_MS_VOICE_SYNC_MAGIC, DMR_MS_DATA_SYNC_MAGIC, DMR_MS_RC_SYNC_MAGIC, DMR_T1_VOICE_SYNC_MAGIC, DMR_T1_DATA_SYNC_MAGIC, DMR_T2_VOICE_SYNC_MAGIC, DMR_T2_DATA_SYNC_MAGIC, DSTAR_FRAME_SYNC_MAGIC, YSF_FRAME_SYNC_MAGIC};
+static const int lens[KNOWN_MAGICS] = {48, 40, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 40};
+static const int MAX_SYNC_THRESHOLD = 2;
+
+// The pattern loop of process_sym(), -1 when nothing matched
+static inline int check_magics(uint64_t reg, int threshold) {
+  for (int i = 0; i < KNOWN_MAGICS; i++) {
+    if (check_frame_sync(magics[i] ^ reg, (i == P25P1_MAGIC) ? threshold : 0, lens[i])) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+struct Search_Result {
+  double seconds;
+  long checked;
+  std::vector<long> syncs;
+};
+
+static Search_Result search_every_dibit(const std::vector<uint8_t> &dibits, int threshold) {
+  Search_Result result = {0, 0, std::vector<long>()};
+  uint64_t reg = 0;
+  Bench_Timer timer;
+  for (size_t i = 0; i < dibits.size(); i++) {
+    reg = (reg << 2) | (dibits[i] & 3);
+    if (check_magics(reg, threshold) >= 0) {
+      result.syncs.push_back(i);
+    }
+  }
+  result.seconds = timer.seconds();
+  result.checked = dibits.size();
+  return result;
+}
+
+static Search_Result search_scanned(const std::vector<uint8_t> &dibits, int threshold, int buffer) {
+  Search_Result result = {0, 0, std::vector<long>()};
+  frame_sync_scanner scanner;
+  scanner.set_patterns(magics, lens, KNOWN_MAGICS, MAX_SYNC_THRESHOLD);
+  std::vector<uint8_t> hits(buffer);
+  uint64_t reg = 0;
+  Bench_Timer timer;
+  for (size_t start = 0; start < dibits.size(); start += buffer) {
+    int n = std::min((size_t)buffer, dibits.size() - start);
+    const uint8_t *syms = &dibits[start];
+    scanner.scan(reg, syms, n, hits.data());
+    for (int i = 0; i < n; i++) {
+      reg = (reg << 2) | (syms[i] & 3);
+      if (hits[i]) {
+        result.checked++;
+        if (check_magics(reg, threshold) >= 0) {
+          result.syncs.push_back(start + i);
+        }
+      }
+    }
+  }
+  result.seconds = timer.seconds();
+  return result;
+}
+
+static bool run(const char *name, const std::vector<uint8_t> &dibits, int threshold, int buffer) {
+  Search_Result before = search_every_dibit(dibits, threshold);
+  Search_Result after = search_scanned(dibits, threshold, buffer);
+  double msyms = dibits.size() / 1e6;
+  std::cout << name << ": " << before.syncs.size() << " syncs" << std::endl;
+  std::cout << "  every dibit: " << (msyms / before.seconds) << " Msym/s" << std::endl;
+  std::cout << "  scanner:     " << (msyms / after.seconds) << " Msym/s, " << (100.0 * after.checked / dibits.size()) << "% of dibits checked" << std::endl;
+  if (before.syncs != after.syncs) {
+    std::cerr << "The scanner found different syncs" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  long count = bench_arg(argc, argv, 1, 16) * 1000000;
+  int buffer = bench_arg(argc, argv, 2, 4096);
+  std::mt19937 rng(1);
+
+  std::vector<uint8_t> dibits(count);
+  for (long i = 0; i < count; i++) {
+    dibits[i] = rng() & 3;
+  }
+  if (!run("idle", dibits, 0, buffer)) {
+    return 1;
+  }
+
+  // A P25 sync with 0 to 2 flipped bits ending every 864 dibits
+  for (long end = 863; end < count; end += 864) {
+    uint64_t sync = P25_FRAME_SYNC_MAGIC;
+    for (int e = rng() % (MAX_SYNC_THRESHOLD + 1); e > 0; e--) {
+      sync ^= 1ULL << (rng() % 48);
+    }
+    for (int d = 0; d < 24; d++) {
+      dibits[end - d] = (sync >> (2 * d)) & 3;
+    }
+  }
+  if (!run("busy", dibits, MAX_SYNC_THRESHOLD, buffer)) {
+    return 1;
+  }
+  return 0;
+}
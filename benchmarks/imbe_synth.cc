@@ -0,0 +1,90 @@
+// software_imbe_decoder::decode_tap() on random pitch, voicing and
+// amplitudes, which is the synthesis done for every Phase 2 voice frame and
+// for Phase 1 with softVocoder. The frames are the same on every run, so the
+// audio of two builds can be compared: write it out with one and compare it
+// with the other. Set IMBE_SYNTH_REFERENCE when configuring to build
+// imbe_synth_reference from an older software_imbe_decoder.cc.
+//
+// usage: imbe_synth [frames] [write audio to] [compare audio with]
+
+#include "bench.h"
+
+#include "software_imbe_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char **argv) {
+  long frames = bench_arg(argc, argv, 1, 5000);
+  const char *write_to = (argc > 2) ? argv[2] : NULL;
+  const char *compare_with = (argc > 3) ? argv[3] : NULL;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> pitch(20, 122);
+  std::exponential_distribution<float> amplitude(1 / 300.0);
+
+  std::vector<int> L(frames);
+  std::vector<float> w0(frames);
+  std::vector<std::vector<int>> v(frames, std::vector<int>(56));
+  std::vector<std::vector<float>> mu(frames, std::vector<float>(56));
+  for (long f = 0; f < frames; f++) {
+    w0[f] = 2 * M_PI / pitch(rng);
+    L[f] = std::max(9, std::min(56, (int)(0.9254 * (M_PI / w0[f] + 0.25))));
+    for (int ell = 0; ell < 56; ell++) {
+      v[f][ell] = rng() & 1;
+      mu[f][ell] = amplitude(rng);
+    }
+  }
+
+  software_imbe_decoder decoder;
+  std::vector<float> audio;
+  audio.reserve(frames * 160);
+
+  Bench_Timer timer;
+  for (long f = 0; f < frames; f++) {
+    decoder.decode_tap(L[f], 0, w0[f], v[f].data(), mu[f].data());
+    audio_samples *samples = decoder.audio();
+    audio.insert(audio.end(), samples->begin(), samples->end());
+    samples->clear();
+  }
+  double seconds = timer.seconds();
+
+  std::cout << frames << " frames" << std::endl;
+  std::cout << "decode_tap: " << (seconds * 1e6 / frames) << " us per frame" << std::endl;
+
+  if (write_to) {
+    FILE *fp = fopen(write_to, "wb");
+    if (!fp || (fwrite(audio.data(), sizeof(float), audio.size(), fp) != audio.size())) {
+      std::cerr << "Unable to write " << write_to << std::endl;
+      return 1;
+    }
+    fclose(fp);
+  }
+
+  if (compare_with) {
+    std::vector<float> reference(audio.size());
+    FILE *fp = fopen(compare_with, "rb");
+    if (!fp || (fread(reference.data(), sizeof(float), reference.size(), fp) != reference.size())) {
+      std::cerr << "Unable to read " << audio.size() << " samples from " << compare_with << std::endl;
+      return 1;
+    }
+    fclose(fp);
+
+    double signal = 0, error = 0, worst = 0;
+    for (size_t i = 0; i < audio.size(); i++) {
+      double diff = audio[i] - reference[i];
+      signal += (double)reference[i] * reference[i];
+      error += diff * diff;
+      worst = std::max(worst, std::fabs(diff));
+    }
+    if (error == 0) {
+      std::cout << "identical to " << compare_with << std::endl;
+    } else {
+      std::cout << "against " << compare_with << ": " << (10 * log10(signal / error)) << " dB SNR, worst difference " << worst << std::endl;
+    }
+  }
+  return 0;
+}
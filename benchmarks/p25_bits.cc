@@ -0,0 +1,110 @@
+// Loading a TSBK into P25Bits and reading the fields of a group voice grant,
+// against the boost::dynamic_bitset code P25Parser used before. Both are also
+// compared at every shift and mask width on random messages.
+//
+// usage: p25_bits [tsbks]
+
+#include "bench.h"
+
+#include "../trunk-recorder/systems/p25_parser.h"
+
+#include <boost/dynamic_bitset.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// How parse_message() built the bitset: one bit at a time, then shifted for the missing CRC.
+static boost::dynamic_bitset<> load_bitset(const std::string &s, int pad_bytes) {
+  boost::dynamic_bitset<> b((s.length() + pad_bytes) * 8);
+
+  for (unsigned int i = 0; i < s.length(); ++i) {
+    unsigned char c = (unsigned char)s[i];
+    b <<= 8;
+
+    for (int j = 0; j < 8; j++) {
+      b[j] = (c & 0x1);
+      c >>= 1;
+    }
+  }
+  b <<= pad_bytes * 8;
+  return b;
+}
+
+static unsigned long bitset_shift_mask(boost::dynamic_bitset<> &tsbk, int shift, unsigned long long mask) {
+  boost::dynamic_bitset<> bitmask(tsbk.size(), mask);
+  return ((tsbk >> shift) & bitmask).to_ulong();
+}
+
+// The fields decode_tsbk() reads for a group voice grant
+static const int grant_fields[][2] = {{88, 0x3f}, {80, 0xff}, {72, 0xff}, {72, 0x80}, {72, 0x40}, {56, 0xffff}, {40, 0xffff}, {16, 0xffffff}};
+static const int grant_field_count = sizeof(grant_fields) / sizeof(grant_fields[0]);
+
+int main(int argc, char **argv) {
+  long tsbks = bench_arg(argc, argv, 1, 1000000);
+  std::mt19937 rng(1);
+
+  // Every shift and mask width on random messages of 0 to 40 bytes, which covers TSBKs and MBT blocks
+  for (int trial = 0; trial < 2000; trial++) {
+    std::string s(rng() % 41, '\0');
+    for (size_t i = 0; i < s.length(); i++) {
+      s[i] = (char)(rng() & 0xff);
+    }
+    int pad_bytes = (trial & 1) ? 4 : 2;
+    boost::dynamic_bitset<> bitset = load_bitset(s, pad_bytes);
+    P25Bits bits;
+    bits.load((const unsigned char *)s.data(), s.length(), pad_bytes);
+
+    for (int width = 1; width <= 32; width++) {
+      unsigned long long mask = (1ULL << width) - 1;
+      for (int shift = 0; shift < 256; shift++) {
+        unsigned long expected = (shift < (int)bitset.size()) ? bitset_shift_mask(bitset, shift, mask) : 0;
+        if ((int)bitset.size() > 256) {
+          // P25Bits holds 256 bits, the longest messages lose their top bits
+          expected = (shift + width <= 256) ? expected : (expected & ((1ULL << (256 - shift)) - 1));
+        }
+        if (bits.field(shift, mask) != expected) {
+          std::cerr << "Mismatch at shift " << shift << " width " << width << " length " << s.length() << std::endl;
+          return 1;
+        }
+      }
+    }
+  }
+
+  std::vector<std::string> messages(1024);
+  for (size_t m = 0; m < messages.size(); m++) {
+    messages[m].resize(10);
+    for (int i = 0; i < 10; i++) {
+      messages[m][i] = (char)(rng() & 0xff);
+    }
+  }
+
+  unsigned long sum = 0;
+  Bench_Timer bitset_timer;
+  for (long t = 0; t < tsbks; t++) {
+    boost::dynamic_bitset<> b = load_bitset(messages[t & 1023], 2);
+    for (int f = 0; f < grant_field_count; f++) {
+      sum += bitset_shift_mask(b, grant_fields[f][0], grant_fields[f][1]);
+    }
+  }
+  double bitset_seconds = bitset_timer.seconds();
+  bench_keep(sum);
+
+  sum = 0;
+  Bench_Timer bits_timer;
+  for (long t = 0; t < tsbks; t++) {
+    const std::string &s = messages[t & 1023];
+    P25Bits b;
+    b.load((const unsigned char *)s.data(), s.length(), 2);
+    for (int f = 0; f < grant_field_count; f++) {
+      sum += b.field(grant_fields[f][0], grant_fields[f][1]);
+    }
+  }
+  double bits_seconds = bits_timer.seconds();
+  bench_keep(sum);
+
+  std::cout << tsbks << " TSBKs, " << grant_field_count << " fields each" << std::endl;
+  std::cout << "dynamic_bitset: " << (tsbks / bitset_seconds / 1e6) << "M TSBKs/sec" << std::endl;
+  std::cout << "P25Bits:        " << (tsbks / bits_seconds / 1e6) << "M TSBKs/sec" << std::endl;
+  return 0;
+}
@@ -0,0 +1,90 @@
+// Handing a decoded SmartNet OSW from smartnet_decode to SmartnetParser, as
+// the binary smartnet_packet it is now and as the "address,group,command"
+// text it used to be. A std::string stands in for the gr::message body, which
+// is allocated the same way in both cases.
+//
+// usage: smartnet_osw [osws]
+
+#include "bench.h"
+
+#include "../trunk-recorder/systems/smartnet_types.h"
+
+#include <boost/algorithm/string.hpp>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// What smartnet_decode::work() used to put in the message
+static std::string format_osw(const smartnet_packet &pkt) {
+  std::ostringstream payload;
+  payload.str("");
+  payload << pkt.address << "," << pkt.groupflag << "," << pkt.command;
+  return std::string(payload.str());
+}
+
+// And how SmartnetParser::parse_message() read it back
+static bool split_osw(std::string s, smartnet_packet &pkt) {
+  std::vector<std::string> x;
+  boost::split(x, s, boost::is_any_of(","), boost::token_compress_on);
+
+  if (x.size() < 3) {
+    return false;
+  }
+  pkt.address = atoi(x[0].c_str());
+  pkt.groupflag = atoi(x[1].c_str());
+  pkt.command = atoi(x[2].c_str());
+  return true;
+}
+
+int main(int argc, char **argv) {
+  long osws = bench_arg(argc, argv, 1, 2000000);
+  std::mt19937 rng(1);
+
+  std::vector<smartnet_packet> packets(4096);
+  for (size_t i = 0; i < packets.size(); i++) {
+    packets[i].address = rng() & 0xffff;
+    packets[i].groupflag = rng() & 1;
+    packets[i].command = rng() & 0x3ff;
+    packets[i].crc = 0;
+  }
+
+  unsigned long sum = 0;
+  Bench_Timer text_timer;
+  for (long i = 0; i < osws; i++) {
+    std::string body = format_osw(packets[i & 4095]);
+    smartnet_packet pkt;
+    if (split_osw(body, pkt)) {
+      sum += pkt.address + pkt.groupflag + pkt.command;
+    }
+  }
+  double text_seconds = text_timer.seconds();
+  bench_keep(sum);
+
+  unsigned long binary_sum = 0;
+  Bench_Timer binary_timer;
+  for (long i = 0; i < osws; i++) {
+    std::string body(sizeof(smartnet_packet), '\0');
+    memcpy(&body[0], &packets[i & 4095], sizeof(smartnet_packet));
+    smartnet_packet pkt;
+    if (body.length() == sizeof(smartnet_packet)) {
+      memcpy(&pkt, body.data(), sizeof(smartnet_packet));
+      binary_sum += pkt.address + pkt.groupflag + pkt.command;
+    }
+  }
+  double binary_seconds = binary_timer.seconds();
+  bench_keep(binary_sum);
+
+  if (sum != binary_sum) {
+    std::cerr << "The text and binary OSWs decoded differently" << std::endl;
+    return 1;
+  }
+
+  std::cout << osws << " OSWs" << std::endl;
+  std::cout << "text:   " << (text_seconds * 1e9 / osws) << " ns per OSW" << std::endl;
+  std::cout << "binary: " << (binary_seconds * 1e9 / osws) << " ns per OSW" << std::endl;
+  return 0;
+}
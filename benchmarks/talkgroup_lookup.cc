@@ -0,0 +1,89 @@
+// Talkgroups::find_talkgroup() against the linear scan it replaced.
+//
+// usage: talkgroup_lookup [rows] [lookups]
+
+#include "bench.h"
+
+#include "../trunk-recorder/talkgroups.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// The lookup Talkgroups used before it had an index: the first row that matches wins.
+static const Talkgroup *scan_talkgroup(const std::vector<std::shared_ptr<const Talkgroup>> &talkgroups, int sys_num, long tg_number) {
+  for (std::vector<std::shared_ptr<const Talkgroup>>::const_iterator it = talkgroups.begin(); it != talkgroups.end(); ++it) {
+    if (((*it)->sys_num == sys_num) && ((*it)->number == tg_number)) {
+      return it->get();
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  long rows = bench_arg(argc, argv, 1, 20000);
+  long lookups = bench_arg(argc, argv, 2, 1000000);
+  std::mt19937 rng(1);
+
+  char filename[] = "/tmp/talkgroup_lookup_XXXXXX";
+  int fd = mkstemp(filename);
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+  close(fd);
+
+  std::ofstream csv(filename);
+  csv << "Decimal,Mode,Description,Alpha Tag,Tag,Category\n";
+  for (long i = 0; i < rows; i++) {
+    csv << (1000 + i * 3) << ",D,Talkgroup " << i << ",TG " << i << ",Law Dispatch,County\n";
+  }
+  csv.close();
+
+  Talkgroups talkgroups;
+  bool loaded = talkgroups.load_talkgroups(0, filename);
+  unlink(filename);
+  if (!loaded) {
+    return 1;
+  }
+  std::vector<std::shared_ptr<const Talkgroup>> all = talkgroups.get_talkgroups();
+
+  // About one lookup in ten is for a talkgroup that isn't in the file
+  std::vector<long> numbers(lookups);
+  std::uniform_int_distribution<long> pick(1000, 1000 + rows * 3 + rows / 3);
+  for (long i = 0; i < lookups; i++) {
+    numbers[i] = pick(rng);
+  }
+
+  for (long i = 0; i < lookups; i += 97) {
+    if (talkgroups.find_talkgroup(0, numbers[i]).get() != scan_talkgroup(all, 0, numbers[i])) {
+      std::cerr << "Mismatch for talkgroup " << numbers[i] << std::endl;
+      return 1;
+    }
+  }
+
+  // The scan is far slower, so it only gets a slice of the lookups
+  long scan_lookups = std::max(1L, lookups / 100);
+  Bench_Timer scan_timer;
+  for (long i = 0; i < scan_lookups; i++) {
+    bench_keep(scan_talkgroup(all, 0, numbers[i]));
+  }
+  double scan_seconds = scan_timer.seconds();
+
+  Bench_Timer index_timer;
+  for (long i = 0; i < lookups; i++) {
+    bench_keep(talkgroups.find_talkgroup(0, numbers[i]));
+  }
+  double index_seconds = index_timer.seconds();
+
+  std::cout << rows << " talkgroups" << std::endl;
+  std::cout << "linear scan: " << (scan_seconds * 1e9 / scan_lookups) << " ns per lookup" << std::endl;
+  std::cout << "index:       " << (index_seconds * 1e9 / lookups) << " ns per lookup" << std::endl;
+  return 0;
+}
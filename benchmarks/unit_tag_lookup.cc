@@ -0,0 +1,106 @@
+// UnitTags::find_unit_tag() against the regex-per-row search it replaced.
+//
+// usage: unit_tag_lookup [rows] [lookups]
+
+#include "bench.h"
+
+#include "../trunk-recorder/unit_tags.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// The rows as UnitTags used to hold them, one regex each, matched in file order.
+class Regex_Unit_Tags {
+  std::vector<UnitTag> rows;
+
+public:
+  void add(std::string pattern, std::string tag) {
+    if (pattern.substr(0, 1).compare("/") == 0 && pattern.substr(pattern.length() - 1, 1).compare("/") == 0) {
+      pattern = pattern.substr(1, pattern.length() - 2);
+    } else {
+      pattern = "^" + pattern + "$";
+    }
+    rows.push_back(UnitTag(pattern, tag));
+  }
+
+  std::string find_unit_tag(long unitID) const {
+    std::string unit_id_str = std::to_string(unitID);
+
+    for (std::vector<UnitTag>::const_iterator it = rows.begin(); it != rows.end(); ++it) {
+      if (regex_match(unit_id_str, it->pattern)) {
+        return regex_replace(unit_id_str, it->pattern, it->tag, boost::regex_constants::format_no_copy | boost::regex_constants::format_all);
+      }
+    }
+    return "";
+  }
+};
+
+int main(int argc, char **argv) {
+  long rows = bench_arg(argc, argv, 1, 10000);
+  long lookups = bench_arg(argc, argv, 2, 200000);
+  std::mt19937 rng(1);
+
+  // Mostly plain Unit IDs, with a pattern row every thousand, which is what large tag files look like
+  UnitTags unit_tags;
+  Regex_Unit_Tags regex_tags;
+  for (long i = 0; i < rows; i++) {
+    std::string pattern, tag;
+    if (i % 1000 == 500) {
+      pattern = "/^" + std::to_string(7 + i / 1000) + "(\\d{5})$/";
+      tag = "Fleet " + std::to_string(i / 1000) + " unit $1";
+    } else {
+      pattern = std::to_string(100000 + i * 7);
+      tag = "Unit " + std::to_string(i);
+    }
+    unit_tags.add(pattern, tag);
+    regex_tags.add(pattern, tag);
+  }
+
+  // Every lookup is a different ID, so the cache never helps
+  std::vector<long> unique_ids(lookups);
+  std::uniform_int_distribution<long> pick(100000, 100000 + rows * 8);
+  for (long i = 0; i < lookups; i++) {
+    unique_ids[i] = pick(rng) + (i % 4 == 0 ? 900000 : 0);
+  }
+  // A few hundred radios doing most of the talking, like a busy system
+  std::vector<long> busy_ids(lookups);
+  for (long i = 0; i < lookups; i++) {
+    busy_ids[i] = unique_ids[i % 300];
+  }
+
+  // The regex search is far slower, so it only gets a slice of the lookups
+  long regex_lookups = std::max(1L, lookups / 100);
+  Bench_Timer regex_timer;
+  for (long i = 0; i < regex_lookups; i++) {
+    bench_keep(regex_tags.find_unit_tag(unique_ids[i]));
+  }
+  double regex_seconds = regex_timer.seconds();
+
+  Bench_Timer unique_timer;
+  for (long i = 0; i < lookups; i++) {
+    bench_keep(unit_tags.find_unit_tag(unique_ids[i]));
+  }
+  double unique_seconds = unique_timer.seconds();
+
+  Bench_Timer busy_timer;
+  for (long i = 0; i < lookups; i++) {
+    bench_keep(unit_tags.find_unit_tag(busy_ids[i]));
+  }
+  double busy_seconds = busy_timer.seconds();
+
+  for (long i = 0; i < lookups; i += std::max(1L, lookups / 1000)) {
+    if (unit_tags.find_unit_tag(unique_ids[i]) != regex_tags.find_unit_tag(unique_ids[i])) {
+      std::cerr << "Mismatch for unit " << unique_ids[i] << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << rows << " unit tags" << std::endl;
+  std::cout << "regex per row:           " << (regex_seconds * 1e6 / regex_lookups) << " us per lookup" << std::endl;
+  std::cout << "map, every ID different: " << (unique_seconds * 1e6 / lookups) << " us per lookup" << std::endl;
+  std::cout << "map, 300 busy IDs:       " << (busy_seconds * 1e6 / lookups) << " us per lookup" << std::endl;
+  return 0;
+}
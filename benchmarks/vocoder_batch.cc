@@ -0,0 +1,104 @@
+// Many calls decoding voice frames at once, each on its own thread the way
+// each Recorder's frame assembler is, with software_imbe_decoder
+// synthesizing inline and then through vocoder_service. The service batches
+// the unvoiced DFT of the frames that are waiting together, and its audio
+// has to be exactly the same as the inline audio for every call. CPU time
+// is for the whole process, so it also counts the hand-off to the workers.
+//
+// usage: vocoder_batch [calls] [frames per call] [vocoder threads]
+
+#include "bench.h"
+
+#include "software_imbe_decoder.h"
+#include "vocoder_service.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Voice_Frames {
+  std::vector<int> L;
+  std::vector<float> w0;
+  std::vector<std::vector<int>> v;
+  std::vector<std::vector<float>> mu;
+};
+
+static Voice_Frames make_frames(long frames, unsigned int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> pitch(20, 122);
+  std::exponential_distribution<float> amplitude(1 / 300.0);
+  Voice_Frames f;
+  for (long i = 0; i < frames; i++) {
+    float w0 = 2 * M_PI / pitch(rng);
+    f.w0.push_back(w0);
+    f.L.push_back(std::max(9, std::min(56, (int)(0.9254 * (M_PI / w0 + 0.25)))));
+    std::vector<int> v(56);
+    std::vector<float> mu(56);
+    for (int ell = 0; ell < 56; ell++) {
+      v[ell] = rng() & 1;
+      mu[ell] = amplitude(rng);
+    }
+    f.v.push_back(v);
+    f.mu.push_back(mu);
+  }
+  return f;
+}
+
+static void decode_call(const Voice_Frames *frames, std::vector<float> *audio) {
+  software_imbe_decoder decoder;
+  for (size_t i = 0; i < frames->L.size(); i++) {
+    decoder.decode_tap(frames->L[i], 0, frames->w0[i], frames->v[i].data(), frames->mu[i].data());
+    audio_samples *samples = decoder.audio();
+    audio->insert(audio->end(), samples->begin(), samples->end());
+    samples->clear();
+  }
+}
+
+static void decode_calls(const std::vector<Voice_Frames> &frames, std::vector<std::vector<float>> &audio, const char *name) {
+  std::vector<std::thread> threads;
+  Bench_Timer timer;
+  std::clock_t cpu_start = std::clock();
+  for (size_t c = 0; c < frames.size(); c++) {
+    threads.push_back(std::thread(decode_call, &frames[c], &audio[c]));
+  }
+  for (size_t c = 0; c < threads.size(); c++) {
+    threads[c].join();
+  }
+  double cpu = (double)(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  double seconds = timer.seconds();
+  double total = (double)frames.size() * frames[0].L.size();
+  std::cout << name << (total / seconds) << " frames/sec, " << (cpu * 1e6 / total) << " us CPU per frame" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  long calls = bench_arg(argc, argv, 1, 16);
+  long frames = bench_arg(argc, argv, 2, 2000);
+  int threads = bench_arg(argc, argv, 3, 2);
+
+  std::vector<Voice_Frames> call_frames;
+  for (long c = 0; c < calls; c++) {
+    call_frames.push_back(make_frames(frames, c + 1));
+  }
+  std::cout << calls << " calls, " << frames << " frames each, " << threads << " vocoder threads" << std::endl;
+
+  std::vector<std::vector<float>> inline_audio(calls);
+  decode_calls(call_frames, inline_audio, "inline:          ");
+
+  std::vector<std::vector<float>> service_audio(calls);
+  vocoder_service::start(threads);
+  decode_calls(call_frames, service_audio, "vocoder_service: ");
+  vocoder_service::stop();
+
+  for (long c = 0; c < calls; c++) {
+    if (service_audio[c] != inline_audio[c]) {
+      std::cerr << "Call " << c << " sounds different through vocoder_service" << std::endl;
+      return 1;
+    }
+  }
+  std::cout << "the audio of every call is identical" << std::endl;
+  return 0;
+}
@@ -0,0 +1,138 @@
+// The prefilter of a P25 Recorder as flowgraphs: xlating_decim_filter
+// against the LO, mixer and FFT filters it replaced, for the single-stage and
+// the two-stage decimation. The default rate of 2.4 Msps takes the two-stage
+// path with a first decimation of 25, the same as p25_recorder_impl.
+//
+// usage: xlating_filter [input rate] [million samples]
+
+#include "bench.h"
+
+#include "../trunk-recorder/gr_blocks/xlating_decim_filter.h"
+
+#include <gnuradio/analog/sig_source.h>
+#include <gnuradio/blocks/head.h>
+#include <gnuradio/blocks/multiply.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/filter/fft_filter_ccc.h>
+#include <gnuradio/filter/fft_filter_ccf.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/top_block.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const double offset = 112500;
+
+static void run(gr::top_block_sptr tb, long samples, const std::string &name) {
+  Bench_Timer timer;
+  tb->run();
+  std::cout << "  " << name << (samples / timer.seconds() / 1e6) << " Msps" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  long input_rate = bench_arg(argc, argv, 1, 2400000);
+  long samples = bench_arg(argc, argv, 2, 200) * 1000000;
+  std::mt19937 rng(1);
+  std::normal_distribution<float> noise(0, 0.1);
+
+  std::vector<gr_complex> input(1 << 16);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = gr_complex(noise(rng), noise(rng));
+  }
+
+  // p25_recorder_impl::get_decim() for the two-stage rates, 0 for the single-stage
+  long decim = 0, decim2 = 0;
+  long if_freqs[] = {24000, 25000, 32000};
+  for (int i = 0; (i < 3) && !decim; i++) {
+    long q = input_rate / if_freqs[i];
+    if ((input_rate % if_freqs[i] == 0) && !(q & 1)) {
+      decim = ((q >= 40) && ((q & 3) == 0)) ? q / 4 : q / 2;
+      decim2 = ((q >= 40) && ((q & 3) == 0)) ? 4 : 2;
+    }
+  }
+
+  std::cout << input_rate << " sps input, " << samples << " samples" << std::endl;
+
+  if (decim) {
+    double if1 = input_rate / decim;
+    double if2 = if1 / decim2;
+    double fa = 6250, fb = if2 / 2;
+    std::vector<gr_complex> bandpass_taps = gr::filter::firdes::complex_band_pass(1.0, input_rate, -offset - if1 / 2, -offset + if1 / 2, if1 / 2);
+    std::vector<float> prefilter_taps = gr::filter::firdes::low_pass(1.0, input_rate, if1 / 2, if1 / 2);
+    std::vector<float> lowpass_taps = gr::filter::firdes::low_pass(1.0, if1, (fb + fa) / 2, fb - fa);
+    std::cout << "two-stage, decimation " << decim << " then " << decim2 << ", " << prefilter_taps.size() << " first stage taps" << std::endl;
+
+    // Before: a complex band pass, then the BFO mix at the first IF, then the low pass
+    {
+      gr::top_block_sptr tb = gr::make_top_block("old_two_stage");
+      gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input, true);
+      gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), samples);
+      gr::filter::fft_filter_ccc::sptr bandpass = gr::filter::fft_filter_ccc::make(decim, bandpass_taps);
+      gr::analog::sig_source_c::sptr bfo = gr::analog::sig_source_c::make(if1, gr::analog::GR_SIN_WAVE, offset, 1.0, 0.0);
+      gr::blocks::multiply_cc::sptr mixer = gr::blocks::multiply_cc::make();
+      gr::filter::fft_filter_ccf::sptr lowpass = gr::filter::fft_filter_ccf::make(decim2, lowpass_taps);
+      gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+      tb->connect(source, 0, head, 0);
+      tb->connect(head, 0, bandpass, 0);
+      tb->connect(bandpass, 0, mixer, 0);
+      tb->connect(bfo, 0, mixer, 1);
+      tb->connect(mixer, 0, lowpass, 0);
+      tb->connect(lowpass, 0, sink, 0);
+      run(tb, samples, "band pass + BFO + low pass:       ");
+    }
+
+    // After: the mix folded into a decimating filter, then the same low pass
+    {
+      gr::top_block_sptr tb = gr::make_top_block("new_two_stage");
+      gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input, true);
+      gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), samples);
+      gr::blocks::xlating_decim_filter::sptr prefilter = gr::blocks::xlating_decim_filter::make(decim, prefilter_taps, offset, input_rate);
+      gr::filter::fft_filter_ccf::sptr lowpass = gr::filter::fft_filter_ccf::make(decim2, lowpass_taps);
+      gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+      tb->connect(source, 0, head, 0);
+      tb->connect(head, 0, prefilter, 0);
+      tb->connect(prefilter, 0, lowpass, 0);
+      tb->connect(lowpass, 0, sink, 0);
+      run(tb, samples, "xlating_decim_filter + low pass:  ");
+    }
+  }
+
+  // The single-stage path, used when the rate has no two-stage split and for channelized sources
+  long single_decim = input_rate / 24000;
+  std::vector<float> single_taps = gr::filter::firdes::low_pass(1.0, input_rate, 7250, 1450);
+  std::cout << "single-stage, decimation " << single_decim << ", " << single_taps.size() << " taps" << std::endl;
+
+  // Before: a full rate LO and mixer in front of the decimating low pass
+  {
+    gr::top_block_sptr tb = gr::make_top_block("old_single_stage");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input, true);
+    gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), samples);
+    gr::analog::sig_source_c::sptr lo = gr::analog::sig_source_c::make(input_rate, gr::analog::GR_SIN_WAVE, -offset, 1.0, 0.0);
+    gr::blocks::multiply_cc::sptr mixer = gr::blocks::multiply_cc::make();
+    gr::filter::fft_filter_ccf::sptr lowpass = gr::filter::fft_filter_ccf::make(single_decim, single_taps);
+    gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+    tb->connect(source, 0, head, 0);
+    tb->connect(head, 0, mixer, 0);
+    tb->connect(lo, 0, mixer, 1);
+    tb->connect(mixer, 0, lowpass, 0);
+    tb->connect(lowpass, 0, sink, 0);
+    run(tb, samples, "LO + mixer + low pass:            ");
+  }
+
+  {
+    gr::top_block_sptr tb = gr::make_top_block("new_single_stage");
+    gr::blocks::vector_source_c::sptr source = gr::blocks::vector_source_c::make(input, true);
+    gr::blocks::head::sptr head = gr::blocks::head::make(sizeof(gr_complex), samples);
+    gr::blocks::xlating_decim_filter::sptr prefilter = gr::blocks::xlating_decim_filter::make(single_decim, single_taps, offset, input_rate);
+    gr::blocks::null_sink::sptr sink = gr::blocks::null_sink::make(sizeof(gr_complex));
+    tb->connect(source, 0, head, 0);
+    tb->connect(head, 0, prefilter, 0);
+    tb->connect(prefilter, 0, sink, 0);
+    run(tb, samples, "xlating_decim_filter:             ");
+  }
+  return 0;
+}
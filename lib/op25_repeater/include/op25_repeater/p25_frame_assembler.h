@@ -64,6 +64,8 @@ namespace gr {
       virtual void set_phase2_tdma(bool p) {}
       virtual void clear() {};
       virtual  void clear_silence_frame_count() {};
+      virtual uint64_t get_samples_produced() { return 0; }
+      virtual uint64_t get_samples_dropped() { return 0; }
     };
 
   } // namespace op25_repeater
@@ -0,0 +1,103 @@
+/* -*- c++ -*- */
+/*
+ * Fixed-size ring buffer for decoded audio samples
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_OP25_AUDIO_RING_H
+#define INCLUDED_OP25_AUDIO_RING_H
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// The decoders write voice frames into this ring and the owning block's
+// work() drains it into the output buffer. Both sides run on the block's
+// thread, so no locking is needed. The storage is allocated once; when the
+// ring is full new samples are dropped and counted instead of growing.
+class audio_ring {
+public:
+	static const size_t DEFAULT_CAPACITY = 32768;	// must be a power of two
+
+	audio_ring(size_t capacity = DEFAULT_CAPACITY) :
+		d_buf(capacity),
+		d_mask(capacity - 1),
+		d_head(0),
+		d_tail(0),
+		d_produced(0),
+		d_dropped(0)
+	{
+	}
+
+	size_t size() const { return d_head - d_tail; }
+	bool empty() const { return d_head == d_tail; }
+	size_t capacity() const { return d_buf.size(); }
+	void clear() { d_tail = d_head; }
+
+	// total samples accepted into / discarded by the ring since construction
+	uint64_t get_produced() const { return d_produced; }
+	uint64_t get_dropped() const { return d_dropped; }
+
+	void push_back(int16_t sample) {
+		if (size() == d_buf.size()) {
+			d_dropped++;
+			return;
+		}
+		d_buf[d_head++ & d_mask] = sample;
+		d_produced++;
+	}
+
+	// append up to n samples, returns the number accepted
+	size_t write(const int16_t *in, size_t n) {
+		size_t space = d_buf.size() - size();
+		size_t amt = std::min(n, space);
+		d_dropped += n - amt;
+		d_produced += amt;
+		copy_in(in, amt);
+		return amt;
+	}
+
+	// remove up to max samples into out, returns the number copied
+	size_t read(int16_t *out, size_t max) {
+		size_t amt = std::min(max, size());
+		size_t pos = d_tail & d_mask;
+		size_t first = std::min(amt, d_buf.size() - pos);
+		memcpy(out, &d_buf[pos], first * sizeof(int16_t));
+		memcpy(out + first, &d_buf[0], (amt - first) * sizeof(int16_t));
+		d_tail += amt;
+		return amt;
+	}
+
+private:
+	void copy_in(const int16_t *in, size_t amt) {
+		size_t pos = d_head & d_mask;
+		size_t first = std::min(amt, d_buf.size() - pos);
+		memcpy(&d_buf[pos], in, first * sizeof(int16_t));
+		memcpy(&d_buf[0], in + first, (amt - first) * sizeof(int16_t));
+		d_head += amt;
+	}
+
+	std::vector<int16_t> d_buf;
+	size_t d_mask;
+	size_t d_head;
+	size_t d_tail;
+	uint64_t d_produced;
+	uint64_t d_dropped;
+};
+
+#endif /* INCLUDED_OP25_AUDIO_RING_H */
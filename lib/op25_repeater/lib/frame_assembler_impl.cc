@@ -135,9 +135,7 @@ namespace gr {
                 const uint8_t *in = (const uint8_t *) input_items[0];
 
                 if (d_sync) {
-                    for (int i=0; i<ninput_items[0]; i++) {
-                        d_sync->rx_sym(in[i]);
-                    }
+                    d_sync->rx_sym(in, ninput_items[0]);
                 }
         
         int amt_produce = 0;
@@ -0,0 +1,96 @@
+//
+// Block search for frame sync patterns
+//
+// This file is part of OP25
+//
+// OP25 is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// OP25 is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OP25; see the file COPYING. If not, write to the Free
+// Software Foundation, Inc., 51 Franklin Street, Boston, MA
+// 02110-1301, USA.
+
+#ifndef INCLUDED_FRAME_SYNC_SCANNER_H
+#define INCLUDED_FRAME_SYNC_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Finds the few positions in a buffer of dibits where any of a set of
+ * sync patterns could be present with up to err_threshold bit errors.
+ *
+ * The sync window is split into err_threshold+1 chunks. That many errors
+ * can't touch every chunk, so at a real sync at least one chunk matches
+ * its pattern exactly. One table per chunk marks every value the chunk
+ * takes in any of the patterns, which turns the search into a couple of
+ * bit lookups per symbol however many patterns there are. On noise well
+ * under 2% of symbols are flagged, and check_frame_sync() only has to run
+ * on those to get exactly the same answer as running it everywhere.
+ */
+class frame_sync_scanner {
+public:
+	frame_sync_scanner() : d_nchunks(0), d_chunk_bits(0), d_chunk_mask(0), d_words(0) {}
+
+	// lens are the pattern lengths in bits, as passed to check_frame_sync()
+	void set_patterns(const uint64_t *magics, const int *lens, int nmagics, int err_threshold) {
+		int max_len = 0;
+		for (int i = 0; i < nmagics; i++)
+			max_len = (lens[i] > max_len) ? lens[i] : max_len;
+
+		d_nchunks = err_threshold + 1;
+		d_chunk_bits = (max_len + d_nchunks - 1) / d_nchunks;
+		d_chunk_mask = (1ULL << d_chunk_bits) - 1;
+		d_words = (d_chunk_mask >> 6) + 1;
+		d_table.assign(d_nchunks * d_words, 0);
+
+		for (int i = 0; i < nmagics; i++) {
+			for (int c = 0; c < d_nchunks; c++) {
+				// bits of the chunk past the end of a shorter pattern can be anything
+				int lo = c * d_chunk_bits;
+				int inside = lens[i] - lo;
+				inside = (inside < 0) ? 0 : ((inside > d_chunk_bits) ? d_chunk_bits : inside);
+				uint64_t value = (magics[i] >> lo) & ((1ULL << inside) - 1);
+				for (uint64_t fill = 0; fill < (1ULL << (d_chunk_bits - inside)); fill++) {
+					uint64_t v = value | (fill << inside);
+					d_table[c * d_words + (v >> 6)] |= 1ULL << (v & 63);
+				}
+			}
+		}
+	}
+
+	// reg is the sync register before the first dibit. Sets hits[i] when
+	// the register after dibit i might hold a pattern, and returns the
+	// register after the last dibit.
+	uint64_t scan(uint64_t reg, const uint8_t *syms, int nsyms, uint8_t *hits) const {
+		const uint64_t *table = d_table.data();
+		for (int i = 0; i < nsyms; i++) {
+			reg = (reg << 2) | (syms[i] & 3);
+			uint64_t hit = 0;
+			for (int c = 0; c < d_nchunks; c++) {
+				uint64_t v = (reg >> (c * d_chunk_bits)) & d_chunk_mask;
+				hit |= table[c * d_words + (v >> 6)] >> (v & 63);
+			}
+			hits[i] = hit & 1;
+		}
+		return reg;
+	}
+
+private:
+	int d_nchunks;
+	int d_chunk_bits;
+	uint64_t d_chunk_mask;
+	size_t d_words;
+	std::vector<uint64_t> d_table;
+};
+
+#endif /* INCLUDED_FRAME_SYNC_SCANNER_H */
@@ -108,6 +108,7 @@ static const int MAX_IN = 1;	// maximum number of input streams
 	d_do_msgq(do_msgq),
 	d_msg_queue(queue),
 	output_queue(),
+	d_terminate_pending(false),
 	op25audio(udp_host, port, debug),
   d_input_rate(4800),
   d_tag_src(pmt::intern(name())), 
@@ -215,22 +216,24 @@ p25_frame_assembler_impl::general_work (int noutput_items,
 
       // If this block is being used for Trunking, then you want to skip all of this.
       if (d_do_audio_output) {
-        amt_produce = output_queue.size();
         int16_t *out = (int16_t *)output_items[0];
 
+        // a termination that arrived while audio was still being produced is held until the queue drains
+        if (d_terminate_pending) {
+          terminate_call = true;
+          d_terminate_pending = false;
+        }
+
         //BOOST_LOG_TRIVIAL(trace) << "P25 Frame Assembler -  output_queue: " << output_queue.size() << " noutput_items: " <<  noutput_items << " ninput_items: " << ninput_items[0];
 
-        if (amt_produce > 0) {
-            if (amt_produce >= 32768) {
-              BOOST_LOG_TRIVIAL(error) << "P25 Frame Assembler -  output_queue size: " << output_queue.size() << " max size: " << output_queue.max_size() << " limiting amt_produce to  32767 ";
-              
-              amt_produce = 32767; // buffer limit is 32768, see gnuradio/gnuradio-runtime/lib/../include/gnuradio/buffer.h:186
-            }
+        // anything that doesn't fit in this call stays queued for the next one
+        amt_produce = output_queue.read(out, noutput_items);
 
-            for (int i = 0; i < amt_produce; i++) {
-              out[i] = output_queue[i];
+        if (amt_produce > 0) {
+            // the terminate tags go out on the next call that has no audio left, after these samples
+            if (terminate_call) {
+              d_terminate_pending = true;
             }
-            output_queue.erase(output_queue.begin(), output_queue.begin() + amt_produce);
 
             send_grp_src_id();
 
@@ -266,6 +269,14 @@ p25_frame_assembler_impl::general_work (int noutput_items,
   return amt_produce;
 }
 
+    uint64_t p25_frame_assembler_impl::get_samples_produced() {
+      return output_queue.get_produced();
+    }
+
+    uint64_t p25_frame_assembler_impl::get_samples_dropped() {
+      return output_queue.get_dropped();
+    }
+
     void p25_frame_assembler_impl::clear_silence_frame_count() {
       silence_frame_count = 0;
     }
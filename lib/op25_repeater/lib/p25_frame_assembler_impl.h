@@ -70,7 +70,8 @@ namespace gr {
     void set_debug(int debug) ;
     void reset_timer() ;
 	typedef std::vector<bool> bit_vector;
-	std::deque<int16_t> output_queue;
+	audio_ring output_queue;
+	bool d_terminate_pending;
 
   void p25p2_queue_msg(int duid);
   void set_phase2_tdma(bool p);
@@ -90,6 +91,8 @@ public:
 
       void clear_silence_frame_count();
       void clear();
+      uint64_t get_samples_produced();
+      uint64_t get_samples_dropped();
       log_ts logts;
     };
 
@@ -198,7 +198,7 @@ namespace gr {
                 fprintf(stderr, "%s p25p1_fdma::set_nac: 0x%03x\n", logts.get(d_msgq_id), d_nac);
         }
 
-        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
+        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, audio_ring &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
             write_bufp(0),
             d_debug(debug),
             d_do_imbe(do_imbe),
@@ -717,9 +717,6 @@ namespace gr {
 					rx_status.error_count += imbe_error;
 					rx_status.total_len += 144;
 					//rx_status.last_update = time(NULL); //uncomment to ignore post-voice frames
-					// output one 32-byte msg per 0.020 sec.
-					// also, 32*9 = 288 byte pkts (for use via UDP)
-					sprintf(s, "%03x %03x %03x %03x %03x %03x %03x %03x\n", u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7]);
 
                     if (d_do_audio_output) {
                         if ( !encrypted()) {
@@ -753,9 +750,7 @@ namespace gr {
                             if (op25audio.enabled()) {      // decoded audio goes out via UDP (normal code path)
                                 op25audio.send_audio(snd, SND_FRAME * sizeof(int16_t));
                             } else {                        // decoded audio back to gnuradio (still supported?)
-                                for (int i = 0; i < SND_FRAME; i++) {
-                                    output_queue.push_back(snd[i]);
-                                }
+                                output_queue.write(snd, SND_FRAME);
                             }
                         } else {
                             std::string encr = "{\"encrypted\": " + std::to_string(1) + ", \"algid\": " + std::to_string(ess_algid) + ", \"keyid\": " + std::to_string(ess_keyid) + "}";
@@ -764,6 +759,8 @@ namespace gr {
                     }
 
                     if (d_do_output && !d_do_audio_output) { // ugh! - legacy wireshark support
+                        // output one 32-byte msg per 0.020 sec.
+                        // also, 32*9 = 288 byte pkts (for use via UDP)
                         sprintf(s, "%03x %03x %03x %03x %03x %03x %03x %03x\n", u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7]);
                         for (size_t j=0; j < strlen(s); j++) {
                             output_queue.push_back(s[j]);
@@ -34,6 +34,7 @@
 #include "p25p2_framer.h"
 #include "p25_crypt_algs.h"
 #include "op25_audio.h"
+#include "audio_ring.h"
 #include "log_ts.h"
 
 #include "ezpwd/rs"
@@ -42,7 +43,7 @@
 class p25p2_tdma
 {
 public:
-	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &qptr, bool do_audio_output, int msgq_id = 0) ;	// constructor
+	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, audio_ring &qptr, bool do_audio_output, int msgq_id = 0) ;	// constructor
 	int handle_packet(uint8_t dibits[], const uint64_t fs) ;
 	void set_slotid(int slotid);
 	void crypt_reset();
@@ -76,7 +77,7 @@ private:
 	bool tone_frame;
 	software_imbe_decoder software_decoder;
 	gr::msg_queue::sptr d_msg_queue;
-	std::deque<int16_t> &output_queue_decode;
+	audio_ring &output_queue_decode;
 	bool d_do_msgq;
 	int d_msgq_id;
 	bool d_do_audio_output;
@@ -28,6 +28,7 @@ namespace gr{
         class rx_base {
             public:
                 virtual void rx_sym(const uint8_t sym) = 0;
+                virtual void rx_sym(const uint8_t *syms, int nsyms) { for (int i = 0; i < nsyms; i++) rx_sym(syms[i]); };
                 virtual void sync_reset(void) = 0;
                 virtual void crypt_reset(void) = 0;
                 virtual void crypt_key(uint16_t keyid, uint8_t algid, const std::vector<uint8_t> &key) = 0;
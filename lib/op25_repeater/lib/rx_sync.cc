@@ -52,6 +52,9 @@
 namespace gr{
     namespace op25_repeater{
 
+// highest number of bit errors a sync pattern is accepted with
+static const int MAX_SYNC_THRESHOLD = 2;
+
 void rx_sync::cbuf_insert(const uint8_t c) {
 	d_cbuf[d_cbuf_idx] = c;
 	d_cbuf[d_cbuf_idx + CBUF_SIZE] = c;
@@ -75,6 +78,7 @@ void rx_sync::sync_reset(void) {
 	d_threshold = 0;
 	d_shift_reg = 0;
 	d_sync_reg = 0;
+	d_sync_exact = 32;	// register no longer matches what a block scan assumed
 	d_fs = 0;
 	d_expires = 0;
 	d_current_type = RX_TYPE_NONE;
@@ -247,6 +251,14 @@ rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, g
 	mbe_initToneParms (&tone_mp[1]);
 	mbe_err_cnt[0] = 0;
 	mbe_err_cnt[1] = 0;
+	uint64_t magics[KNOWN_MAGICS];
+	int lens[KNOWN_MAGICS];
+	for (int i = 0; i < KNOWN_MAGICS; i++) {
+		magics[i] = SYNC_MAGIC[i].magic;
+		lens[i] = MODE_DATA[SYNC_MAGIC[i].type].sync_len;
+	}
+	d_sync_scanner.set_patterns(magics, lens, KNOWN_MAGICS, MAX_SYNC_THRESHOLD);
+	d_check_timer = true;
 	sync_reset();
 }
 
@@ -471,6 +483,40 @@ int rx_sync::get_src_id(int slot) {
 
 
 void rx_sync::rx_sym(const uint8_t sym)
+{
+    if (d_slot_mask & 0x4) { // Setting bit 3 of slot mask disables framing for idle receiver 
+        return;
+    }
+
+	d_check_timer = true;
+	process_sym(sym, true);
+}
+
+/*
+ * rx_sym: called with a whole buffer of symbols
+ * The scanner looks for every sync pattern at every position of the buffer
+ * in one pass, allowing as many errors as the exact check ever does. The
+ * exact check then only has to run where the scan found a candidate, or
+ * just after a reset when the sync register was cleared.
+ */
+void rx_sync::rx_sym(const uint8_t *syms, int nsyms)
+{
+    if (d_slot_mask & 0x4) { // Setting bit 3 of slot mask disables framing for idle receiver 
+        return;
+    }
+
+	if ((int)d_scan_hits.size() < nsyms)
+		d_scan_hits.resize(nsyms);
+	d_sync_scanner.scan(d_sync_reg, syms, nsyms, d_scan_hits.data());
+
+	// the idle timeout doesn't need checking more than once a buffer
+	d_check_timer = true;
+	for (int i = 0; i < nsyms; i++) {
+		process_sym(syms[i], d_scan_hits[i] || (d_sync_exact > 0));
+	}
+}
+
+void rx_sync::process_sym(const uint8_t sym, bool sync_candidate)
 {
 	uint8_t bitbuf[864*2];
 	enum rx_types sync_detected = RX_TYPE_NONE;
@@ -479,13 +525,11 @@ void rx_sync::rx_sym(const uint8_t sym)
 	bool ysf_fullrate;
 	int excess_count = 0;
 
-    if (d_slot_mask & 0x4) { // Setting bit 3 of slot mask disables framing for idle receiver 
-        return;
-    }
-
 	d_symbol_count ++;
 	d_sync_reg = (d_sync_reg << 2) | (sym & 3);
-	for (int i = 0; i < KNOWN_MAGICS; i++) {
+	if (d_sync_exact > 0)
+		d_sync_exact--;
+	for (int i = 0; sync_candidate && (i < KNOWN_MAGICS); i++) {
 		if (check_frame_sync(SYNC_MAGIC[i].magic ^ d_sync_reg, (SYNC_MAGIC[i].type == d_current_type) ? d_threshold : 0, MODE_DATA[SYNC_MAGIC[i].type].sync_len)) {
 			sync_detected = (enum rx_types) SYNC_MAGIC[i].type;
             d_fs = SYNC_MAGIC[i].magic;
@@ -494,8 +538,11 @@ void rx_sync::rx_sym(const uint8_t sym)
 	}
 	cbuf_insert(sym);
 	if (d_current_type == RX_TYPE_NONE && sync_detected == RX_TYPE_NONE) {
-		if (sync_timer.expired()) {
-			sync_timeout(RX_TYPE_NONE);
+		if (d_check_timer) {
+			d_check_timer = false;
+			if (sync_timer.expired()) {
+				sync_timeout(RX_TYPE_NONE);
+			}
 		}
 		return;
         }
@@ -519,7 +566,7 @@ void rx_sync::rx_sym(const uint8_t sym)
 			sync_reset();
 			d_rx_count = MODE_DATA[d_current_type].sync_offset + (MODE_DATA[d_current_type].sync_len >> 1);
 		} else {
-			d_threshold = std::min(d_threshold + 1, 2);
+			d_threshold = std::min(d_threshold + 1, MAX_SYNC_THRESHOLD);
 		}
 		d_expires = d_symbol_count + MODE_DATA[d_current_type].expiration;
 	}
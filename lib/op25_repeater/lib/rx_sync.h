@@ -28,11 +28,13 @@
 #include <string>
 #include <iostream>
 #include <deque>
+#include <vector>
 #include <assert.h>
 #include <gnuradio/msg_queue.h>
 
 #include "bit_utils.h"
 #include "check_frame_sync.h"
+#include "frame_sync_scanner.h"
 
 #include "frame_sync_magics.h"
 #include "p25p1_fdma.h"
@@ -113,6 +115,7 @@ enum codeword_types {
 class rx_sync : public rx_base {
 public:
 	void rx_sym(const uint8_t sym);
+	void rx_sym(const uint8_t *syms, int nsyms);
 	void sync_reset(void);
 	void reset_timer(void);
 	void crypt_reset(void);
@@ -128,6 +131,7 @@ public:
 	~rx_sync();
 
 private:
+	void process_sym(const uint8_t sym, bool sync_candidate);
 	void sync_timeout(rx_types proto);
 	void sync_established(rx_types proto);
 	void cbuf_insert(const uint8_t c);
@@ -162,7 +166,7 @@ private:
 	mbe_tone tone_mp[2];
 	int mbe_err_cnt[2];
 	software_imbe_decoder d_software_decoder[2];
-	std::deque<int16_t> d_output_queue[2];
+	audio_ring d_output_queue[2];
 	dmr_cai dmr;
 	int d_msgq_id;
 	gr::msg_queue::sptr d_msg_queue;
@@ -172,6 +176,12 @@ private:
 	log_ts& logts;
 	std::array<std::deque<int16_t>, 2> &output_queue;
 	int src_id[2];
+
+	// block sync search: see rx_sym(const uint8_t *syms, int nsyms)
+	frame_sync_scanner d_sync_scanner;
+	std::vector<uint8_t> d_scan_hits;
+	int d_sync_exact;
+	bool d_check_timer;
 };
 
     } // end namespace op25_repeater
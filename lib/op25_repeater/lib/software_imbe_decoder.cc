@@ -26,6 +26,7 @@
 #include "op25_imbe_frame.h"
 #include "op25_golay.h"
 #include "op25_hamming.h"
+#include "vocoder_service.h"
 
 #include <algorithm>
 #include <cstdio>
@@ -729,6 +730,37 @@ static const float PhzNz[57] = {
 	0.068775, 0.520336, 2.339119, -0.808328, 1.332154, 2.929768, -0.338316, 0.022767, -1.063795
 };
 
+// cos and sin of -2 * pi * k / 256, the twiddle factors of the DFT in unvoiced_dft()
+struct dft_twiddles {
+   float c[256];
+   float s[256];
+   dft_twiddles() {
+      for (int k = 0; k < 256; k++) {
+         c[k] = cos(2 * M_PI * k / 256);
+         s[k] = -sin(2 * M_PI * k / 256);
+      }
+   }
+};
+
+static const dft_twiddles twiddles;
+
+// Adds win[n] * amp * cos(phase + step * n) to out[n] for n = 0 .. count - 1.
+// The cosine comes from a phasor that is rotated by step every sample,
+// instead of a cos() call per sample.
+static inline void add_harmonic(float *out, const float *win, float amp, double phase, double step, int count)
+{
+   double re = cos(phase), im = sin(phase);
+   const double dr = cos(step), di = sin(step);
+   double t;
+
+   for (int n = 0; n < count; n++) {
+      out[n] += win[n] * amp * re;
+      t = re * dr - im * di;
+      im = re * di + im * dr;
+      re = t;
+   }
+}
+
 software_imbe_decoder::software_imbe_decoder()
 {
    int i,j;
@@ -737,6 +769,8 @@ software_imbe_decoder::software_imbe_decoder()
    rpt_ctr = 0;
    OldL = 0;
    L = 9;
+   w0 = 0.0;
+   Oldw0 = 0.0;
    Old = 1; New = 0;
    psi1 = 0.0;
    for(i=0; i < 58; i++) {
@@ -747,6 +781,9 @@ software_imbe_decoder::software_imbe_decoder()
    for(i=0; i < 57; i++) {
       for(j=0; j < 2; j++) {
          phi[i][j] = 0.0;
+         M[i][j] = 0.0;
+         Mu[i][j] = 0.0;
+         vee[i][j] = 0;
       }
    }
    for(i=0; i < 256; i++) {
@@ -896,8 +933,7 @@ software_imbe_decoder::decode_fullrate(uint32_t u0, uint32_t u1, uint32_t u2, ui
 		// (8000 samp/sec) * (1 sec / 50 compressed voice frames) = 160 samples/frame
 
 		//synth:
-		synth_unvoiced();// ToDo: make suv return value?
-		synth_voiced(); // ToDo: make sv return value?
+		synthesize();
 
 		//output:
 		audio_samples *samples = audio();
@@ -948,8 +984,7 @@ software_imbe_decoder::decode_tap(int _L, int _K, float _w0, const int * _v, con
 	// (8000 samp/sec) * (1 sec / 50 compressed voice frames) = 160 samples/frame
 
 	//synth:
-	synth_unvoiced();// ToDo: make suv return value?
-	synth_voiced(); // ToDo: make sv return value?
+	synthesize();
 
 	//output:
 	audio_samples *samples = audio();
@@ -1487,14 +1522,25 @@ software_imbe_decoder::rearrange(uint32_t u0, uint32_t u1, uint32_t u2, uint32_t
 }
 
 void
-software_imbe_decoder::synth_unvoiced()
+software_imbe_decoder::synthesize()
 {
-   float Uwi[256];
-   float Uwq[256];
-   float uw[256];
+   if (!vocoder_service::synthesize(this)) {
+      synth_unvoiced();
+      synth_voiced();
+   }
+}
 
-   float Tmp;
+void
+software_imbe_decoder::synth_unvoiced()
+{
+   unvoiced_noise();
+   unvoiced_dft();
+   unvoiced_shape();
+}
 
+void
+software_imbe_decoder::unvoiced_noise()
+{
    int ell, bl, em, al, en;
 
    // Generate the next 160 samples of white noise
@@ -1504,6 +1550,118 @@ software_imbe_decoder::synth_unvoiced()
    for (; en < 211; en++) {
       u[en] = next_u(u[en-1]);
    }
+   // and window it once for all of the bands
+   for (en = 0; en < 211; en++) {
+      uws[en] = u[en] * ws[en];
+   }
+
+   // mark the DFT bins of the unvoiced bands
+   for (em = 0; em < 256; em++) {
+      dft_bin[em] = false;
+   }
+   ell = 0; bl =(int) ceilf(128 / M_PI *(ell + .5) * w0);
+   for(ell = 1; ell <= L; ell++) {
+      al = bl; bl =(int) ceilf(128 / M_PI * (ell + .5) * w0);
+      if(!vee[ell][New]) {
+         for(em = al; em <= bl - 1; em++) {
+            dft_bin[em] = true;
+         }
+      }
+   }
+}
+
+void
+software_imbe_decoder::unvoiced_dft()
+{
+   int em, en;
+
+   for (em = 0; em < 256; em++) {
+      if (!dft_bin[em]) {
+         continue;
+      }
+      Uwi[em] = 0;
+      Uwq[em] = 0;
+      // exp(-j * pi / 128 * em * (en - 105)) repeats every 256, so it comes from the twiddle table
+      for (en = 0; en < 211; en++) {
+         unsigned int k = (unsigned int)(em * (en - 105)) & 255;
+         Uwi[em] = Uwi[em] + uws[en] * twiddles.c[k];
+         Uwq[em] = Uwq[em] + uws[en] * twiddles.s[k];
+      }
+   }
+}
+
+/*
+ * The same DFT for up to VOCODER_LANES decoders at once. Each bin any of
+ * them needs is computed for all of them: the twiddle factors of the bin
+ * are looked up once, then applied across the lanes, which the compiler
+ * vectorizes as long as it doesn't unroll the lane loop first. Each lane
+ * adds up its terms in the same order as unvoiced_dft(), so the result is
+ * exactly the same.
+ */
+void
+software_imbe_decoder::unvoiced_dft(software_imbe_decoder *decoders[], int count)
+{
+   float lanes_uws[211][VOCODER_LANES];
+   float lanes_i[VOCODER_LANES];
+   float lanes_q[VOCODER_LANES];
+   float c[211];
+   float s[211];
+   bool any_bin[256];
+   int em, en, lane;
+
+   for (en = 0; en < 211; en++) {
+      for (lane = 0; lane < VOCODER_LANES; lane++) {
+         lanes_uws[en][lane] = (lane < count) ? decoders[lane]->uws[en] : 0;
+      }
+   }
+   for (em = 0; em < 256; em++) {
+      any_bin[em] = false;
+      for (lane = 0; lane < count; lane++) {
+         any_bin[em] = any_bin[em] || decoders[lane]->dft_bin[em];
+      }
+   }
+
+   for (em = 0; em < 256; em++) {
+      if (!any_bin[em]) {
+         continue;
+      }
+      for (en = 0; en < 211; en++) {
+         unsigned int k = (unsigned int)(em * (en - 105)) & 255;
+         c[en] = twiddles.c[k];
+         s[en] = twiddles.s[k];
+      }
+      for (lane = 0; lane < VOCODER_LANES; lane++) {
+         lanes_i[lane] = 0;
+         lanes_q[lane] = 0;
+      }
+      for (en = 0; en < 211; en++) {
+#if defined(__clang__)
+#pragma clang loop unroll(disable)
+#elif defined(__GNUC__)
+#pragma GCC unroll 1
+#endif
+         for (lane = 0; lane < VOCODER_LANES; lane++) {
+            lanes_i[lane] = lanes_i[lane] + lanes_uws[en][lane] * c[en];
+            lanes_q[lane] = lanes_q[lane] + lanes_uws[en][lane] * s[en];
+         }
+      }
+      for (lane = 0; lane < count; lane++) {
+         if (decoders[lane]->dft_bin[em]) {
+            decoders[lane]->Uwi[em] = lanes_i[lane];
+            decoders[lane]->Uwq[em] = lanes_q[lane];
+         }
+      }
+   }
+}
+
+void
+software_imbe_decoder::unvoiced_shape()
+{
+   float uw[256];
+
+   float Tmp;
+
+   int ell, bl, em, al, en;
 
    ell = 0; bl =(int) ceilf(128 / M_PI *(ell + .5) * w0);
    for(em = 0; em <= bl - 1; em++) {
@@ -1519,16 +1677,8 @@ software_imbe_decoder::synth_unvoiced()
             Uwi[em] = 0; Uwq[em] = 0;
          }
       } else {
+         // the DFT of the band is already in Uwi and Uwq
          Luv = Luv + 1;
-         for(em = al; em <= bl - 1; em++) {
-            Uwi[em] = 0;
-            Uwq[em] = 0;
-            for (en = 0; en < 211; en++) {
-               float exp = -0.0078125 * M_PI * em * (en - 105);
-               Uwi[em] = Uwi[em] + u[en] * ws[en] * cos(exp);
-               Uwq[em] = Uwq[em] + u[en] * ws[en] * sin(exp);
-            }
-         }
          //precompute Tmp = <most of big hairy equation>
          Tmp = 0;
          // FOR en = al TO bl - 1
@@ -1629,31 +1779,32 @@ software_imbe_decoder::synth_voiced()
                THa = (Oldw0 * (float)ell + Dwl);
                THb = (w0 - Oldw0) * ell * .003125;
                Mb = .00625 *(MNew - MOld);
-               for(en = 0; en <= 159; en++) {
-                  sv[en] = sv[en] +(MOld + en * Mb) * cos(phi[ell][ Old] +(THa + THb * en) * en);
+               // the phase is quadratic in en, so the step of the phasor is rotated as well
+               {
+                  double re = cos(phi[ell][ Old]), im = sin(phi[ell][ Old]);
+                  double sr = cos(THa + THb), si = sin(THa + THb);
+                  const double dr = cos(2 * THb), di = sin(2 * THb);
+                  double t;
+                  for(en = 0; en <= 159; en++) {
+                     sv[en] = sv[en] +(MOld + en * Mb) * re;
+                     t = re * sr - im * si;
+                     im = re * si + im * sr;
+                     re = t;
+                     t = sr * dr - si * di;
+                     si = sr * di + si * dr;
+                     sr = t;
+                  }
                }
             } else { // (coarse transition)
-               for(en = 0; en <= 55; en++) {
-                  sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell] [ Old]);
-               }
-               for(en = 56; en <= 105; en++) {
-                  sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell][ Old]);
-                  sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
-               }
-               for(en = 106; en <= 159; en++) {
-                  sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
-               }
+               add_harmonic(&sv[0], &ws[105], MOld, phi[ell][ Old], Oldw0 * ell, 106);
+               add_harmonic(&sv[56], &ws[1], MNew, phi[ell][ New] - w0 * 104 * ell, w0 * ell, 104);
             }
          } else {
-            for(en = 56; en <= 159; en++) {
-               sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
-            }
+            add_harmonic(&sv[56], &ws[1], MNew, phi[ell][ New] - w0 * 104 * ell, w0 * ell, 104);
          }
       } else {
          if( vee[ell][Old]) {
-            for(en = 0; en <= 105; en++) {
-               sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell][ Old]);
-            }
+            add_harmonic(&sv[0], &ws[105], MOld, phi[ell][ Old], Oldw0 * ell, 106);
          }
       }
    }
@@ -28,6 +28,9 @@
 
 #include <stdint.h>
 
+// The most decoders vocoder_service synthesizes together
+static const int VOCODER_LANES = 8;
+
 /**
  * A software implementation of the imbe_decoder interface.
  */
@@ -55,6 +58,7 @@ public:
 	void decode_tap(int _L, int _K, float _w0, const int * _v, const float * _mu);
 	void decode_tone(int _ID, int _AD, int * _n);
 private:
+	friend class vocoder_service;
 
 	//NOTE: Single-letter variable names are upper case only; Lower
 	//				  case if needed is spelled. e.g. L, ell
@@ -67,6 +71,10 @@ private:
 	float Mu[57][2];			// Unenhanced Spectral Amplitudes
 	int vee[57][2];				// V/UV decisions
 	float suv[160];				// Unvoiced samples
+	float uws[211];				// Windowed noise of the unvoiced samples
+	float Uwi[256];				// DFT of the unvoiced samples
+	float Uwq[256];
+	bool dft_bin[256];			// DFT bins of the unvoiced bands
 	float sv[160];				// Voiced samples
 	float log2Mu[58][2];
 	float Olduw[256];
@@ -97,7 +105,12 @@ private:
 	void enhance_spectral_amplitudes(float&);
 	void ifft(float i[], float q[], float[]);
 	uint16_t rearrange(uint32_t u0, uint32_t u1, uint32_t u2, uint32_t u3, uint32_t u4, uint32_t u5, uint32_t u6, uint32_t u7);
+	void synthesize();
 	void synth_unvoiced();
+	void unvoiced_noise();
+	void unvoiced_dft();
+	static void unvoiced_dft(software_imbe_decoder *decoders[], int count);
+	void unvoiced_shape();
 	void synth_voiced();
 	void unpack(uint8_t *buf, uint32_t& u0, uint32_t& u1, uint32_t& u2, uint32_t& u3, uint32_t& u4, uint32_t& u5, uint32_t& u6, uint32_t& u7, uint32_t& E0, uint32_t& ET);
 	int repeat_last();
@@ -118,12 +118,8 @@ vocoder_impl::general_work_decode (int noutput_items,
 
   consume_each (ninput_items[0]);
 
-  uint16_t *out = reinterpret_cast<uint16_t*>(output_items[0]);
-  const int n = std::min(static_cast<int>(output_queue_decode.size()), noutput_items);
-  if(0 < n) {
-     copy(output_queue_decode.begin(), output_queue_decode.begin() + n, out);
-     output_queue_decode.erase(output_queue_decode.begin(), output_queue_decode.begin() + n);
-  }
+  int16_t *out = reinterpret_cast<int16_t*>(output_items[0]);
+  const int n = output_queue_decode.read(out, noutput_items);
   // Tell runtime system how many output items we produced.
   return n;
 }
@@ -0,0 +1,124 @@
+//
+// Shared worker threads for the IMBE synthesis
+//
+// This file is part of OP25
+//
+// OP25 is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// OP25 is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OP25; see the file COPYING. If not, write to the Free
+// Software Foundation, Inc., 51 Franklin Street, Boston, MA
+// 02110-1301, USA.
+
+#include "vocoder_service.h"
+#include "software_imbe_decoder.h"
+
+std::mutex vocoder_service::d_mutex;
+std::condition_variable vocoder_service::d_queue_cv;
+std::deque<vocoder_service::job *> vocoder_service::d_queue;
+std::vector<std::thread> vocoder_service::d_workers;
+bool vocoder_service::d_running = false;
+bool vocoder_service::d_stopping = false;
+
+void
+vocoder_service::start(int threads)
+{
+	std::lock_guard<std::mutex> lock(d_mutex);
+	if (d_running || (threads < 1))
+		return;
+	d_stopping = false;
+	for (int i = 0; i < threads; i++)
+		d_workers.push_back(std::thread(worker_thread));
+	d_running = true;
+}
+
+void
+vocoder_service::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		if (!d_running)
+			return;
+		d_stopping = true;
+	}
+	d_queue_cv.notify_all();
+	for (size_t i = 0; i < d_workers.size(); i++)
+		d_workers[i].join();
+	d_workers.clear();
+
+	std::lock_guard<std::mutex> lock(d_mutex);
+	d_running = false;
+}
+
+bool
+vocoder_service::synthesize(software_imbe_decoder *decoder)
+{
+	std::unique_lock<std::mutex> lock(d_mutex);
+	if (!d_running || d_stopping)
+		return false;
+
+	// the job lives on this stack until a worker has marked it done
+	job j;
+	j.decoder = decoder;
+	j.done = false;
+	d_queue.push_back(&j);
+	d_queue_cv.notify_one();
+	j.done_cv.wait(lock, [&j] { return j.done; });
+	return true;
+}
+
+void
+vocoder_service::worker_thread()
+{
+	job *jobs[VOCODER_LANES];
+
+	for (;;) {
+		int count = 0;
+		{
+			std::unique_lock<std::mutex> lock(d_mutex);
+			d_queue_cv.wait(lock, [] { return d_stopping || !d_queue.empty(); });
+			if (d_queue.empty())
+				return;
+			while (!d_queue.empty() && (count < VOCODER_LANES)) {
+				jobs[count++] = d_queue.front();
+				d_queue.pop_front();
+			}
+		}
+
+		run_batch(jobs, count);
+
+		// notified under the lock, a job is gone as soon as its decoder sees done
+		std::lock_guard<std::mutex> lock(d_mutex);
+		for (int i = 0; i < count; i++) {
+			jobs[i]->done = true;
+			jobs[i]->done_cv.notify_one();
+		}
+	}
+}
+
+void
+vocoder_service::run_batch(job *jobs[], int count)
+{
+	software_imbe_decoder *decoders[VOCODER_LANES];
+
+	for (int i = 0; i < count; i++) {
+		decoders[i] = jobs[i]->decoder;
+		decoders[i]->unvoiced_noise();
+	}
+	if (count == 1)
+		decoders[0]->unvoiced_dft();
+	else
+		software_imbe_decoder::unvoiced_dft(decoders, count);
+	for (int i = 0; i < count; i++) {
+		decoders[i]->unvoiced_shape();
+		decoders[i]->synth_voiced();
+	}
+}
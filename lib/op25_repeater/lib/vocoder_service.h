@@ -0,0 +1,69 @@
+//
+// Shared worker threads for the IMBE synthesis
+//
+// This file is part of OP25
+//
+// OP25 is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// OP25 is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OP25; see the file COPYING. If not, write to the Free
+// Software Foundation, Inc., 51 Franklin Street, Boston, MA
+// 02110-1301, USA.
+
+#ifndef INCLUDED_VOCODER_SERVICE_H
+#define INCLUDED_VOCODER_SERVICE_H
+
+#include <op25_repeater/api.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class software_imbe_decoder;
+
+/*
+ * Synthesizes the voice frames of every software_imbe_decoder on a few
+ * shared threads. A worker takes up to VOCODER_LANES frames that are
+ * waiting, from any calls, and computes the unvoiced DFT of all of them
+ * together. Each decoder's state is only touched by one frame at a time,
+ * and the decoder waits for its frame, so the audio still comes out of
+ * decode_tap() and decode_fullrate() in order with the rest of the stream.
+ * When the service is not running the decoders synthesize inline.
+ */
+class OP25_REPEATER_API vocoder_service {
+public:
+	static void start(int threads);
+	// Lets the workers finish the frames already waiting
+	static void stop();
+	// false when the service is not running and the caller has to synthesize
+	static bool synthesize(software_imbe_decoder *decoder);
+
+private:
+	struct job {
+		software_imbe_decoder *decoder;
+		bool done;
+		std::condition_variable done_cv;
+	};
+
+	static void worker_thread();
+	static void run_batch(job *jobs[], int count);
+
+	static std::mutex d_mutex;
+	static std::condition_variable d_queue_cv;
+	static std::deque<job *> d_queue;
+	static std::vector<std::thread> d_workers;
+	static bool d_running;
+	static bool d_stopping;
+};
+
+#endif /* INCLUDED_VOCODER_SERVICE_H */
@@ -114,7 +114,7 @@ public:
     return res;
   }
 
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     CURL *curl;
     CURLMcode res;
     CURLM *multi_handle;
@@ -316,7 +316,7 @@ public:
     }
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     return upload(call_info);
   }
 
@@ -374,7 +374,7 @@ public:
    int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) { return 0; }
    int audio_stream(Recorder *recorder, float *samples, int sampleCount) { return 0; }
    int call_start(Call *call) { return 0; }
-   int calls_active(std::vector<Call *> calls) { return 0; }
+   int calls_active(const std::vector<Call *> &calls) { return 0; }
    int setup_recorder(Recorder *recorder) { return 0; }
    int setup_system(System *system) { return 0; }
    int setup_systems(std::vector<System *> systems) { return 0; }
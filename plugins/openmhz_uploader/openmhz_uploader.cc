@@ -39,7 +39,7 @@ public:
     ((std::string *)userp)->append((char *)contents, size * nmemb);
     return size * nmemb;
   }
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
 
     std::string api_key = get_api_key(call_info.short_name);
     if (api_key.size() == 0) {
@@ -288,7 +288,7 @@ public:
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     return upload(call_info);
   }
 
@@ -339,7 +339,7 @@ public:
    int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) { return 0; }
    int audio_stream(Recorder *recorder, float *samples, int sampleCount) { return 0; }
    int call_start(Call *call) { return 0; }
-   int calls_active(std::vector<Call *> calls) { return 0; }
+   int calls_active(const std::vector<Call *> &calls) { return 0; }
    int setup_recorder(Recorder *recorder) { return 0; }
    int setup_system(System *system) { return 0; }
    int setup_systems(std::vector<System *> systems) { return 0; }
@@ -43,7 +43,7 @@ public:
     return size * nmemb;
   }
 
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     std::string api_key;
     uint32_t system_id;
     std::string talkgroup_group = call_info.talkgroup_group;
@@ -369,7 +369,7 @@ public:
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     return upload(call_info);
   }
 
@@ -431,7 +431,7 @@ public:
    int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) { return 0; }
    int audio_stream(Recorder *recorder, float *samples, int sampleCount) { return 0; }
    int call_start(Call *call) { return 0; }
-   int calls_active(std::vector<Call *> calls) { return 0; }
+   int calls_active(const std::vector<Call *> &calls) { return 0; }
    int setup_recorder(Recorder *recorder) { return 0; }
    int setup_system(System *system) { return 0; }
    int setup_systems(std::vector<System *> systems) { return 0; }
@@ -3,14 +3,22 @@
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
 #include <boost/foreach.hpp>
 #include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 using namespace boost::asio;
 
 typedef struct plugin_t plugin_t;
 typedef struct stream_t stream_t;
-std::vector<stream_t> streams;
-io_service my_tcp_io_service;
-long max_tcp_index = 0;
+std::vector<stream_t *> streams;
+
+// Streams are looked up by (System shortName, TGID). A shortName of "" or
+// a TGID of 0 in the config acts as a wildcard and is stored under that key.
+typedef std::pair<std::string, unsigned long> stream_key_t;
+std::map<stream_key_t, std::vector<stream_t *>> stream_map;
 
 
 struct plugin_t {
@@ -19,7 +27,6 @@ struct plugin_t {
 
 struct stream_t {
   unsigned long TGID;
-  long tcp_index;
   std::string address;
   std::string short_name;
   long port;
@@ -27,6 +34,20 @@ struct stream_t {
   ip::tcp::socket *tcp_socket;
   bool sendTGID = false;
   bool tcp = false;
+
+  // Packets waiting for the I/O thread. The slots keep their buffers, so
+  // streaming doesn't allocate once it is running, and when the ring is
+  // full the oldest packet is dropped rather than holding up a recorder.
+  std::mutex queue_mutex;
+  std::vector<std::vector<char>> ring;
+  size_t ring_head = 0;
+  size_t ring_count = 0;
+  std::vector<char> in_flight;
+  bool sending = false;
+
+  unsigned long long bytes_sent = 0;
+  unsigned long long packets_dropped = 0;
+  size_t max_depth = 0;
 };
 
 class Simple_Stream : public Plugin_Api {
@@ -34,89 +55,185 @@ class Simple_Stream : public Plugin_Api {
   io_service my_io_service;
   ip::udp::endpoint remote_endpoint;
   ip::udp::socket my_socket{my_io_service};
+  std::unique_ptr<io_service::work> io_work;
+  std::thread io_thread;
+  deadline_timer stats_timer{my_io_service};
+  size_t max_queued_packets = 64;
+  bool stopping = false;
+
   public:
-  
+
   Simple_Stream(){
-      
+
   }
 
  int parse_config(json config_data) {
+    int queue_limit = config_data.value("maxQueuedPackets", 64);
+    max_queued_packets = std::max(queue_limit, 1);
+    BOOST_LOG_TRIVIAL(info) << "simplestreamer will queue up to " << max_queued_packets << " packets per stream";
+
     for (json element : config_data["streams"]) {
-      stream_t stream;
-      stream.TGID = element["TGID"];
-      stream.address = element["address"];
-      stream.port = element["port"];
-      stream.remote_endpoint = ip::udp::endpoint(ip::address::from_string(stream.address), stream.port);
-      stream.sendTGID = element.value("sendTGID",false);
-      stream.tcp = element.value("useTCP",false);
-      stream.short_name = element.value("shortName", "");
-      BOOST_LOG_TRIVIAL(info) << "simplestreamer will stream audio from TGID " <<stream.TGID << " on System " <<stream.short_name << " to " << stream.address <<" on port " << stream.port << " tcp is "<<stream.tcp;
+      stream_t *stream = new stream_t();
+      stream->TGID = element["TGID"];
+      stream->address = element["address"];
+      stream->port = element["port"];
+      stream->remote_endpoint = ip::udp::endpoint(ip::address::from_string(stream->address), stream->port);
+      stream->sendTGID = element.value("sendTGID",false);
+      stream->tcp = element.value("useTCP",false);
+      stream->short_name = element.value("shortName", "");
+      stream->ring.resize(max_queued_packets);
+      BOOST_LOG_TRIVIAL(info) << "simplestreamer will stream audio from TGID " <<stream->TGID << " on System " <<stream->short_name << " to " << stream->address <<" on port " << stream->port << " tcp is "<<stream->tcp;
       streams.push_back(stream);
+      stream_map[stream_key_t(stream->short_name, stream->TGID)].push_back(stream);
     }
     return 0;
   }
-  
+
+  // Called on the recorder's thread, so it only copies the audio into the
+  // stream's ring and leaves the sending to the I/O thread.
+  void queue_packet(stream_t *stream, unsigned long TGID, int16_t *samples, int sampleCount) {
+    std::lock_guard<std::mutex> lock(stream->queue_mutex);
+    size_t ring_size = stream->ring.size();
+
+    if (stream->ring_count == ring_size) {
+      stream->ring_head = (stream->ring_head + 1) % ring_size;
+      stream->ring_count--;
+      stream->packets_dropped++;
+    }
+
+    std::vector<char> &packet = stream->ring[(stream->ring_head + stream->ring_count) % ring_size];
+    stream->ring_count++;
+    stream->max_depth = std::max(stream->max_depth, stream->ring_count);
+
+    packet.clear();
+    if (stream->sendTGID == true) {
+      //prepend 4 byte long tgid to the audio data
+      uint32_t tgid = TGID;
+      packet.insert(packet.end(), (char *)&tgid, (char *)&tgid + 4);
+    }
+    packet.insert(packet.end(), (char *)samples, (char *)samples + sampleCount * 2);
+
+    if (!stream->sending) {
+      stream->sending = true;
+      my_io_service.post(boost::bind(&Simple_Stream::send_next, this, stream));
+    }
+  }
+
+  // Runs on the I/O thread. Each stream has at most one send outstanding;
+  // its completion handler picks up the next queued packet.
+  void send_next(stream_t *stream) {
+    {
+      std::lock_guard<std::mutex> lock(stream->queue_mutex);
+      if ((stream->ring_count == 0) || stopping) {
+        stream->sending = false;
+        return;
+      }
+      stream->in_flight.swap(stream->ring[stream->ring_head]);
+      stream->ring_head = (stream->ring_head + 1) % stream->ring.size();
+      stream->ring_count--;
+    }
+
+    if (stream->tcp == true) {
+      async_write(*stream->tcp_socket, buffer(stream->in_flight), boost::bind(&Simple_Stream::packet_sent, this, stream, placeholders::error, placeholders::bytes_transferred));
+    } else {
+      my_socket.async_send_to(buffer(stream->in_flight), stream->remote_endpoint, boost::bind(&Simple_Stream::packet_sent, this, stream, placeholders::error, placeholders::bytes_transferred));
+    }
+  }
+
+  void packet_sent(stream_t *stream, const boost::system::error_code &ec, size_t bytes_transferred) {
+    if (ec) {
+      if (ec != error::operation_aborted) {
+        BOOST_LOG_TRIVIAL(debug) << "simplestreamer send to " << stream->address << ":" << stream->port << " failed: " << ec.message();
+      }
+    } else {
+      std::lock_guard<std::mutex> lock(stream->queue_mutex);
+      stream->bytes_sent += bytes_transferred;
+    }
+    send_next(stream);
+  }
+
+  void log_stats() {
+    BOOST_FOREACH (auto stream, streams) {
+      std::lock_guard<std::mutex> lock(stream->queue_mutex);
+      BOOST_LOG_TRIVIAL(info) << "simplestreamer " << stream->address << ":" << stream->port << " TGID " << stream->TGID << " - Sent: " << stream->bytes_sent << " bytes Dropped: " << stream->packets_dropped << " packets Queued: " << stream->ring_count << " Max Queued: " << stream->max_depth;
+    }
+  }
+
+  void schedule_stats() {
+    stats_timer.expires_from_now(boost::posix_time::seconds(300));
+    stats_timer.async_wait([this](const boost::system::error_code &ec) {
+      if (!ec) {
+        log_stats();
+        schedule_stats();
+      }
+    });
+  }
+
   int audio_stream(Call *call, Recorder *recorder, int16_t *samples, int sampleCount){
     int recorder_id = recorder->get_num();
-    boost::system::error_code error;
-    BOOST_FOREACH (auto& stream, streams){
-      if (0==stream.short_name.compare(call->get_system()->get_short_name()) || (0==stream.short_name.compare(""))){ //Check if shortName matches or is not specified
-        std::vector<unsigned long> patched_talkgroups = call->get_system()->get_talkgroup_patch(call->get_talkgroup());
-        if (patched_talkgroups.size() == 0){
-          patched_talkgroups.push_back(call->get_talkgroup());
+    std::string short_name = call->get_system()->get_short_name();
+    std::vector<unsigned long> patched_talkgroups = call->get_system()->get_talkgroup_patch(call->get_talkgroup());
+    if (patched_talkgroups.size() == 0){
+      patched_talkgroups.push_back(call->get_talkgroup());
+    }
+    BOOST_FOREACH (auto& TGID, patched_talkgroups){
+      //setting TGID to 0 in the config file will stream everything, and leaving out shortName matches every System
+      const stream_key_t keys[4] = {stream_key_t(short_name, TGID), stream_key_t(short_name, 0), stream_key_t("", TGID), stream_key_t("", 0)};
+      for (int i = 0; i < 4; i++) {
+        if ((i & 2) && short_name.empty()) {
+          break;
+        }
+        if ((i & 1) && (TGID == 0)) {
+          continue;
         }
-        BOOST_FOREACH (auto& TGID, patched_talkgroups){
-          if ((TGID==stream.TGID || stream.TGID==0)){  //setting TGID to 0 in the config file will stream everything
-            BOOST_LOG_TRIVIAL(debug) << "got " <<sampleCount <<" samples - " <<sampleCount*2<<" bytes from recorder "<<recorder_id<<" for TGID "<<TGID;
-            if (stream.sendTGID==true){
-              //prepend 4 byte long tgid to the audio data
-              boost::array<mutable_buffer, 2> buf1 = {
-                buffer(&TGID,4),
-                buffer(samples, sampleCount*2)
-              };
-              if(stream.tcp==true){
-                stream.tcp_socket->send(buf1);
-              }
-              else{
-                my_socket.send_to(buf1, stream.remote_endpoint, 0, error);
-              }
-            }
-            else{
-              //just send the audio data
-              if(stream.tcp == true){
-                stream.tcp_socket->send(buffer(samples, sampleCount*2));
-              }
-              else{
-                my_socket.send_to(buffer(samples, sampleCount*2), stream.remote_endpoint, 0, error);
-              }
-            }
-          }
+        std::map<stream_key_t, std::vector<stream_t *>>::iterator it = stream_map.find(keys[i]);
+        if (it == stream_map.end()) {
+          continue;
+        }
+        BOOST_FOREACH (auto stream, it->second) {
+          BOOST_LOG_TRIVIAL(trace) << "got " <<sampleCount <<" samples - " <<sampleCount*2<<" bytes from recorder "<<recorder_id<<" for TGID "<<TGID;
+          queue_packet(stream, TGID, samples, sampleCount);
         }
       }
     }
     return 0;
   }
-  
+
   int start(){
-    BOOST_FOREACH (auto& stream, streams){
-      if (stream.tcp == true){
-        ip::tcp::socket *my_tcp_socket = new ip::tcp::socket{my_tcp_io_service};
-        stream.tcp_socket = my_tcp_socket;
-        stream.tcp_socket->connect(ip::tcp::endpoint( boost::asio::ip::address::from_string(stream.address), stream.port ));
+    BOOST_FOREACH (auto stream, streams){
+      if (stream->tcp == true){
+        ip::tcp::socket *my_tcp_socket = new ip::tcp::socket{my_io_service};
+        stream->tcp_socket = my_tcp_socket;
+        stream->tcp_socket->connect(ip::tcp::endpoint( boost::asio::ip::address::from_string(stream->address), stream->port ));
       }
     }
     my_socket.open(ip::udp::v4());
+
+    io_work.reset(new io_service::work(my_io_service));
+    schedule_stats();
+    io_thread = std::thread([this]() { my_io_service.run(); });
     return 0;
   }
-  
+
   int stop(){
-    BOOST_FOREACH (auto& stream, streams){
-      if (stream.tcp == true){
-        stream.tcp_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both);
-        stream.tcp_socket->close();
+    // Sockets may only be touched from the I/O thread once it is running.
+    my_io_service.post([this]() {
+      stopping = true;
+      stats_timer.cancel();
+      BOOST_FOREACH (auto stream, streams){
+        if (stream->tcp == true){
+          boost::system::error_code ignored;
+          stream->tcp_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+          stream->tcp_socket->close();
+        }
       }
+      my_socket.close();
+    });
+    io_work.reset();
+    if (io_thread.joinable()) {
+      io_thread.join();
     }
-    my_socket.close();
+    log_stats();
     return 0;
   }
 
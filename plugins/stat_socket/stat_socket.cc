@@ -1,3 +1,4 @@
+#include <atomic>
 #include <time.h>
 #include <vector>
 #include <websocketpp/client.hpp>
@@ -37,6 +38,11 @@ class Stat_Socket : public Plugin_Api {
   bool m_open;
   bool m_done;
   bool m_config_sent;
+  // set by on_open() on the websocket thread, taken by calls_changed() on the main thread
+  std::atomic<bool> m_snapshot_pending;
+  time_t m_next_snapshot;
+  uint64_t m_calls_version;
+  int snapshot_interval;
   std::vector<Source *> sources;
   std::vector<System *> systems;
   std::vector<Call *> calls;
@@ -63,7 +69,7 @@ public:
     return send_object(nodes, "rates", "rates");
   }
 
-  Stat_Socket() : m_open(false), m_done(false), m_config_sent(false) {
+  Stat_Socket() : m_open(false), m_done(false), m_config_sent(false), m_snapshot_pending(false), m_next_snapshot(0), m_calls_version(0), snapshot_interval(60) {
     // set up access channels to only log interesting things
     m_client.clear_access_channels(websocketpp::log::alevel::all);
     m_client.set_access_channels(websocketpp::log::alevel::connect);
@@ -218,16 +224,59 @@ public:
 
   }
 
-  int calls_active(std::vector<Call *> calls) {
+  // The whole table is only sent when the socket connects and then every
+  // snapshot_interval seconds. In between, only the changes are sent and the
+  // server applies them to the last snapshot in version order.
+  int calls_changed(const std::vector<Call_Change> &changes, const std::vector<Call *> &calls) {
+    if (!changes.empty()) {
+      m_calls_version = changes.back().version;
+    }
+    if (m_open == false)
+      return 0;
+
+    time_t now = time(NULL);
+    bool snapshot_pending = m_snapshot_pending.exchange(false);
+    if (snapshot_pending || ((snapshot_interval > 0) && (now >= m_next_snapshot))) {
+      m_next_snapshot = now + snapshot_interval;
+      return send_calls_active(calls);
+    }
+
+    if (changes.empty())
+      return 0;
+
+    json changes_node = json::array();
+    for (std::vector<Call_Change>::const_iterator it = changes.begin(); it != changes.end(); ++it) {
+      json change_node;
+      change_node["version"] = it->version;
+      change_node["callNum"] = it->call_num;
+      switch (it->type) {
+      case CALL_ADDED:
+        change_node["change"] = "added";
+        change_node["call"] = it->call->get_stats_json();
+        break;
+      case CALL_UPDATED:
+        change_node["change"] = "updated";
+        change_node["call"] = it->call->get_stats_json();
+        break;
+      case CALL_REMOVED:
+        change_node["change"] = "removed";
+        change_node["id"] = std::to_string(it->sys_num) + "_" + std::to_string(it->talkgroup) + "_" + std::to_string(it->start_time);
+        break;
+      }
+      changes_node.push_back(change_node);
+    }
+
+    return send_json(changes_node, "changes", "calls_changed");
+  }
+
+  // calls_active is written the way it always has been, every value as a string
+  int send_calls_active(const std::vector<Call *> &calls) {
     if (m_open == false)
       return 0;
     boost::property_tree::ptree node;
 
-    for (std::vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
-      Call *call = *it;
-      //if (call->get_state() == RECORDING) {
-        node.push_back(std::make_pair("", call->get_stats()));
-      //}
+    for (std::vector<Call *>::const_iterator it = calls.begin(); it != calls.end(); it++) {
+      node.push_back(std::make_pair("", (*it)->get_stats()));
     }
 
     return send_object(node, "calls", "calls_active");
@@ -255,7 +304,7 @@ public:
 
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     if (m_open == false)
       return 0;
     return 0;
@@ -269,6 +318,22 @@ public:
     return send_object(recorder->get_stats(), "recorder", "recorder");
   }
 
+  // The calls_changed message is written with nlohmann, so unlike send_object()
+  // numbers and booleans keep their JSON types.
+  int send_json(json data, std::string name, std::string type) {
+    if (m_open == false)
+      return 0;
+    json root;
+
+    root[name] = data;
+    root["type"] = type;
+    root["version"] = m_calls_version;
+    root["instanceId"] = this->config->instance_id;
+    root["instanceKey"] = this->config->instance_key;
+
+    return send_stat(root.dump());
+  }
+
   int send_object(boost::property_tree::ptree data, std::string name, std::string type) {
     if (m_open == false)
       return 0;
@@ -354,6 +419,7 @@ public:
       // de scope the lock before calling the callback
       scoped_lock guard(m_lock);
       m_open = true;
+      m_snapshot_pending = true;
       retry_attempt = 0;
     }
     send_config(this->sources, this->systems);
@@ -508,7 +574,13 @@ public:
         );
     }
 
- int parse_config(json config_data ){ return 0; }
+ int parse_config(json config_data) {
+    snapshot_interval = config_data.value("statusSnapshotInterval", 60);
+    if (config_data.value("statusServer", "") != "") {
+      BOOST_LOG_TRIVIAL(info) << "Status Server will get all active calls every " << snapshot_interval << " seconds";
+    }
+    return 0;
+  }
    int stop() { return 0; }
    int setup_sources(std::vector<Source *> sources) { return 0; }
 
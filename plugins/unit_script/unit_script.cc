@@ -2,56 +2,302 @@
 #include "../../trunk-recorder/systems/system.h"
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
 #include <boost/foreach.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
 
+// A long running copy of a unit script. Events are written to its stdin one
+// per line, with the same fields that are passed as arguments in the default
+// mode. The queue is filled by the control channel thread and drained by a
+// thread of its own, so a slow script never holds up trunking.
+//
+// At shutdown the queue is drained for at most UNIT_SCRIPT_DRAIN_SECONDS. The
+// script then gets its stdin closed, and UNIT_SCRIPT_EXIT_GRACE_MS to exit
+// before it is sent SIGTERM and then SIGKILL.
+static const int UNIT_SCRIPT_DRAIN_SECONDS = 5;
+static const int UNIT_SCRIPT_EXIT_GRACE_MS = 2000;
+
+struct Unit_Script_Worker {
+  std::string script;
+  size_t max_queued;
+  pid_t pid = -1;
+  int fd = -1;
+
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  // An event that repeats the one at the back of the queue is not queued a
+  // second time. Anything further back is left alone, so the script still
+  // sees on/off/on in that order.
+  std::deque<std::string> queue;
+  bool stopping = false;
+  std::chrono::steady_clock::time_point stop_deadline;
+  std::thread thread;
+
+  unsigned long long sent = 0;
+  unsigned long long dropped = 0;
+  unsigned long long coalesced = 0;
+  unsigned long long restarts = 0;
+  time_t last_drop_warning = 0;
+};
 
 struct Unit_Script_System_Script {
   std::string script;
   std::string short_name;
+  Unit_Script_Worker *worker;
 };
 
 class Unit_Script : public Plugin_Api {
-    std::vector<Unit_Script_System_Script> system_scripts;
-std::map<long, long> unit_affiliations;
+  std::vector<Unit_Script_System_Script> system_scripts;
+  std::unordered_map<std::string, Unit_Script_System_Script *> system_script_index;
+  std::vector<Unit_Script_Worker *> workers;
+  std::map<long, long> unit_affiliations;
+
 public:
-  std::string get_system_script(std::string short_name) {
-    for (std::vector<Unit_Script_System_Script>::iterator it = system_scripts.begin(); it != system_scripts.end(); ++it) {
-      Unit_Script_System_Script system_script = *it;
-      if (system_script.short_name == short_name){
-        return system_script.script;
+  Unit_Script_System_Script *get_system_script(std::string short_name) {
+    std::unordered_map<std::string, Unit_Script_System_Script *>::iterator it = system_script_index.find(short_name);
+    if (it == system_script_index.end()) {
+      return NULL;
+    }
+    return it->second;
+  }
+
+  std::string get_patch_string(System *sys, long talkgroup_num) {
+    std::vector<unsigned long> talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
+    std::string patch_string;
+    bool first = true;
+    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
+      if (!first) { patch_string += ","; }
+      first = false;
+      patch_string += std::to_string(TGID);
+    }
+    return patch_string;
+  }
+
+  // args is everything after the script name: shortName radioID action ...
+  void run_script(Unit_Script_System_Script *system_script, std::string args) {
+    if (system_script->worker) {
+      queue_event(system_script->worker, args);
+      return;
+    }
+    char shell_command[200];
+    snprintf(shell_command, 200, "%s %s &", system_script->script.c_str(), args.c_str());
+    int rc __attribute__((unused)) =  system(shell_command);
+  }
+
+  void queue_event(Unit_Script_Worker *worker, std::string event) {
+    std::lock_guard<std::mutex> lock(worker->queue_mutex);
+
+    if (!worker->queue.empty() && (worker->queue.back() == event)) {
+      worker->coalesced++;
+      return;
+    }
+
+    if (worker->queue.size() >= worker->max_queued) {
+      worker->queue.pop_front();
+      worker->dropped++;
+
+      time_t now = time(NULL);
+      if (now - worker->last_drop_warning >= 60) {
+        worker->last_drop_warning = now;
+        BOOST_LOG_TRIVIAL(error) << "unit_script: " << worker->script << " is falling behind, dropped " << worker->dropped << " events so far";
+      }
+    }
+
+    worker->queue.push_back(event);
+    worker->queue_cv.notify_one();
+  }
+
+  bool start_worker_process(Unit_Script_Worker *worker) {
+    int fds[2];
+    // close-on-exec keeps the other scripts from holding this pipe open
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+      BOOST_LOG_TRIVIAL(error) << "unit_script: unable to create a pipe for " << worker->script << ": " << strerror(errno);
+      return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+      BOOST_LOG_TRIVIAL(error) << "unit_script: unable to start " << worker->script << ": " << strerror(errno);
+      close(fds[0]);
+      close(fds[1]);
+      return false;
+    }
+
+    if (pid == 0) {
+      // its own process group, so a kill reaches anything the shell started
+      setpgid(0, 0);
+      dup2(fds[0], STDIN_FILENO);
+      close(fds[0]);
+      close(fds[1]);
+      // the worker thread blocks SIGPIPE, and the child inherits its mask
+      sigset_t set;
+      sigemptyset(&set);
+      pthread_sigmask(SIG_SETMASK, &set, NULL);
+      execl("/bin/sh", "sh", "-c", worker->script.c_str(), (char *)NULL);
+      _exit(127);
+    }
+
+    close(fds[0]);
+    setpgid(pid, pid);
+    // writes wait in poll() instead, so a full pipe can't hold up a shutdown
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    worker->pid = pid;
+    worker->fd = fds[1];
+    return true;
+  }
+
+  bool wait_for_exit(pid_t pid, int timeout_ms) {
+    for (int waited = 0;; waited += 50) {
+      pid_t rc = waitpid(pid, NULL, WNOHANG);
+      if ((rc == pid) || ((rc < 0) && (errno != EINTR))) {
+        return true;
+      }
+      if (waited >= timeout_ms) {
+        return false;
+      }
+      usleep(50000);
+    }
+  }
+
+  void stop_worker_process(Unit_Script_Worker *worker) {
+    if (worker->fd >= 0) {
+      close(worker->fd);
+      worker->fd = -1;
+    }
+    if (worker->pid > 0) {
+      // the end of its input is the script's cue to exit
+      if (!wait_for_exit(worker->pid, UNIT_SCRIPT_EXIT_GRACE_MS)) {
+        BOOST_LOG_TRIVIAL(error) << "unit_script: " << worker->script << " did not exit when its input was closed, terminating it";
+        kill(-worker->pid, SIGTERM);
+        if (!wait_for_exit(worker->pid, UNIT_SCRIPT_EXIT_GRACE_MS)) {
+          kill(-worker->pid, SIGKILL);
+          waitpid(worker->pid, NULL, 0);
+        }
+      }
+      worker->pid = -1;
+    }
+  }
+
+  bool drain_time_is_up(Unit_Script_Worker *worker) {
+    std::lock_guard<std::mutex> lock(worker->queue_mutex);
+    return worker->stopping && (std::chrono::steady_clock::now() >= worker->stop_deadline);
+  }
+
+  // Fails with ETIMEDOUT if the script is still not reading when the drain time is up
+  bool write_event(Unit_Script_Worker *worker, const std::string &line) {
+    size_t written = 0;
+    while (written < line.size()) {
+      ssize_t rc = write(worker->fd, line.data() + written, line.size() - written);
+      if (rc < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+          if (drain_time_is_up(worker)) {
+            errno = ETIMEDOUT;
+            return false;
+          }
+          struct pollfd pfd = {worker->fd, POLLOUT, 0};
+          poll(&pfd, 1, 100);
+          continue;
+        }
+        return false;
+      }
+      written += rc;
+    }
+    return true;
+  }
+
+  void worker_loop(Unit_Script_Worker *worker) {
+    // A script that exits makes write() fail with EPIPE; the signal that
+    // goes with it is blocked here and cleared below.
+    sigset_t sigpipe_set;
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, NULL);
+
+    while (true) {
+      std::string event;
+      {
+        std::unique_lock<std::mutex> lock(worker->queue_mutex);
+        worker->queue_cv.wait(lock, [worker] { return worker->stopping || !worker->queue.empty(); });
+        if (worker->queue.empty()) {
+          break;
+        }
+        if (worker->stopping && (std::chrono::steady_clock::now() >= worker->stop_deadline)) {
+          worker->dropped += worker->queue.size();
+          worker->queue.clear();
+          break;
+        }
+        event = worker->queue.front();
+        worker->queue.pop_front();
+      }
+
+      if ((worker->fd < 0) && !start_worker_process(worker)) {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->dropped++;
+        continue;
+      }
+
+      if (!write_event(worker, event + "\n")) {
+        if (errno == ETIMEDOUT) {
+          std::lock_guard<std::mutex> lock(worker->queue_mutex);
+          worker->dropped += 1 + worker->queue.size();
+          worker->queue.clear();
+          break;
+        }
+        if (errno == EPIPE) {
+          struct timespec no_wait = {0, 0};
+          sigtimedwait(&sigpipe_set, NULL, &no_wait);
+        }
+        BOOST_LOG_TRIVIAL(error) << "unit_script: " << worker->script << " stopped reading events, restarting it";
+        stop_worker_process(worker);
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->dropped++;
+        worker->restarts++;
+        continue;
       }
+
+      std::lock_guard<std::mutex> lock(worker->queue_mutex);
+      worker->sent++;
     }
-    return "";
+
+    stop_worker_process(worker);
   }
 
 int unit_registration(System *sys, long source_id) {
     unit_affiliations[source_id] = 0;
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li on &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
+  Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " on");
     return 0;
   }
     return 1;
 }
 
-int unit_deregistration(System *sys, long source_id) { 
+int unit_deregistration(System *sys, long source_id) {
     unit_affiliations[source_id] = -1;
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li off &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
+  Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " off");
     return 0;
   }
     return 1;
-}  
-int unit_acknowledge_response(System *sys, long source_id) { 
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command,200, "%s %s %li ackresp &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
+}
+int unit_acknowledge_response(System *sys, long source_id) {
+  Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " ackresp");
     return 0;
   }
     return 1;
@@ -59,41 +305,28 @@ int unit_acknowledge_response(System *sys, long source_id) {
 
 int unit_group_affiliation(System *sys, long source_id, long talkgroup_num) {
     unit_affiliations[source_id] = talkgroup_num;
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li join %li %s &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
+    Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    std::string patch_string = get_patch_string(sys, talkgroup_num);
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " join " + std::to_string(talkgroup_num) + " " + patch_string);
     return 0;
   }
     return 1;
 }
 
 int unit_data_grant(System *sys, long source_id) {
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li data &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
+    Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " data");
     return 0;
   }
     return 1;
 }
 
 int unit_answer_request(System *sys, long source_id, long talkgroup) {
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li ans_req %li &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup);
-    int rc __attribute__((unused)) =  system(shell_command);
+    Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " ans_req " + std::to_string(talkgroup));
     return 0;
   }
     return 1;
@@ -101,19 +334,10 @@ int unit_answer_request(System *sys, long source_id, long talkgroup) {
 
 int unit_location(System *sys, long source_id, long talkgroup_num) {
     unit_affiliations[source_id] = talkgroup_num;
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li location %li %s &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
+    Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+  if (system_script && (source_id != 0)) {
+    std::string patch_string = get_patch_string(sys, talkgroup_num);
+    run_script(system_script, sys->get_short_name() + " " + std::to_string(source_id) + " location " + std::to_string(talkgroup_num) + " " + patch_string);
     return 0;
   }
     return 1;
@@ -123,19 +347,10 @@ int call_start(Call *call) {
     long talkgroup_num = call->get_talkgroup();
     long source_id = call->get_current_source_id();
     std::string short_name = call->get_short_name();
-    std::string system_script = get_system_script(short_name);
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = call->get_system()->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li call %li %s &", system_script.c_str(), short_name.c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
+    Unit_Script_System_Script *system_script = get_system_script(short_name);
+  if (system_script && (source_id != 0)) {
+    std::string patch_string = get_patch_string(call->get_system(), talkgroup_num);
+    run_script(system_script, short_name + " " + std::to_string(source_id) + " call " + std::to_string(talkgroup_num) + " " + patch_string);
     return 0;
   }
     return 1;
@@ -147,12 +362,61 @@ int call_start(Call *call) {
       Unit_Script_System_Script system_script;
       system_script.script = element.value("unitScript", "");
       system_script.short_name = element.value("shortName", "");
+      system_script.worker = NULL;
       if (system_script.script != "") {
         BOOST_LOG_TRIVIAL(info) << "\t- [" << system_script.short_name << "]: " << system_script.script ;
+
+        if (element.value("unitScriptPersistent", false)) {
+          // Systems that share a script share its worker
+          for (std::vector<Unit_Script_Worker *>::iterator it = workers.begin(); it != workers.end(); ++it) {
+            if ((*it)->script == system_script.script) {
+              system_script.worker = *it;
+            }
+          }
+          if (!system_script.worker) {
+            system_script.worker = new Unit_Script_Worker();
+            system_script.worker->script = system_script.script;
+            system_script.worker->max_queued = std::max(element.value("unitScriptQueueLimit", 1000), 1);
+            workers.push_back(system_script.worker);
+          }
+          BOOST_LOG_TRIVIAL(info) << "\t  Keeping the Unit Script running, up to " << system_script.worker->max_queued << " events can be queued";
+        }
         this->system_scripts.push_back(system_script);
       }
     }
 
+    for (std::vector<Unit_Script_System_Script>::iterator it = system_scripts.begin(); it != system_scripts.end(); ++it) {
+      system_script_index[it->short_name] = &(*it);
+    }
+
+    return 0;
+  }
+
+  int start() {
+    BOOST_FOREACH (auto worker, workers) {
+      worker->thread = std::thread(&Unit_Script::worker_loop, this, worker);
+    }
+    return 0;
+  }
+
+  // Events still queued are handed to the script before its stdin is closed,
+  // for as long as the drain time allows
+  int stop() {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(UNIT_SCRIPT_DRAIN_SECONDS);
+    BOOST_FOREACH (auto worker, workers) {
+      {
+        std::lock_guard<std::mutex> lock(worker->queue_mutex);
+        worker->stopping = true;
+        worker->stop_deadline = deadline;
+      }
+      worker->queue_cv.notify_one();
+    }
+    BOOST_FOREACH (auto worker, workers) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+      BOOST_LOG_TRIVIAL(info) << "unit_script: " << worker->script << " - Sent: " << worker->sent << " Dropped: " << worker->dropped << " Coalesced: " << worker->coalesced << " Restarts: " << worker->restarts;
+    }
     return 0;
   }
 
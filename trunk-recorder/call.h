@@ -6,6 +6,7 @@
 #include <boost/program_options.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <json.hpp>
 #include <string>
 #include <sys/time.h>
 #include <vector>
@@ -19,8 +20,8 @@ class System;
 
 class Call {
 public:
-  // static Call * make(long t, double f, System *s, Config c);
-  static Call *make(TrunkMessage message, System *s, Config c);
+  // static Call * make(long t, double f, System *s, Config_Snapshot c);
+  static Call *make(TrunkMessage message, System *s, Config_Snapshot c);
   virtual ~Call(){};
   virtual long get_call_num() = 0;
   virtual void restart_call() = 0;
@@ -78,6 +79,7 @@ public:
   virtual void set_talkgroup_tag(std::string tag) = 0;
   virtual void clear_transmission_list() = 0;
   virtual boost::property_tree::ptree get_stats() = 0;
+  virtual nlohmann::json get_stats_json() = 0;
 
   virtual std::string get_talkgroup_tag() = 0;
   virtual std::string get_system_type() = 0;
@@ -85,6 +87,8 @@ public:
   virtual long get_current_source_id() = 0;
   virtual bool get_conversation_mode() = 0;
   virtual System *get_system() = 0;
+  virtual Talkgroups_Snapshot get_talkgroups_snapshot() = 0;
+  virtual Unit_Tags_Snapshot get_unit_tags_snapshot() = 0;
   virtual std::vector<Transmission> get_transmissions() = 0;
 };
 
@@ -1,11 +1,28 @@
 #include "call_concluder.h"
+#include "native_audio.h"
 #include "../plugin_manager/plugin_manager.h"
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <filesystem>
 namespace fs = std::filesystem;
 
-std::list<std::future<Call_Data_t>> Call_Concluder::call_data_workers = {};
 std::list<Call_Data_t> Call_Concluder::retry_call_list = {};
+std::vector<std::thread> Call_Concluder::workers = {};
+std::priority_queue<Call_Data_Job, std::vector<Call_Data_Job>, Call_Data_Job_Compare> Call_Concluder::call_data_queue;
+std::deque<Call_Data_Job> Call_Concluder::overflow_calls = {};
+std::deque<Call_Data_t> Call_Concluder::completed_calls = {};
+std::mutex Call_Concluder::queue_mutex;
+std::condition_variable Call_Concluder::queue_cv;
+size_t Call_Concluder::max_queue_size = 0;
+long Call_Concluder::job_sequence = 0;
+bool Call_Concluder::stopping = false;
+int Call_Concluder::busy_workers = 0;
+long Call_Concluder::jobs_completed = 0;
+double Call_Concluder::total_wait_ms = 0;
+double Call_Concluder::max_wait_ms = 0;
+double Call_Concluder::total_work_ms = 0;
+long Call_Concluder::calls_overflowed = 0;
+long Call_Concluder::calls_dropped = 0;
 
 int combine_wav(std::string files, char *target_filename) {
   char shell_command[4000];
@@ -50,7 +67,7 @@ int convert_media(char *filename, char *converted) {
   return nchars;
 }
 
-int create_call_json(Call_Data_t call_info) {
+int create_call_json(const Call_Data_t &call_info) {
   // Create the JSON status file
   std::ofstream json_file(call_info.status_filename);
 
@@ -123,7 +140,7 @@ bool checkIfFile(std::string filePath) {
   return false;
 }
 
-void remove_call_files(Call_Data_t call_info) {
+void remove_call_files(const Call_Data_t &call_info) {
 
   if (!call_info.audio_archive) {
     if (checkIfFile(call_info.filename)) {
@@ -132,8 +149,8 @@ void remove_call_files(Call_Data_t call_info) {
     if (checkIfFile(call_info.converted)) {
       remove(call_info.converted);
     }
-    for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+    for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+      const Transmission &t = *it;
       if (checkIfFile(t.filename)) {
         remove(t.filename);
       }
@@ -141,8 +158,8 @@ void remove_call_files(Call_Data_t call_info) {
   } else {
     if (call_info.transmission_archive) {
       // if the files are being archived, move them to the capture directory
-      for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-        Transmission t = *it;
+      for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+        const Transmission &t = *it;
         boost::filesystem::path target_file = boost::filesystem::path(fs::path(call_info.filename ).replace_filename(fs::path(t.filename).filename()));
         boost::filesystem::path transmission_file = t.filename;
         //boost::filesystem::path target_file = boost::filesystem::path(call_info.filename).replace_filename(transmission_file.filename()); // takes the capture dir from the call file and adds the transmission filename to it
@@ -155,8 +172,8 @@ void remove_call_files(Call_Data_t call_info) {
     } 
 
     // remove the transmission files from the temp directory
-    for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+    for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+      const Transmission &t = *it;
       if (checkIfFile(t.filename)) {
         remove(t.filename);
       }
@@ -181,8 +198,8 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
     struct stat statbuf;
     // loop through the transmission list, pull in things to fill in totals for call_info
     // Using a for loop with iterator
-    for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
-      Transmission t = *it;
+    for (std::vector<Transmission>::const_iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ++it) {
+      const Transmission &t = *it;
 
       if (stat(t.filename, &statbuf) == 0)
       {
@@ -195,7 +212,18 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
       }
     }
 
-    combine_wav(files, call_info.filename);
+    std::vector<int16_t> samples;
+    unsigned int sample_rate = 0;
+    bool native_audio = call_info.native_audio;
+
+    if (native_audio && (native_combine_wav(call_info.transmission_list, call_info.filename, samples, sample_rate) < 0)) {
+      BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m \t Unable to combine the transmissions natively, falling back to sox";
+      native_audio = false;
+    }
+
+    if (!native_audio) {
+      combine_wav(files, call_info.filename);
+    }
 
     result = create_call_json(call_info);
 
@@ -206,7 +234,12 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
 
     if (call_info.compress_wav) {
       // TR records files as .wav files. They need to be compressed before being upload to online services.
-      result = convert_media(call_info.filename, call_info.converted);
+      if (native_audio) {
+        normalize_samples(samples, -0.01);
+        result = native_convert_media(samples, sample_rate, call_info.converted);
+      } else {
+        result = convert_media(call_info.filename, call_info.converted);
+      }
 
       if (result < 0) {
         call_info.status = FAILED;
@@ -241,7 +274,7 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
 
 
 // static int rec_counter=0;
-Call_Data_t Call_Concluder::create_base_filename(Call *call, Call_Data_t call_info) {
+void Call_Concluder::create_base_filename(Call *call, Call_Data_t &call_info) {
   char base_filename[255];
   time_t work_start_time = call->get_start_time();
   std::stringstream base_path_stream;
@@ -265,16 +298,14 @@ Call_Data_t Call_Concluder::create_base_filename(Call *call, Call_Data_t call_in
   snprintf(call_info.filename, 300, "%s-call_%lu.wav", base_filename, call->get_call_num());
   snprintf(call_info.status_filename, 300, "%s-call_%lu.json", base_filename, call->get_call_num());
   snprintf(call_info.converted, 300, "%s-call_%lu.m4a", base_filename, call->get_call_num());
-
-  return call_info;
 }
 
 
-Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config config) {
+Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Config &config) {
   Call_Data_t call_info;
   double total_length = 0;
 
-  call_info = create_base_filename(call, call_info);
+  create_base_filename(call, call_info);
 
   call_info.status = INITIAL;
   call_info.process_call_time = time(0);
@@ -298,12 +329,15 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
   call_info.call_log = sys->get_call_log();
   call_info.call_num = call->get_call_num();
   call_info.compress_wav = sys->get_compress_wav();
+  call_info.native_audio = config.native_audio;
   call_info.talkgroup = call->get_talkgroup();
   call_info.talkgroup_display = call->get_talkgroup_display();
   call_info.patched_talkgroups = sys->get_talkgroup_patch(call_info.talkgroup);
   call_info.min_transmissions_removed = 0;
 
-  Talkgroup *tg = sys->find_talkgroup(call->get_talkgroup());
+  Talkgroups_Snapshot talkgroups = call->get_talkgroups_snapshot();
+  Unit_Tags_Snapshot unit_tags = call->get_unit_tags_snapshot();
+  std::shared_ptr<const Talkgroup> tg = talkgroups->find_talkgroup(sys->get_sys_num(), call->get_talkgroup());
   if (tg != NULL) {
     call_info.talkgroup_tag = tg->tag;
     call_info.talkgroup_alpha_tag = tg->alpha_tag;
@@ -328,7 +362,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
   // loop through the transmission list, pull in things to fill in totals for call_info
   // Using a for loop with iterator
   for (std::vector<Transmission>::iterator it = call_info.transmission_list.begin(); it != call_info.transmission_list.end();) {
-    Transmission t = *it;
+    const Transmission &t = *it;
 
     if (t.length < sys->get_min_tx_duration()) {
       if (!call_info.transmission_archive) {
@@ -345,7 +379,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
       continue;
     }
 
-    std::string tag = sys->find_unit_tag(t.source);
+    std::string tag = unit_tags->find_unit_tag(t.source);
     std::string display_tag = "";
     if (tag != "") {
       display_tag = " (\033[0;34m" + tag + "\033[0m)";
@@ -384,7 +418,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, Config con
   return call_info;
 }
 
-void Call_Concluder::conclude_call(Call *call, System *sys, Config config) {
+void Call_Concluder::conclude_call(Call *call, System *sys, const Config &config) {
   Call_Data_t call_info = create_call_data(call, sys, config);
 
   if(call->get_state() == MONITORING && call->get_monitoring_state() == SUPERSEDED){
@@ -408,40 +442,179 @@ void Call_Concluder::conclude_call(Call *call, System *sys, Config config) {
   }
 
 
-  call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+  enqueue_call_data(std::move(call_info));
+}
+
+void Call_Concluder::start_workers(int num_workers, int queue_size) {
+  if (num_workers < 1) {
+    BOOST_LOG_TRIVIAL(error) << "callConcluderThreads has to be at least 1, using 1 Call Concluder worker";
+    num_workers = 1;
+  }
+  max_queue_size = queue_size;
+  stopping = false;
+
+  BOOST_LOG_TRIVIAL(info) << "Starting " << num_workers << " Call Concluder workers, queue limit: " << max_queue_size;
+  for (int i = 0; i < num_workers; i++) {
+    workers.push_back(std::thread(worker_thread));
+  }
+}
+
+// Lets the workers finish everything that is in the queue, then waits for them to exit
+void Call_Concluder::stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = true;
+    BOOST_LOG_TRIVIAL(info) << "Waiting for the Call Concluder to finish " << call_data_queue.size() + overflow_calls.size() + busy_workers << " calls";
+  }
+  queue_cv.notify_all();
+
+  for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+    if (it->joinable()) {
+      it->join();
+    }
+  }
+  workers.clear();
+}
+
+void Call_Concluder::worker_thread() {
+  while (true) {
+    Call_Data_Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_cv.wait(lock, [] { return stopping || !call_data_queue.empty(); });
+
+      if (call_data_queue.empty()) {
+        return;
+      }
+      // top() is const only so the heap can't be reordered through it, the
+      // job is popped straight after being moved out
+      job = std::move(const_cast<Call_Data_Job &>(call_data_queue.top()));
+      call_data_queue.pop();
+      busy_workers++;
+
+      if (!overflow_calls.empty()) {
+        std::deque<Call_Data_Job>::iterator next = std::max_element(overflow_calls.begin(), overflow_calls.end(), Call_Data_Job_Compare());
+        call_data_queue.push(std::move(*next));
+        overflow_calls.erase(next);
+      }
+
+      double wait_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.queued_time).count();
+      total_wait_ms += wait_ms;
+      if (wait_ms > max_wait_ms) {
+        max_wait_ms = wait_ms;
+      }
+    }
+
+    std::chrono::steady_clock::time_point work_start = std::chrono::steady_clock::now();
+    Call_Data_t call_info = upload_call_worker(std::move(job.call_info));
+    double work_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - work_start).count();
+
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      busy_workers--;
+      jobs_completed++;
+      total_work_ms += work_ms;
+      completed_calls.push_back(std::move(call_info));
+    }
+  }
+}
+
+// This is called by the trunking threads, so it never waits for a worker. When the queue
+// is full the Call goes on the overflow list, and when that is full too, the Call with the
+// lowest priority is dropped.
+void Call_Concluder::enqueue_call_data(Call_Data_t call_info) {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+
+  if (stopping || workers.empty()) {
+    BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m\tCall Concluder is not running, unable to conclude the call, its files are left in place";
+    calls_dropped++;
+    return;
+  }
+
+  Call_Data_Job job = {std::move(call_info), job_sequence++, std::chrono::steady_clock::now()};
+
+  if ((max_queue_size == 0) || (call_data_queue.size() < max_queue_size)) {
+    call_data_queue.push(std::move(job));
+    lock.unlock();
+    queue_cv.notify_one();
+    return;
+  }
+
+  calls_overflowed++;
+  overflow_calls.push_back(std::move(job));
+
+  if (overflow_calls.size() <= max_queue_size) {
+    return;
+  }
+
+  // the dropped call is taken off the list here, its files are removed once the lock is released
+  std::deque<Call_Data_Job>::iterator lowest = std::min_element(overflow_calls.begin(), overflow_calls.end(), Call_Data_Job_Compare());
+  Call_Data_t dropped = std::move(lowest->call_info);
+  size_t behind = call_data_queue.size() + overflow_calls.size();
+  overflow_calls.erase(lowest);
+  calls_dropped++;
+  lock.unlock();
+
+  BOOST_LOG_TRIVIAL(error) << "[" << dropped.short_name << "]\t\033[0;34m" << dropped.call_num << "C\033[0m\tTG: " << dropped.talkgroup_display << "\tCall Concluder is " << behind << " calls behind, dropping this call";
+  remove_call_files(dropped);
+}
+
+void Call_Concluder::print_stats() {
+  std::lock_guard<std::mutex> lock(queue_mutex);
+
+  BOOST_LOG_TRIVIAL(info) << "Call Concluder - Queued: " << call_data_queue.size() << " Overflow: " << overflow_calls.size() << " Busy Workers: " << busy_workers << " / " << workers.size() << " Retry Queue: " << retry_call_list.size() << " Completed: " << jobs_completed;
+  if ((calls_overflowed > 0) || (calls_dropped > 0)) {
+    BOOST_LOG_TRIVIAL(error) << "Call Concluder - Calls sent to the Overflow list: " << calls_overflowed << " Dropped: " << calls_dropped;
+  }
+  if (jobs_completed > 0) {
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder - Avg Wait: " << std::fixed << std::setprecision(0) << total_wait_ms / jobs_completed << " ms Max Wait: " << max_wait_ms << " ms Avg Processing: " << total_work_ms / jobs_completed << " ms";
+  }
+  jobs_completed = 0;
+  total_wait_ms = 0;
+  max_wait_ms = 0;
+  total_work_ms = 0;
+  calls_overflowed = 0;
+  calls_dropped = 0;
 }
 
 void Call_Concluder::manage_call_data_workers() {
-  for (std::list<std::future<Call_Data_t>>::iterator it = call_data_workers.begin(); it != call_data_workers.end();) {
-
-    if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-      Call_Data_t call_info = it->get();
-
-      if (call_info.status == RETRY) {
-        call_info.retry_attempt++;
-        time_t start_time = call_info.start_time;
-
-        if (call_info.retry_attempt > Call_Concluder::MAX_RETRY) {
-          remove_call_files(call_info);
-          BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m Failed to conclude call - TG: " << call_info.talkgroup_display << "\t" << std::put_time(std::localtime(&start_time), "%c %Z");
-        } else {
-          long jitter = rand() % 10;
-          long backoff = (2 ^ call_info.retry_attempt * 60) + jitter;
-          call_info.process_call_time = time(0) + backoff;
-          retry_call_list.push_back(call_info);
-          BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m \tTG: " << call_info.talkgroup_display << "\t" << std::put_time(std::localtime(&start_time), "%c %Z") << " retry attempt " << call_info.retry_attempt << " in " << backoff << "s\t retry queue: " << retry_call_list.size() << " calls";
-        }
+  std::deque<Call_Data_t> completed;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    completed.swap(completed_calls);
+  }
+
+  for (std::deque<Call_Data_t>::iterator it = completed.begin(); it != completed.end(); ++it) {
+    Call_Data_t &call_info = *it;
+
+    if (call_info.status == RETRY) {
+      call_info.retry_attempt++;
+      time_t start_time = call_info.start_time;
+
+      if (call_info.retry_attempt > Call_Concluder::MAX_RETRY) {
+        remove_call_files(call_info);
+        BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m Failed to conclude call - TG: " << call_info.talkgroup_display << "\t" << std::put_time(std::localtime(&start_time), "%c %Z");
+      } else {
+        long jitter = rand() % 10;
+        long backoff = (2 ^ call_info.retry_attempt * 60) + jitter;
+        call_info.process_call_time = time(0) + backoff;
+        BOOST_LOG_TRIVIAL(error) << "[" << call_info.short_name << "]\t\033[0;34m" << call_info.call_num << "C\033[0m \tTG: " << call_info.talkgroup_display << "\t" << std::put_time(std::localtime(&start_time), "%c %Z") << " retry attempt " << call_info.retry_attempt << " in " << backoff << "s\t retry queue: " << retry_call_list.size() + 1 << " calls";
+        retry_call_list.push_back(std::move(call_info));
       }
-      it = call_data_workers.erase(it);
-    } else {
-      it++;
     }
   }
-  for (std::list<Call_Data_t>::iterator it = retry_call_list.begin(); it != retry_call_list.end();) {
-    Call_Data_t call_info = *it;
 
-    if (call_info.process_call_time <= time(0)) {
-      call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+  if (stopping || workers.empty()) {
+    // shutting down, there is nothing left to retry them with
+    if (!retry_call_list.empty()) {
+      BOOST_LOG_TRIVIAL(error) << "Call Concluder stopped with " << retry_call_list.size() << " calls waiting to be retried, their files are left in place";
+    }
+    return;
+  }
+
+  for (std::list<Call_Data_t>::iterator it = retry_call_list.begin(); it != retry_call_list.end();) {
+    if (it->process_call_time <= time(0)) {
+      enqueue_call_data(std::move(*it));
       it = retry_call_list.erase(it);
     } else {
       it++;
@@ -2,9 +2,12 @@
 #define CALL_CONCLUDER_H
 #include <boost/regex.hpp>
 #include <sys/stat.h>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
 #include <future>
 #include <list>
+#include <mutex>
 #include <queue>
 #include <thread>
 #include <vector>
@@ -17,19 +20,66 @@
 
 Call_Data_t upload_call_worker(Call_Data_t call_info);
 
+struct Call_Data_Job {
+  Call_Data_t call_info;
+  long sequence;
+  std::chrono::steady_clock::time_point queued_time;
+};
+
+// Emergency Calls go first, then Talkgroups with a lower Priority number, then the oldest Call
+struct Call_Data_Job_Compare {
+  bool operator()(const Call_Data_Job &a, const Call_Data_Job &b) const {
+    if (a.call_info.emergency != b.call_info.emergency) {
+      return !a.call_info.emergency;
+    }
+    if (a.call_info.priority != b.call_info.priority) {
+      return a.call_info.priority > b.call_info.priority;
+    }
+    return a.sequence > b.sequence;
+  }
+};
+
 class Call_Concluder {
   static const int MAX_RETRY = 2;
 
+  static std::vector<std::thread> workers;
+  static std::priority_queue<Call_Data_Job, std::vector<Call_Data_Job>, Call_Data_Job_Compare> call_data_queue;
+  // Calls that arrived while call_data_queue was full. The workers move them
+  // over as they free up space, so whoever concludes a Call never waits. When
+  // it is full too, the lowest priority Call is dropped and its files are
+  // removed after queue_mutex has been released.
+  static std::deque<Call_Data_Job> overflow_calls;
+  static std::deque<Call_Data_t> completed_calls;
+  static std::mutex queue_mutex;
+  static std::condition_variable queue_cv;
+  static size_t max_queue_size;
+  static long job_sequence;
+  static bool stopping;
+
+  // Metrics, guarded by queue_mutex
+  static int busy_workers;
+  static long jobs_completed;
+  static double total_wait_ms;
+  static double max_wait_ms;
+  static double total_work_ms;
+  static long calls_overflowed;
+  static long calls_dropped;
+
+  static void worker_thread();
+  static void enqueue_call_data(Call_Data_t call_info);
+
 public:
   static std::list<Call_Data_t> retry_call_list;
-  static std::list<std::future<Call_Data_t>> call_data_workers;
-  
-  static Call_Data_t create_call_data(Call *call, System *sys, Config config);
-  static void conclude_call(Call *call, System *sys, Config config);
+
+  static void start_workers(int num_workers, int queue_size);
+  static void stop_workers();
+  static Call_Data_t create_call_data(Call *call, System *sys, const Config &config);
+  static void conclude_call(Call *call, System *sys, const Config &config);
   static void manage_call_data_workers();
+  static void print_stats();
 
 private:
-  static Call_Data_t create_base_filename(Call *call, Call_Data_t call_info);
+  static void create_base_filename(Call *call, Call_Data_t &call_info);
 };
 
 #endif
@@ -0,0 +1,482 @@
+#include "native_audio.h"
+#include "../gr_blocks/wavfile_gr3.8.h"
+
+#include <boost/log/trivial.hpp>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef HAVE_FDK_AAC
+#include <fdk-aac/aacenc_lib.h>
+#endif
+
+static const int aac_bitrate = 8000;
+
+static void write_le16(FILE *fp, uint16_t value) {
+  uint8_t bytes[2] = {(uint8_t)(value & 0xff), (uint8_t)(value >> 8)};
+  fwrite(bytes, 1, 2, fp);
+}
+
+static void write_le32(FILE *fp, uint32_t value) {
+  uint8_t bytes[4] = {(uint8_t)(value & 0xff), (uint8_t)((value >> 8) & 0xff), (uint8_t)((value >> 16) & 0xff), (uint8_t)(value >> 24)};
+  fwrite(bytes, 1, 4, fp);
+}
+
+static void write_samples(FILE *fp, std::vector<int16_t> &samples) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  for (std::vector<int16_t>::iterator it = samples.begin(); it != samples.end(); ++it) {
+    write_le16(fp, (uint16_t)*it);
+  }
+#else
+  fwrite(samples.data(), sizeof(int16_t), samples.size(), fp);
+#endif
+}
+
+static void write_wav(FILE *fp, std::vector<int16_t> &samples, unsigned int sample_rate) {
+  uint32_t data_size = samples.size() * sizeof(int16_t);
+
+  fwrite("RIFF", 1, 4, fp);
+  write_le32(fp, 36 + data_size);
+  fwrite("WAVEfmt ", 1, 8, fp);
+  write_le32(fp, 16);
+  write_le16(fp, 1); // PCM
+  write_le16(fp, 1); // mono
+  write_le32(fp, sample_rate);
+  write_le32(fp, sample_rate * sizeof(int16_t));
+  write_le16(fp, sizeof(int16_t));
+  write_le16(fp, 16);
+  fwrite("data", 1, 4, fp);
+  write_le32(fp, data_size);
+  write_samples(fp, samples);
+}
+
+int native_combine_wav(std::vector<Transmission> &transmission_list, char *target_filename, std::vector<int16_t> &samples, unsigned int &sample_rate) {
+  sample_rate = 0;
+  samples.clear();
+
+  for (std::vector<Transmission>::iterator it = transmission_list.begin(); it != transmission_list.end(); ++it) {
+    unsigned int file_rate;
+    int nchans;
+    int bytes_per_sample;
+    int first_sample_pos;
+    unsigned int samples_per_chan;
+
+    FILE *fp = fopen(it->filename, "rb");
+    if (!fp) {
+      BOOST_LOG_TRIVIAL(error) << "Somehow, " << it->filename << " doesn't exist, not adding it to the call";
+      continue;
+    }
+
+    if (!gr::blocks::wavheader_parse(fp, file_rate, nchans, bytes_per_sample, first_sample_pos, samples_per_chan)) {
+      BOOST_LOG_TRIVIAL(error) << "Unable to read the WAV header of: " << it->filename;
+      fclose(fp);
+      return -1;
+    }
+
+    if ((nchans != 1) || (bytes_per_sample != 2) || ((sample_rate != 0) && (file_rate != sample_rate))) {
+      BOOST_LOG_TRIVIAL(error) << "Transmission " << it->filename << " is not 16 bit mono at " << sample_rate << " Hz, unable to combine it natively";
+      fclose(fp);
+      return -1;
+    }
+    sample_rate = file_rate;
+
+    size_t offset = samples.size();
+    samples.resize(offset + samples_per_chan);
+    size_t read = fread(samples.data() + offset, sizeof(int16_t), samples_per_chan, fp);
+    samples.resize(offset + read);
+    fclose(fp);
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = offset; i < samples.size(); i++) {
+      samples[i] = (int16_t)__builtin_bswap16((uint16_t)samples[i]);
+    }
+#endif
+  }
+
+  if (sample_rate == 0) {
+    BOOST_LOG_TRIVIAL(error) << "No Transmissions could be read for: " << target_filename;
+    return -1;
+  }
+
+  FILE *out = fopen(target_filename, "wb");
+  if (!out) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to create call file: " << target_filename;
+    return -1;
+  }
+  write_wav(out, samples, sample_rate);
+  fclose(out);
+
+  return samples.size();
+}
+
+void normalize_samples(std::vector<int16_t> &samples, double level_db) {
+  int peak = 0;
+
+  for (std::vector<int16_t>::iterator it = samples.begin(); it != samples.end(); ++it) {
+    int value = abs(*it);
+    if (value > peak) {
+      peak = value;
+    }
+  }
+
+  if (peak == 0) {
+    return;
+  }
+
+  double gain = (pow(10.0, level_db / 20.0) * 32767.0) / peak;
+
+  for (std::vector<int16_t>::iterator it = samples.begin(); it != samples.end(); ++it) {
+    long value = lround(*it * gain);
+    if (value > 32767) {
+      value = 32767;
+    } else if (value < -32768) {
+      value = -32768;
+    }
+    *it = (int16_t)value;
+  }
+}
+
+#ifdef HAVE_FDK_AAC
+
+// Builds up MP4 boxes in memory, big-endian as the format requires
+class Mp4Writer {
+  std::vector<uint8_t> buffer;
+  std::vector<size_t> open_boxes;
+
+public:
+  void u8(uint8_t value) { buffer.push_back(value); }
+  void u16(uint16_t value) {
+    u8(value >> 8);
+    u8(value & 0xff);
+  }
+  void u24(uint32_t value) {
+    u8((value >> 16) & 0xff);
+    u16(value & 0xffff);
+  }
+  void u32(uint32_t value) {
+    u16(value >> 16);
+    u16(value & 0xffff);
+  }
+  void bytes(const void *data, size_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    buffer.insert(buffer.end(), p, p + len);
+  }
+  void zeros(size_t len) { buffer.insert(buffer.end(), len, 0); }
+  void matrix() {
+    uint32_t m[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (int i = 0; i < 9; i++) {
+      u32(m[i]);
+    }
+  }
+  void begin(const char *type) {
+    open_boxes.push_back(buffer.size());
+    u32(0);
+    bytes(type, 4);
+  }
+  void begin_full(const char *type, uint8_t version, uint32_t flags) {
+    begin(type);
+    u8(version);
+    u24(flags);
+  }
+  void end() {
+    size_t start = open_boxes.back();
+    open_boxes.pop_back();
+    uint32_t size = buffer.size() - start;
+    buffer[start] = size >> 24;
+    buffer[start + 1] = (size >> 16) & 0xff;
+    buffer[start + 2] = (size >> 8) & 0xff;
+    buffer[start + 3] = size & 0xff;
+  }
+  // MPEG-4 descriptors use a variable length size, the 4 byte form is always valid
+  void descriptor(uint8_t tag, uint32_t size) {
+    u8(tag);
+    u8(0x80 | ((size >> 21) & 0x7f));
+    u8(0x80 | ((size >> 14) & 0x7f));
+    u8(0x80 | ((size >> 7) & 0x7f));
+    u8(size & 0x7f);
+  }
+  size_t size() { return buffer.size(); }
+  std::vector<uint8_t> &data() { return buffer; }
+};
+
+static void write_moov(Mp4Writer &mp4, unsigned int sample_rate, std::vector<uint32_t> &frame_sizes, unsigned int frame_length, std::vector<uint8_t> &asc, uint32_t mdat_offset) {
+  uint32_t duration = frame_sizes.size() * frame_length;
+  uint32_t max_frame = 0;
+  uint64_t total_bytes = 0;
+
+  for (std::vector<uint32_t>::iterator it = frame_sizes.begin(); it != frame_sizes.end(); ++it) {
+    total_bytes += *it;
+    if (*it > max_frame) {
+      max_frame = *it;
+    }
+  }
+  uint32_t avg_bitrate = duration ? (uint32_t)((total_bytes * 8 * sample_rate) / duration) : 0;
+
+  mp4.begin("moov");
+
+  mp4.begin_full("mvhd", 0, 0);
+  mp4.u32(0); // creation time
+  mp4.u32(0); // modification time
+  mp4.u32(sample_rate);
+  mp4.u32(duration);
+  mp4.u32(0x00010000); // rate
+  mp4.u16(0x0100);     // volume
+  mp4.zeros(10);
+  mp4.matrix();
+  mp4.zeros(24);
+  mp4.u32(2); // next track ID
+  mp4.end();
+
+  mp4.begin("trak");
+  mp4.begin_full("tkhd", 0, 7);
+  mp4.u32(0);
+  mp4.u32(0);
+  mp4.u32(1); // track ID
+  mp4.u32(0);
+  mp4.u32(duration);
+  mp4.zeros(8);
+  mp4.u16(0); // layer
+  mp4.u16(0); // alternate group
+  mp4.u16(0x0100);
+  mp4.u16(0);
+  mp4.matrix();
+  mp4.u32(0); // width
+  mp4.u32(0); // height
+  mp4.end();
+
+  mp4.begin("mdia");
+  mp4.begin_full("mdhd", 0, 0);
+  mp4.u32(0);
+  mp4.u32(0);
+  mp4.u32(sample_rate);
+  mp4.u32(duration);
+  mp4.u16(0x55c4); // 'und'
+  mp4.u16(0);
+  mp4.end();
+
+  mp4.begin_full("hdlr", 0, 0);
+  mp4.u32(0);
+  mp4.bytes("soun", 4);
+  mp4.zeros(12);
+  mp4.bytes("SoundHandler", 13);
+  mp4.end();
+
+  mp4.begin("minf");
+  mp4.begin_full("smhd", 0, 0);
+  mp4.u32(0);
+  mp4.end();
+
+  mp4.begin("dinf");
+  mp4.begin_full("dref", 0, 0);
+  mp4.u32(1);
+  mp4.begin_full("url ", 0, 1);
+  mp4.end();
+  mp4.end();
+  mp4.end();
+
+  mp4.begin("stbl");
+  mp4.begin_full("stsd", 0, 0);
+  mp4.u32(1);
+  mp4.begin("mp4a");
+  mp4.zeros(6);
+  mp4.u16(1); // data reference index
+  mp4.zeros(8);
+  mp4.u16(1);  // channels
+  mp4.u16(16); // sample size
+  mp4.u32(0);
+  mp4.u32(sample_rate << 16);
+
+  uint32_t dsi_size = asc.size();
+  uint32_t dcd_size = 13 + 5 + dsi_size;
+  uint32_t es_size = 3 + 5 + dcd_size + 5 + 1;
+  mp4.begin_full("esds", 0, 0);
+  mp4.descriptor(0x03, es_size);
+  mp4.u16(0); // ES ID
+  mp4.u8(0);
+  mp4.descriptor(0x04, dcd_size);
+  mp4.u8(0x40); // MPEG-4 Audio
+  mp4.u8(0x15); // Audio stream
+  mp4.u24(max_frame);
+  mp4.u32(avg_bitrate);
+  mp4.u32(avg_bitrate);
+  mp4.descriptor(0x05, dsi_size);
+  mp4.bytes(asc.data(), dsi_size);
+  mp4.descriptor(0x06, 1);
+  mp4.u8(0x02);
+  mp4.end();
+
+  mp4.end(); // mp4a
+  mp4.end(); // stsd
+
+  mp4.begin_full("stts", 0, 0);
+  mp4.u32(1);
+  mp4.u32(frame_sizes.size());
+  mp4.u32(frame_length);
+  mp4.end();
+
+  // All of the frames go in a single chunk
+  mp4.begin_full("stsc", 0, 0);
+  mp4.u32(1);
+  mp4.u32(1);
+  mp4.u32(frame_sizes.size());
+  mp4.u32(1);
+  mp4.end();
+
+  mp4.begin_full("stsz", 0, 0);
+  mp4.u32(0);
+  mp4.u32(frame_sizes.size());
+  for (std::vector<uint32_t>::iterator it = frame_sizes.begin(); it != frame_sizes.end(); ++it) {
+    mp4.u32(*it);
+  }
+  mp4.end();
+
+  mp4.begin_full("stco", 0, 0);
+  mp4.u32(1);
+  mp4.u32(mdat_offset);
+  mp4.end();
+
+  mp4.end(); // stbl
+  mp4.end(); // minf
+  mp4.end(); // mdia
+  mp4.end(); // trak
+  mp4.end(); // moov
+}
+
+int native_convert_media(std::vector<int16_t> &samples, unsigned int sample_rate, char *converted) {
+  HANDLE_AACENCODER encoder;
+  AACENC_InfoStruct info;
+
+  if (aacEncOpen(&encoder, 0, 1) != AACENC_OK) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to open the AAC encoder";
+    return -1;
+  }
+
+  if ((aacEncoder_SetParam(encoder, AACENC_AOT, 2) != AACENC_OK) ||
+      (aacEncoder_SetParam(encoder, AACENC_SAMPLERATE, sample_rate) != AACENC_OK) ||
+      (aacEncoder_SetParam(encoder, AACENC_CHANNELMODE, MODE_1) != AACENC_OK) ||
+      (aacEncoder_SetParam(encoder, AACENC_BITRATE, aac_bitrate) != AACENC_OK) ||
+      (aacEncoder_SetParam(encoder, AACENC_TRANSMUX, 0) != AACENC_OK) ||
+      (aacEncoder_SetParam(encoder, AACENC_AFTERBURNER, 1) != AACENC_OK) ||
+      (aacEncEncode(encoder, NULL, NULL, NULL, NULL) != AACENC_OK) ||
+      (aacEncInfo(encoder, &info) != AACENC_OK)) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to configure the AAC encoder for " << sample_rate << " Hz";
+    aacEncClose(&encoder);
+    return -1;
+  }
+
+  std::vector<uint8_t> asc(info.confBuf, info.confBuf + info.confSize);
+  std::vector<uint8_t> encoded;
+  std::vector<uint32_t> frame_sizes;
+  std::vector<uint8_t> out_buf(info.maxOutBufBytes);
+  size_t pos = 0;
+
+  while (true) {
+    AACENC_BufDesc in_desc = {0};
+    AACENC_BufDesc out_desc = {0};
+    AACENC_InArgs in_args = {0};
+    AACENC_OutArgs out_args = {0};
+
+    int in_id = IN_AUDIO_DATA;
+    int in_size = (samples.size() - pos) * sizeof(int16_t);
+    int in_el_size = sizeof(int16_t);
+    void *in_ptr = samples.data() + pos;
+    int out_id = OUT_BITSTREAM_DATA;
+    int out_size = out_buf.size();
+    int out_el_size = 1;
+    void *out_ptr = out_buf.data();
+
+    if (pos < samples.size()) {
+      in_args.numInSamples = samples.size() - pos;
+      in_desc.numBufs = 1;
+      in_desc.bufs = &in_ptr;
+      in_desc.bufferIdentifiers = &in_id;
+      in_desc.bufSizes = &in_size;
+      in_desc.bufElSizes = &in_el_size;
+    } else {
+      // Flush the encoder
+      in_args.numInSamples = -1;
+    }
+    out_desc.numBufs = 1;
+    out_desc.bufs = &out_ptr;
+    out_desc.bufferIdentifiers = &out_id;
+    out_desc.bufSizes = &out_size;
+    out_desc.bufElSizes = &out_el_size;
+
+    AACENC_ERROR err = aacEncEncode(encoder, &in_desc, &out_desc, &in_args, &out_args);
+    if (err == AACENC_ENCODE_EOF) {
+      break;
+    }
+    if (err != AACENC_OK) {
+      BOOST_LOG_TRIVIAL(error) << "AAC encoding failed for: " << converted;
+      aacEncClose(&encoder);
+      return -1;
+    }
+    pos += out_args.numInSamples;
+    if (out_args.numOutBytes > 0) {
+      encoded.insert(encoded.end(), out_buf.begin(), out_buf.begin() + out_args.numOutBytes);
+      frame_sizes.push_back(out_args.numOutBytes);
+    }
+  }
+  aacEncClose(&encoder);
+
+  Mp4Writer header;
+  header.begin("ftyp");
+  header.bytes("M4A ", 4);
+  header.u32(0x200);
+  header.bytes("M4A mp42isom", 12);
+  header.end();
+  size_t ftyp_size = header.size();
+
+  // The moov box has to be built once to find its size, the chunk offset inside of it does not change its size
+  Mp4Writer moov_size;
+  write_moov(moov_size, sample_rate, frame_sizes, info.frameLength, asc, 0);
+  uint32_t mdat_offset = ftyp_size + moov_size.size() + 8;
+  write_moov(header, sample_rate, frame_sizes, info.frameLength, asc, mdat_offset);
+
+  FILE *fp = fopen(converted, "wb");
+  if (!fp) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to create: " << converted;
+    return -1;
+  }
+  fwrite(header.data().data(), 1, header.size(), fp);
+  uint8_t mdat_header[8] = {0, 0, 0, 0, 'm', 'd', 'a', 't'};
+  uint32_t mdat_size = encoded.size() + 8;
+  mdat_header[0] = mdat_size >> 24;
+  mdat_header[1] = (mdat_size >> 16) & 0xff;
+  mdat_header[2] = (mdat_size >> 8) & 0xff;
+  mdat_header[3] = mdat_size & 0xff;
+  fwrite(mdat_header, 1, 8, fp);
+  fwrite(encoded.data(), 1, encoded.size(), fp);
+  fclose(fp);
+
+  return encoded.size();
+}
+
+#else
+
+int native_convert_media(std::vector<int16_t> &samples, unsigned int sample_rate, char *converted) {
+  char shell_command[400];
+
+  int nchars = snprintf(shell_command, 400, "fdkaac --silent -p 2 --moov-before-mdat --ignorelength -b %d -o %s -", aac_bitrate, converted);
+
+  if (nchars >= 400) {
+    BOOST_LOG_TRIVIAL(error) << "Call uploader: Command longer than 400 characters";
+    return -1;
+  }
+
+  FILE *pipe = popen(shell_command, "w");
+  if (!pipe) {
+    BOOST_LOG_TRIVIAL(error) << "Failed to start fdkaac. Make sure you have fdkaac installed.";
+    return -1;
+  }
+  write_wav(pipe, samples, sample_rate);
+  int rc = pclose(pipe);
+
+  if (rc != 0) {
+    BOOST_LOG_TRIVIAL(error) << "Failed to convert call recording, see above error. Make sure you have fdkaac installed.";
+    return -1;
+  }
+  return nchars;
+}
+
+#endif
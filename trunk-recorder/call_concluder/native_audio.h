@@ -0,0 +1,21 @@
+#ifndef NATIVE_AUDIO_H
+#define NATIVE_AUDIO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "../global_structs.h"
+
+// Reads the Transmission WAV files for a Call into memory and writes them out as a single WAV.
+// Returns -1 if the files could not be read or do not all share the same format.
+int native_combine_wav(std::vector<Transmission> &transmission_list, char *target_filename, std::vector<int16_t> &samples, unsigned int &sample_rate);
+
+// Peak normalizes the samples to the given level in dBFS, like sox --norm
+void normalize_samples(std::vector<int16_t> &samples, double level_db);
+
+// Encodes the samples as AAC-LC in an M4A file. This uses libfdk-aac directly when
+// Trunk Recorder was built with it, otherwise the samples are piped to fdkaac.
+int native_convert_media(std::vector<int16_t> &samples, unsigned int sample_rate, char *converted);
+
+#endif
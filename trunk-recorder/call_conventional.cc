@@ -4,10 +4,13 @@
 #include "recorders/recorder.h"
 #include <boost/algorithm/string.hpp>
 
-Call_conventional::Call_conventional(long t, double f, System *s, Config c) : Call_impl(t, f, s, c) {
+Call_conventional::Call_conventional(long t, double f, System *s, Config_Snapshot c) : Call_impl(t, f, s, c) {
 }
 
 void Call_conventional::restart_call() {
+  // conventional calls are reused, so each new transmission picks up the latest tags
+  talkgroups = sys->get_talkgroups_snapshot();
+  unit_tags = sys->get_unit_tags_snapshot();
   idle_count = 0;
   curr_src_id = -1;
   start_time = time(NULL);
@@ -10,24 +10,24 @@
 #include <stdio.h>
 
 std::string Call_impl::get_capture_dir() {
-  return this->config.capture_dir;
+  return this->config->capture_dir;
 }
 
 std::string Call_impl::get_temp_dir() { 
-  return this->config.temp_dir; 
+  return this->config->temp_dir; 
 }
 
 /*
-Call * Call::make(long t, double f, System *s, Config c) {
+Call * Call::make(long t, double f, System *s, Config_Snapshot c) {
 
   return (Call *) new Call_impl(t, f, s, c);
 }*/
 
-Call *Call::make(TrunkMessage message, System *s, Config c) {
+Call *Call::make(TrunkMessage message, System *s, Config_Snapshot c) {
   return (Call *)new Call_impl(message, s, c);
 }
 
-Call_impl::Call_impl(long t, double f, System *s, Config c) {
+Call_impl::Call_impl(long t, double f, System *s, Config_Snapshot c) {
   config = c;
   call_num = call_counter++;
   final_length = 0;
@@ -36,6 +36,8 @@ Call_impl::Call_impl(long t, double f, System *s, Config c) {
   curr_src_id = -1;
   talkgroup = t;
   sys = s;
+  talkgroups = s->get_talkgroups_snapshot();
+  unit_tags = s->get_unit_tags_snapshot();
   start_time = time(NULL);
   stop_time = time(NULL);
   last_update = time(NULL);
@@ -57,7 +59,7 @@ Call_impl::Call_impl(long t, double f, System *s, Config c) {
   this->update_talkgroup_display();
 }
 
-Call_impl::Call_impl(TrunkMessage message, System *s, Config c) {
+Call_impl::Call_impl(TrunkMessage message, System *s, Config_Snapshot c) {
   config = c;
   call_num = call_counter++;
   final_length = 0;
@@ -66,6 +68,8 @@ Call_impl::Call_impl(TrunkMessage message, System *s, Config c) {
   curr_freq = 0;
   talkgroup = message.talkgroup;
   sys = s;
+  talkgroups = s->get_talkgroups_snapshot();
+  unit_tags = s->get_unit_tags_snapshot();
   start_time = time(NULL);
   stop_time = time(NULL);
   last_update = time(NULL);
@@ -138,7 +142,7 @@ void Call_impl::conclude_call() {
       this->get_debug_recorder()->stop();
     }
 
-    Call_Concluder::conclude_call(this, sys, config);
+    Call_Concluder::conclude_call(this, sys, *config);
   }
 }
 
@@ -190,6 +194,14 @@ System *Call_impl::get_system() {
   return sys;
 }
 
+Talkgroups_Snapshot Call_impl::get_talkgroups_snapshot() {
+  return talkgroups;
+}
+
+Unit_Tags_Snapshot Call_impl::get_unit_tags_snapshot() {
+  return unit_tags;
+}
+
 void Call_impl::set_freq(double f) {
   if (f != curr_freq) {
     curr_freq = f;
@@ -420,42 +432,68 @@ void Call_impl::update_talkgroup_display() {
   talkgroup_display = boost::lexical_cast<std::string>(formattedTalkgroup);
 }
 
-boost::property_tree::ptree Call_impl::get_stats() {
-  boost::property_tree::ptree call_node;
-  boost::property_tree::ptree freq_list_node;
-  boost::property_tree::ptree source_list_node;
-  call_node.put("id", boost::lexical_cast<std::string>(this->get_sys_num()) + "_" + boost::lexical_cast<std::string>(this->get_talkgroup()) + "_" + boost::lexical_cast<std::string>(this->get_start_time()));
-  call_node.put("callNum", this->get_call_num());
-  call_node.put("freq", this->get_freq());
-  call_node.put("sysNum", this->get_sys_num());
-  call_node.put("shortName", this->get_short_name());
-  call_node.put("talkgroup", this->get_talkgroup());
-  call_node.put("talkgrouptag", this->get_talkgroup_tag());
-  call_node.put("elapsed", this->elapsed());
+// The one place the fields of a Call's status are set, get_stats() is the same thing as a ptree
+nlohmann::json Call_impl::get_stats_json() {
+  nlohmann::json call_node;
+  call_node["id"] = std::to_string(this->get_sys_num()) + "_" + std::to_string(this->get_talkgroup()) + "_" + std::to_string(this->get_start_time());
+  call_node["callNum"] = this->get_call_num();
+  call_node["freq"] = this->get_freq();
+  call_node["sysNum"] = this->get_sys_num();
+  call_node["shortName"] = this->get_short_name();
+  call_node["talkgroup"] = this->get_talkgroup();
+  call_node["talkgrouptag"] = this->get_talkgroup_tag();
+  call_node["elapsed"] = this->elapsed();
   if (get_state() == RECORDING)
-    call_node.put("length", this->get_current_length());
+    call_node["length"] = this->get_current_length();
   else
-    call_node.put("length", this->get_final_length());
-  call_node.put("state", this->get_state());
-  call_node.put("monState", this->get_monitoring_state());
-  call_node.put("phase2", this->get_phase2_tdma());
-  call_node.put("conventional", this->is_conventional());
-  call_node.put("encrypted", this->get_encrypted());
-  call_node.put("emergency", this->get_emergency());
-  call_node.put("priority", this->get_priority());
-  call_node.put("mode", this->get_mode());
-  call_node.put("duplex", this->get_duplex());
-  call_node.put("startTime", this->get_start_time());
-  call_node.put("stopTime", this->get_stop_time());
-  call_node.put("srcId", this->get_current_source_id());
+    call_node["length"] = this->get_final_length();
+  call_node["state"] = this->get_state();
+  call_node["monState"] = this->get_monitoring_state();
+  call_node["phase2"] = this->get_phase2_tdma();
+  call_node["conventional"] = this->is_conventional();
+  call_node["encrypted"] = this->get_encrypted();
+  call_node["emergency"] = this->get_emergency();
+  call_node["priority"] = this->get_priority();
+  call_node["mode"] = this->get_mode();
+  call_node["duplex"] = this->get_duplex();
+  call_node["startTime"] = this->get_start_time();
+  call_node["stopTime"] = this->get_stop_time();
+  call_node["srcId"] = this->get_current_source_id();
 
   Recorder *recorder = this->get_recorder();
 
   if (recorder) {
-    call_node.put("recNum", recorder->get_num());
-    call_node.put("srcNum", recorder->get_source()->get_num());
-    call_node.put("recState", recorder->get_state());
-    call_node.put("analog", recorder->is_analog());
+    call_node["recNum"] = recorder->get_num();
+    call_node["srcNum"] = recorder->get_source()->get_num();
+    call_node["recState"] = recorder->get_state();
+    call_node["analog"] = recorder->is_analog();
+  }
+
+  return call_node;
+}
+
+// The order the fields have always had in the ptree, nlohmann keeps its keys sorted
+static const char *const call_stats_keys[] = {"id", "callNum", "freq", "sysNum", "shortName", "talkgroup", "talkgrouptag", "elapsed", "length", "state", "monState", "phase2", "conventional", "encrypted", "emergency", "priority", "mode", "duplex", "startTime", "stopTime", "srcId", "recNum", "srcNum", "recState", "analog"};
+
+boost::property_tree::ptree Call_impl::get_stats() {
+  boost::property_tree::ptree call_node;
+  nlohmann::json stats = this->get_stats_json();
+
+  // each value is put with its own type, so it is formatted the way ptree always has
+  for (const char *key : call_stats_keys) {
+    nlohmann::json::iterator it = stats.find(key);
+    if (it == stats.end()) {
+      continue;
+    }
+    if (it.value().is_boolean()) {
+      call_node.put(key, it.value().get<bool>());
+    } else if (it.value().is_number_integer()) {
+      call_node.put(key, it.value().get<long long>());
+    } else if (it.value().is_number_float()) {
+      call_node.put(key, it.value().get<double>());
+    } else {
+      call_node.put(key, it.value().get<std::string>());
+    }
   }
 
   return call_node;
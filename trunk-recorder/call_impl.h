@@ -21,8 +21,8 @@ class System;
 
 class Call_impl : public Call {
 public:
-  Call_impl(long t, double f, System *s, Config c);
-  Call_impl(TrunkMessage message, System *s, Config c);
+  Call_impl(long t, double f, System *s, Config_Snapshot c);
+  Call_impl(TrunkMessage message, System *s, Config_Snapshot c);
 
   long get_call_num();
   virtual void restart_call();
@@ -80,6 +80,7 @@ public:
   void set_talkgroup_tag(std::string tag);
   void clear_transmission_list();
   boost::property_tree::ptree get_stats();
+  nlohmann::json get_stats_json();
 
   std::string get_talkgroup_tag();
   std::string get_system_type();
@@ -87,6 +88,8 @@ public:
   long get_current_source_id();
   bool get_conversation_mode();
   System *get_system();
+  Talkgroups_Snapshot get_talkgroups_snapshot();
+  Unit_Tags_Snapshot get_unit_tags_snapshot();
   std::vector<Transmission> get_transmissions();
 
 protected:
@@ -126,7 +129,11 @@ protected:
   int tdma_slot;
   double final_length;
 
-  Config config;
+  Config_Snapshot config;
+  // the Talkgroups and Unit Tags loaded when the call started, a reload
+  // while it is going does not change how it is tagged
+  Talkgroups_Snapshot talkgroups;
+  Unit_Tags_Snapshot unit_tags;
   Recorder *recorder;
   Recorder *debug_recorder;
   Recorder *sigmf_recorder;
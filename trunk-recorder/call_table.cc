@@ -0,0 +1,76 @@
+#include "call_table.h"
+#include "call.h"
+
+#include <algorithm>
+
+const std::vector<Call *> Call_Table::no_calls;
+
+static void remove_from(std::vector<Call *> &list, Call *call) {
+  std::vector<Call *>::iterator it = std::find(list.begin(), list.end(), call);
+  if (it != list.end()) {
+    list.erase(it);
+  }
+}
+
+void Call_Table::add(Call *call) {
+  positions[call] = calls.size();
+  calls.push_back(call);
+  channel_index[call->get_sys_num()][call->get_freq()].push_back(call);
+  talkgroup_index[call->get_talkgroup()].push_back(call);
+}
+
+void Call_Table::remove(Call *call) {
+  std::unordered_map<Call *, size_t>::iterator pos = positions.find(call);
+  if (pos == positions.end()) {
+    return;
+  }
+
+  size_t index = pos->second;
+  positions.erase(pos);
+  if (index != calls.size() - 1) {
+    calls[index] = calls.back();
+    positions[calls[index]] = index;
+  }
+  calls.pop_back();
+
+  // The index lists only hold the few Calls sharing a channel or Talkgroup,
+  // so they keep their order, and empty ones are dropped.
+  std::unordered_map<int, std::unordered_map<double, std::vector<Call *>>>::iterator sys_it = channel_index.find(call->get_sys_num());
+  if (sys_it != channel_index.end()) {
+    std::unordered_map<double, std::vector<Call *>>::iterator freq_it = sys_it->second.find(call->get_freq());
+    if (freq_it != sys_it->second.end()) {
+      remove_from(freq_it->second, call);
+      if (freq_it->second.empty()) {
+        sys_it->second.erase(freq_it);
+      }
+    }
+  }
+
+  std::unordered_map<long, std::vector<Call *>>::iterator tg_it = talkgroup_index.find(call->get_talkgroup());
+  if (tg_it != talkgroup_index.end()) {
+    remove_from(tg_it->second, call);
+    if (tg_it->second.empty()) {
+      talkgroup_index.erase(tg_it);
+    }
+  }
+}
+
+const std::vector<Call *> &Call_Table::find_channel(int sys_num, double freq) const {
+  std::unordered_map<int, std::unordered_map<double, std::vector<Call *>>>::const_iterator sys_it = channel_index.find(sys_num);
+  if (sys_it == channel_index.end()) {
+    return no_calls;
+  }
+  std::unordered_map<double, std::vector<Call *>>::const_iterator freq_it = sys_it->second.find(freq);
+  if (freq_it == sys_it->second.end()) {
+    return no_calls;
+  }
+  return freq_it->second;
+}
+
+const std::vector<Call *> &Call_Table::find_talkgroup(long talkgroup) const {
+  std::unordered_map<long, std::vector<Call *>>::const_iterator it = talkgroup_index.find(talkgroup);
+  if (it == talkgroup_index.end()) {
+    return no_calls;
+  }
+  return it->second;
+}
@@ -0,0 +1,42 @@
+#ifndef CALL_TABLE_H
+#define CALL_TABLE_H
+
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+
+class Call;
+
+// The active Calls. Besides the list itself, Calls are indexed by System
+// number then Frequency, for matching GRANTs and UPDATEs to the Call on that
+// channel, and by Talkgroup across every System, for finding multi-site
+// duplicates. A Call's System, Frequency and Talkgroup can't change once it
+// has been made, so the indexes only change when Calls are added or removed.
+class Call_Table {
+  std::vector<Call *> calls;
+  std::unordered_map<Call *, size_t> positions;
+  std::unordered_map<int, std::unordered_map<double, std::vector<Call *>>> channel_index;
+  std::unordered_map<long, std::vector<Call *>> talkgroup_index;
+
+  static const std::vector<Call *> no_calls;
+
+public:
+  typedef std::vector<Call *>::const_iterator const_iterator;
+
+  void add(Call *call);
+  // Moves the last Call into the removed Call's place, so the order of the
+  // Calls is not kept.
+  void remove(Call *call);
+
+  // Every Call on the freq of a System, whatever its Talkgroup or TDMA slot.
+  const std::vector<Call *> &find_channel(int sys_num, double freq) const;
+  // Every Call for a Talkgroup number, on any System.
+  const std::vector<Call *> &find_talkgroup(long talkgroup) const;
+
+  const std::vector<Call *> &get_calls() const { return calls; }
+  Call *operator[](size_t index) const { return calls[index]; }
+  size_t size() const { return calls.size(); }
+  const_iterator begin() const { return calls.begin(); }
+  const_iterator end() const { return calls.end(); }
+};
+#endif // CALL_TABLE_H
@@ -14,6 +14,60 @@ namespace sinks = boost::log::sinks;
 
 using namespace std;
 
+static Config_Snapshot config_snapshot;
+static long config_version = 0;
+
+// Swaps in a copy of config for the Calls started from now on. Calls
+// that are already running keep the snapshot they have.
+Config_Snapshot publish_config(const Config &config) {
+  std::shared_ptr<Config> snapshot = std::make_shared<Config>(config);
+  snapshot->version = ++config_version;
+  std::atomic_store(&config_snapshot, Config_Snapshot(snapshot));
+  BOOST_LOG_TRIVIAL(info) << "Config version " << snapshot->version << " published";
+  return snapshot;
+}
+
+Config_Snapshot get_config_snapshot() {
+  return std::atomic_load(&config_snapshot);
+}
+
+// Fills in the sample format, rate and center frequency of a SigMF recording from its meta file.
+// The rate and center are only filled in if they have not been set in the config.
+bool read_sigmf_meta(std::string &data_file, std::string &format, double &rate, double &center) {
+  size_t ext = data_file.rfind(".sigmf-");
+  if (ext == std::string::npos) {
+    return false;
+  }
+  std::string base = data_file.substr(0, ext);
+  std::ifstream meta_file(base + ".sigmf-meta");
+  if (!meta_file.is_open()) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to open SigMF meta file: " << base << ".sigmf-meta";
+    return false;
+  }
+
+  json meta = json::parse(meta_file);
+  std::string datatype = meta["global"].value("core:datatype", "");
+  if (datatype == "cf32_le") {
+    format = "cf32";
+  } else if (datatype == "ci16_le") {
+    format = "ci16";
+  } else if (datatype == "cu8") {
+    format = "cu8";
+  } else {
+    BOOST_LOG_TRIVIAL(error) << "SigMF datatype not supported: " << datatype << ", needs to be cf32_le, ci16_le or cu8";
+    return false;
+  }
+
+  if (rate == 0) {
+    rate = meta["global"].value("core:sample_rate", 0.0);
+  }
+  if ((center == 0) && meta.contains("captures") && (meta["captures"].size() > 0)) {
+    center = meta["captures"][0].value("core:frequency", 0.0);
+  }
+  data_file = base + ".sigmf-data";
+  return true;
+}
+
 void set_logging_level(std::string log_level) {
   boost::log::trivial::severity_level sev_level = boost::log::trivial::info;
 
@@ -154,10 +208,24 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
     BOOST_LOG_TRIVIAL(info) << "Control channel retune limit: " << config.control_retune_limit;
     config.soft_vocoder = data.value("softVocoder", false);
     BOOST_LOG_TRIVIAL(info) << "Phase 1 Software Vocoder: " << config.soft_vocoder;
+    config.vocoder_threads = data.value("vocoderThreads", 0);
+    BOOST_LOG_TRIVIAL(info) << "Vocoder Threads: " << config.vocoder_threads;
     config.enable_audio_streaming = data.value("audioStreaming", false);
     BOOST_LOG_TRIVIAL(info) << "Enable Audio Streaming: " << config.enable_audio_streaming;
     config.record_uu_v_calls = data.value("recordUUVCalls", true);
     BOOST_LOG_TRIVIAL(info) << "Record Unit to Unit Voice Calls: " << config.record_uu_v_calls;
+    config.native_audio = data.value("nativeAudio", false);
+    BOOST_LOG_TRIVIAL(info) << "Native Audio Processing: " << config.native_audio;
+    config.call_concluder_threads = data.value("callConcluderThreads", 4);
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Threads: " << config.call_concluder_threads;
+    config.call_concluder_queue_limit = data.value("callConcluderQueueLimit", 500);
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Queue Limit: " << config.call_concluder_queue_limit;
+    config.system_threads = data.value("systemThreads", false);
+    BOOST_LOG_TRIVIAL(info) << "Handle each System on its own Thread: " << config.system_threads;
+    config.wav_preallocate_seconds = data.value("wavPreallocateSeconds", 0);
+    BOOST_LOG_TRIVIAL(info) << "Preallocate WAV files for: " << config.wav_preallocate_seconds << " seconds";
+    config.wav_flush_seconds = data.value("wavFlushSeconds", 0);
+    BOOST_LOG_TRIVIAL(info) << "Flush WAV files every: " << config.wav_flush_seconds << " seconds of audio";
     config.new_call_from_update = data.value("newCallFromUpdate", true);
     BOOST_LOG_TRIVIAL(info) << "New Call from UPDATE Messages" << config.new_call_from_update;
     std::string frequency_format_string = data.value("frequencyFormat", "mhz");
@@ -225,7 +293,9 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
           } else if (channel_file_exist) {
             std::string channel_file = element["channelFile"];
             BOOST_LOG_TRIVIAL(info) << "Channel File: " << channel_file;
-            system->set_channel_file(channel_file);
+            if (!system->set_channel_file(channel_file)) {
+              return false;
+            }
           } else {
             BOOST_LOG_TRIVIAL(error) << "Either \"channels\" or \"channelFile\" need to be defined for a conventional system!";
             return false;
@@ -240,7 +310,9 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
           for (unsigned int i = 0; i < control_channels.size(); i++) {
             BOOST_LOG_TRIVIAL(info) << "  " << format_freq(control_channels[i]);
           }
-          system->set_talkgroups_file(element.value("talkgroupsFile", ""));
+          if (!system->set_talkgroups_file(element.value("talkgroupsFile", ""))) {
+            return false;
+          }
           BOOST_LOG_TRIVIAL(info) << "Talkgroups File: " << system->get_talkgroups_file();
         } else {
           BOOST_LOG_TRIVIAL(error) << "System Type in config.json not recognized";
@@ -404,18 +476,34 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
         std::string antenna = element.value("antenna", "");
         int digital_recorders = element.value("digitalRecorders", 0);
         int sigmf_recorders = element.value("sigmfRecorders", 0);
+        double sigmf_pre_roll = element.value("sigmfPreRoll", 2.0);
+        double sigmf_channel_rate = element.value("sigmfChannelRate", 50000.0);
+        std::string sigmf_datatype = element.value("sigmfDatatype", "ci16_le");
         int analog_recorders = element.value("analogRecorders", 0);
+        double channelizer_spacing = element.value("channelizerSpacing", 0.0);
+        bool recorder_pool = element.value("recorderPool", false);
 
         std::string driver = element.value("driver", "");
 
-        if ((driver != "osmosdr") && (driver != "usrp")) {
-          BOOST_LOG_TRIVIAL(error) << "Driver specified in config.json not recognized, needs to be osmosdr or usrp";
+        if ((driver != "osmosdr") && (driver != "usrp") && (driver != "file")) {
+          BOOST_LOG_TRIVIAL(error) << "Driver specified in config.json not recognized, needs to be osmosdr, usrp or file";
         }
 
         std::string device = element.value("device", "");
+        std::string iq_format = element.value("iqFormat", "cf32");
+        bool real_time = element.value("realTime", true);
+
+        if (driver == "file") {
+          if ((device.find(".sigmf-") != std::string::npos) && !read_sigmf_meta(device, iq_format, rate, center)) {
+            return false;
+          }
+          BOOST_LOG_TRIVIAL(info) << "IQ File: " << device;
+          BOOST_LOG_TRIVIAL(info) << "IQ Format: " << iq_format;
+          BOOST_LOG_TRIVIAL(info) << "Real Time: " << real_time;
+        }
         BOOST_LOG_TRIVIAL(info) << "Driver: " << element.value("driver", "");
-        BOOST_LOG_TRIVIAL(info) << "Center: " << format_freq(element.value("center", 0.0));
-        BOOST_LOG_TRIVIAL(info) << "Rate: " << FormatSamplingRate(element.value("rate", 0.0));
+        BOOST_LOG_TRIVIAL(info) << "Center: " << format_freq(center);
+        BOOST_LOG_TRIVIAL(info) << "Rate: " << FormatSamplingRate(rate);
         BOOST_LOG_TRIVIAL(info) << "Error: " << element.value("error", 0.0);
         BOOST_LOG_TRIVIAL(info) << "PPM Error: " << element.value("ppm", 0.0);
         BOOST_LOG_TRIVIAL(info) << "Auto gain control: " << element.value("agc", false);
@@ -433,7 +521,14 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
         BOOST_LOG_TRIVIAL(info) << "Idle Silence: " << element.value("silenceFrame", 0);
         BOOST_LOG_TRIVIAL(info) << "Digital Recorders: " << element.value("digitalRecorders", 0);
         BOOST_LOG_TRIVIAL(info) << "SigMF Recorders: " << element.value("sigmfRecorders", 0);
+        if (sigmf_recorders > 0) {
+          BOOST_LOG_TRIVIAL(info) << "SigMF Pre-Roll: " << sigmf_pre_roll << "s";
+          BOOST_LOG_TRIVIAL(info) << "SigMF Channel Rate: " << FormatSamplingRate(sigmf_channel_rate);
+          BOOST_LOG_TRIVIAL(info) << "SigMF Datatype: " << sigmf_datatype;
+        }
         BOOST_LOG_TRIVIAL(info) << "Analog Recorders: " << element.value("analogRecorders", 0);
+        BOOST_LOG_TRIVIAL(info) << "Channelizer Spacing: " << element.value("channelizerSpacing", 0.0);
+        BOOST_LOG_TRIVIAL(info) << "Recorder Pool: " << element.value("recorderPool", false);
 
         if ((ppm != 0) && (error != 0)) {
           BOOST_LOG_TRIVIAL(info) << "Both PPM and Error should not be set at the same time. Setting Error to 0.";
@@ -441,6 +536,10 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
         }
 
         Source *source = new Source(center, rate, error, driver, device, &config);
+
+        if ((driver == "file") && !source->open_iq_file(iq_format, real_time)) {
+          return false;
+        }
         BOOST_LOG_TRIVIAL(info) << "Max Frequency: " << format_freq(source->get_max_hz());
         BOOST_LOG_TRIVIAL(info) << "Min Frequency: " << format_freq(source->get_min_hz());
 
@@ -524,9 +623,15 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
         if (ppm != 0) {
           source->set_freq_corr(ppm);
         }
+        source->set_channelizer_spacing(channelizer_spacing);
+        source->set_recorder_pool(recorder_pool);
         source->create_digital_recorders(tb, digital_recorders);
         source->create_analog_recorders(tb, analog_recorders);
-        source->create_sigmf_recorders(tb, sigmf_recorders);
+        if ((sigmf_datatype != "ci16_le") && (sigmf_datatype != "ci8")) {
+          BOOST_LOG_TRIVIAL(error) << "SigMF datatype not supported: " << sigmf_datatype << ", needs to be ci16_le or ci8";
+          return false;
+        }
+        source->create_sigmf_recorders(tb, sigmf_recorders, sigmf_pre_roll, sigmf_channel_rate, sigmf_datatype);
         if (config.debug_recorder) {
           source->create_debug_recorder(tb, source_count);
         }
@@ -33,5 +33,7 @@
 #include <json.hpp>
 
 bool load_config(std::string config_file, Config& config, gr::top_block_sptr& tb, std::vector<Source *>& sources, std::vector<System *>& systems); 
+Config_Snapshot publish_config(const Config &config);
+Config_Snapshot get_config_snapshot();
 
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef GLOBAL_STRUCTS_H
 #define GLOBAL_STRUCTS_H
 #include <ctime>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -39,10 +40,23 @@ struct Config {
   bool broadcast_signals;
   bool enable_audio_streaming;
   bool soft_vocoder;
+  int vocoder_threads;
   bool record_uu_v_calls;
   int frequency_format;
+  bool native_audio;
+  int call_concluder_threads;
+  int call_concluder_queue_limit;
+  bool system_threads;
+  int wav_preallocate_seconds;
+  int wav_flush_seconds;
+  long version;
 };
 
+// Calls keep a pointer to the Config they were started with instead of a
+// copy of it. A snapshot is never changed once it has been published, and
+// each one published gets the next version.
+typedef std::shared_ptr<const Config> Config_Snapshot;
+
 struct Call_Source {
   long source;
   long time;
@@ -105,6 +119,7 @@ struct Call_Data_t {
   bool transmission_archive;
   bool call_log;
   bool compress_wav;
+  bool native_audio;
   char filename[300];
   char status_filename[300];
   char converted[300];
@@ -0,0 +1,41 @@
+#ifndef INCLUDED_GR_CHANNEL_ROUTER_H
+#define INCLUDED_GR_CHANNEL_ROUTER_H
+
+#include <gnuradio/block.h>
+#include <gnuradio/blocks/api.h>
+
+namespace gr {
+namespace blocks {
+
+/*!
+ * \brief output[j][i] = input[route[j]][i]
+ * \ingroup misc_blk
+ *
+ * \details
+ * Takes every channel of a channelizer as an input and hands each
+ * output a copy of whichever input it has been routed to.
+ * Outputs that are not routed produce no samples, and inputs
+ * that nobody is listening to are consumed and dumped. Tags only
+ * follow the samples to the outputs their input is routed to.
+ *
+ */
+class BLOCKS_API channel_router : virtual public block {
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<channel_router> sptr;
+#else
+  typedef std::shared_ptr<channel_router> sptr;
+#endif
+
+  static sptr make(size_t itemsize);
+
+  // Route an output port to an input port. An input_index of -1
+  // stops the output from producing samples.
+  virtual void set_route(unsigned int output_index, int input_index) = 0;
+  virtual int route(unsigned int output_index) = 0;
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_CHANNEL_ROUTER_H */
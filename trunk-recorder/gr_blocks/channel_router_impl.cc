@@ -0,0 +1,94 @@
+#include "channel_router_impl.h"
+#include <gnuradio/io_signature.h>
+#include <stdexcept>
+#include <string.h>
+
+namespace gr {
+namespace blocks {
+
+channel_router::sptr
+channel_router::make(size_t itemsize) {
+  return gnuradio::get_initial_sptr(new channel_router_impl(itemsize));
+}
+
+channel_router_impl::channel_router_impl(size_t itemsize)
+    : block("channel_router",
+            io_signature::make(1, -1, itemsize),
+            io_signature::make(1, -1, itemsize)),
+      d_itemsize(itemsize),
+      d_num_inputs(0),
+      d_num_outputs(0) {
+  // Tags are copied by hand to the output each input is routed to. The default policy would
+  // put every channel's tags on every output, including the unrouted ones that never advance.
+  set_tag_propagation_policy(TPP_DONT);
+}
+
+channel_router_impl::~channel_router_impl() {}
+
+void channel_router_impl::set_route(unsigned int output_index, int input_index) {
+  gr::thread::scoped_lock l(d_mutex);
+
+  if (output_index >= d_routes.size())
+    d_routes.resize(output_index + 1, -1);
+
+  if ((d_num_inputs > 0) && (input_index >= (int)d_num_inputs))
+    throw std::out_of_range("input_index must be < ninputs");
+
+  d_routes[output_index] = input_index < 0 ? -1 : input_index;
+}
+
+int channel_router_impl::route(unsigned int output_index) {
+  gr::thread::scoped_lock l(d_mutex);
+
+  if (output_index >= d_routes.size())
+    return -1;
+
+  return d_routes[output_index];
+}
+
+void channel_router_impl::forecast(int noutput_items, gr_vector_int &ninput_items_required) {
+  unsigned ninputs = ninput_items_required.size();
+  for (unsigned i = 0; i < ninputs; i++) {
+    ninput_items_required[i] = noutput_items;
+  }
+}
+
+bool channel_router_impl::check_topology(int ninputs, int noutputs) {
+  gr::thread::scoped_lock l(d_mutex);
+
+  d_num_inputs = (unsigned int)ninputs;
+  d_num_outputs = (unsigned int)noutputs;
+  d_routes.resize(d_num_outputs, -1);
+  return true;
+}
+
+int channel_router_impl::general_work(int noutput_items,
+                                      gr_vector_int &ninput_items,
+                                      gr_vector_const_void_star &input_items,
+                                      gr_vector_void_star &output_items) {
+  const uint8_t **in = (const uint8_t **)&input_items[0];
+  uint8_t **out = (uint8_t **)&output_items[0];
+
+  gr::thread::scoped_lock l(d_mutex);
+  for (unsigned int j = 0; j < d_num_outputs; j++) {
+    int input_index = d_routes[j];
+    if (input_index < 0) {
+      continue;
+    }
+    memcpy(out[j], in[input_index], noutput_items * d_itemsize);
+
+    uint64_t read = nitems_read(input_index);
+    uint64_t written = nitems_written(j);
+    get_tags_in_range(d_tags, input_index, read, read + noutput_items);
+    for (std::vector<tag_t>::iterator it = d_tags.begin(); it != d_tags.end(); ++it) {
+      add_item_tag(j, it->offset - read + written, it->key, it->value, it->srcid);
+    }
+    produce(j, noutput_items);
+  }
+
+  consume_each(noutput_items);
+  return WORK_CALLED_PRODUCE;
+}
+
+} /* namespace blocks */
+} /* namespace gr */
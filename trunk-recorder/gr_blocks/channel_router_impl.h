@@ -0,0 +1,39 @@
+#ifndef INCLUDED_GR_CHANNEL_ROUTER_IMPL_H
+#define INCLUDED_GR_CHANNEL_ROUTER_IMPL_H
+
+#include "channel_router.h"
+#include <gnuradio/thread/thread.h>
+#include <vector>
+
+namespace gr {
+namespace blocks {
+
+class channel_router_impl : public channel_router {
+private:
+  size_t d_itemsize;
+  unsigned int d_num_inputs, d_num_outputs; // keep track of the topology
+  std::vector<int> d_routes;
+  std::vector<tag_t> d_tags;
+
+  gr::thread::mutex d_mutex;
+
+public:
+  channel_router_impl(size_t itemsize);
+  ~channel_router_impl();
+
+  void forecast(int noutput_items, gr_vector_int &ninput_items_required);
+  bool check_topology(int ninputs, int noutputs);
+
+  void set_route(unsigned int output_index, int input_index);
+  int route(unsigned int output_index);
+
+  int general_work(int noutput_items,
+                   gr_vector_int &ninput_items,
+                   gr_vector_const_void_star &input_items,
+                   gr_vector_void_star &output_items);
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_CHANNEL_ROUTER_IMPL_H */
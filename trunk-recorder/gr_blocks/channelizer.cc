@@ -0,0 +1,82 @@
+#include "channelizer.h"
+#include <boost/log/trivial.hpp>
+
+channelizer_sptr make_channelizer(double samp_rate, double spacing, int outputs) {
+  return gnuradio::get_initial_sptr(new channelizer(samp_rate, spacing, outputs));
+}
+
+bool channelizer::valid_spacing(double samp_rate, double spacing) {
+  if (spacing <= 0) {
+    return false;
+  }
+  double channels = samp_rate / spacing;
+  long num_channels = lround(channels);
+  if ((fabs(channels - num_channels) > 1e-6) || (num_channels < oversample_rate)) {
+    return false;
+  }
+  // The filterbank can only oversample by an integer fraction of the number of channels
+  return (num_channels % oversample_rate) == 0;
+}
+
+double channelizer::get_channel_rate() {
+  return spacing * oversample_rate;
+}
+
+double channelizer::get_spacing() {
+  return spacing;
+}
+
+int channelizer::get_num_channels() {
+  return num_channels;
+}
+
+// Routes the channel nearest to the requested offset to the output, and returns the
+// offset that is left over inside of that channel. The offset uses the same convention
+// as Recorder::tune_offset(), center frequency minus the channel frequency.
+double channelizer::select_channel(int output, double offset) {
+  long k = lround(-offset / spacing);
+  double residual = offset + (k * spacing);
+  int channel = ((k % num_channels) + num_channels) % num_channels;
+
+  router->set_route(output, channel);
+  return residual;
+}
+
+void channelizer::release_channel(int output) {
+  router->set_route(output, -1);
+}
+
+channelizer::~channelizer() {
+}
+
+channelizer::channelizer(double samp_rate, double spacing, int outputs)
+    : gr::hier_block2("channelizer",
+                      gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                      gr::io_signature::make(outputs, outputs, sizeof(gr_complex))) {
+
+  this->samp_rate = samp_rate;
+  this->spacing = spacing;
+  this->num_channels = lround(samp_rate / spacing);
+  this->num_outputs = outputs;
+
+  // Each channel is passed flat out to the grid spacing, so a signal that is up to
+  // half a grid step off of a channel center still fits, and the stop band starts
+  // far enough in that nothing aliases back in at the oversampled rate.
+  taps = gr::filter::firdes::low_pass_2(1.0, samp_rate, spacing * 1.25, spacing * 0.5, 60);
+
+  BOOST_LOG_TRIVIAL(info) << "\t Channelizer - Channels: " << num_channels << " Spacing: " << spacing << " Channel Rate: " << get_channel_rate() << " Taps: " << taps.size();
+
+  deinterleave = gr::blocks::stream_to_streams::make(sizeof(gr_complex), num_channels);
+  filterbank = gr::filter::pfb_channelizer_ccf::make(num_channels, taps, oversample_rate);
+  router = gr::blocks::channel_router::make(sizeof(gr_complex));
+
+  connect(self(), 0, deinterleave, 0);
+  for (int i = 0; i < num_channels; i++) {
+    connect(deinterleave, i, filterbank, i);
+    connect(filterbank, i, router, i);
+  }
+  for (int i = 0; i < num_outputs; i++) {
+    router->set_route(i, -1);
+    connect(router, i, self(), i);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef INCLUDED_GR_CHANNELIZER_H
+#define INCLUDED_GR_CHANNELIZER_H
+#include <math.h>
+
+#include <gnuradio/blocks/api.h>
+#include <gnuradio/blocks/stream_to_streams.h>
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/filter/pfb_channelizer_ccf.h>
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/io_signature.h>
+
+#include "channel_router.h"
+
+class channelizer;
+
+#if GNURADIO_VERSION < 0x030900
+typedef boost::shared_ptr<channelizer> channelizer_sptr;
+#else
+typedef std::shared_ptr<channelizer> channelizer_sptr;
+#endif
+
+channelizer_sptr make_channelizer(double samp_rate, double spacing, int outputs);
+
+/*
+ * Splits the whole Source bandwidth into a fixed grid of channels with a
+ * single polyphase filterbank, and routes the channel closest to each
+ * Recorder's frequency to that Recorder's output. The channels are
+ * oversampled so a signal that falls between two grid points still fits
+ * inside the nearest one; the Recorder removes the remaining offset itself.
+ * The grid is fixed by the spacing and the Source's center frequency, it
+ * does not come from the System's channel plan.
+ */
+class channelizer : public gr::hier_block2 {
+
+  friend channelizer_sptr make_channelizer(double samp_rate, double spacing, int outputs);
+
+  gr::blocks::stream_to_streams::sptr deinterleave;
+  gr::filter::pfb_channelizer_ccf::sptr filterbank;
+  gr::blocks::channel_router::sptr router;
+  std::vector<float> taps;
+  double samp_rate;
+  double spacing;
+  int num_channels;
+  int num_outputs;
+
+  channelizer(double samp_rate, double spacing, int outputs);
+
+public:
+  ~channelizer();
+  static const int oversample_rate = 4;
+  // How far off of a grid point, as a fraction of the spacing, a channel can be before it is reported
+  static constexpr double grid_tolerance = 0.01;
+  static bool valid_spacing(double samp_rate, double spacing);
+  double get_channel_rate();
+  double get_spacing();
+  int get_num_channels();
+  double select_channel(int output, double offset);
+  void release_channel(int output);
+};
+
+#endif
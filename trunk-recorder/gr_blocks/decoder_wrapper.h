@@ -72,6 +72,7 @@ public:
   virtual bool get_tps_enabled() { return false; }
 
   virtual void process_message_queues(void){};
+  virtual std::vector<gr::basic_block_sptr> get_blocks() { return {}; };
 };
 
 } /* namespace blocks */
@@ -71,6 +71,12 @@ bool decoder_wrapper_impl::get_fsync_enabled() { return d_signal_decoder_sink->g
 bool decoder_wrapper_impl::get_star_enabled() { return d_signal_decoder_sink->get_star_enabled(); };
 bool decoder_wrapper_impl::get_tps_enabled() { return d_tps_decoder_sink->get_enabled(); };
 
+std::vector<gr::basic_block_sptr> decoder_wrapper_impl::get_blocks() {
+  std::vector<gr::basic_block_sptr> blocks = d_tps_decoder_sink->get_blocks();
+  blocks.push_back(d_signal_decoder_sink);
+  return blocks;
+}
+
 void decoder_wrapper_impl::log_decoder_msg(long unitId, const char *signaling_type, SignalType signal) {
   if (d_callback != NULL) {
     d_callback(unitId, signaling_type, signal);
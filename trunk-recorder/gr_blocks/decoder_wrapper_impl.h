@@ -67,6 +67,7 @@ public:
 
   void log_decoder_msg(long unitId, const char *signaling_type, SignalType signal);
   void process_message_queues(void);
+  std::vector<gr::basic_block_sptr> get_blocks();
 };
 
 } /* namespace blocks */
@@ -200,6 +200,8 @@ void tps_decoder_sink_impl::set_enabled(bool b) { valve->set_enabled(b); };
 
 bool tps_decoder_sink_impl::get_enabled() { return valve->enabled(); };
 
+std::vector<gr::basic_block_sptr> tps_decoder_sink_impl::get_blocks() { return {valve, fsk4_demod, slicer, op25_frame_assembler}; };
+
 void tps_decoder_sink_impl::log_decoder_msg(long unitId, const char *signaling_type, SignalType signal) {
   if (d_callback != NULL) {
     d_callback(unitId, signaling_type, signal);
@@ -0,0 +1,74 @@
+#include "iq_file_source.h"
+#include <boost/log/trivial.hpp>
+#include <sys/stat.h>
+
+iq_file_source_sptr make_iq_file_source(std::string filename, std::string format, double samp_rate, bool real_time) {
+  return gnuradio::get_initial_sptr(new iq_file_source(filename, format, samp_rate, real_time));
+}
+
+// Returns the size of one complex sample in the file, or 0 if the format is not supported
+int iq_file_source::get_item_size(std::string format) {
+  if (format == "cf32") {
+    return sizeof(gr_complex);
+  }
+  if (format == "ci16") {
+    return 2 * sizeof(int16_t);
+  }
+  if (format == "cu8") {
+    return 2 * sizeof(uint8_t);
+  }
+  return 0;
+}
+
+uint64_t iq_file_source::get_total_items() {
+  return total_items;
+}
+
+uint64_t iq_file_source::get_items_read() {
+  return reader->nitems_written(0);
+}
+
+double iq_file_source::get_duration() {
+  return total_items / samp_rate;
+}
+
+bool iq_file_source::is_done() {
+  return get_items_read() >= total_items;
+}
+
+iq_file_source::~iq_file_source() {
+}
+
+iq_file_source::iq_file_source(std::string filename, std::string format, double samp_rate, bool real_time)
+    : gr::hier_block2("iq_file_source",
+                      gr::io_signature::make(0, 0, 0),
+                      gr::io_signature::make(1, 1, sizeof(gr_complex))) {
+
+  this->filename = filename;
+  this->samp_rate = samp_rate;
+
+  struct stat file_stat;
+  int item_size = get_item_size(format);
+  total_items = 0;
+  if ((item_size > 0) && (stat(filename.c_str(), &file_stat) == 0)) {
+    total_items = file_stat.st_size / item_size;
+  }
+
+  if (format == "cf32") {
+    reader = gr::blocks::file_source::make(sizeof(gr_complex), filename.c_str(), false);
+  } else if (format == "ci16") {
+    reader = gr::op25_repeater::iqfile_source::make(sizeof(int16_t), filename.c_str(), true);
+  } else {
+    reader = gr::op25_repeater::iqfile_source::make(sizeof(uint8_t), filename.c_str(), false);
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "IQ File: " << filename << " Format: " << format << " Length: " << get_duration() << " sec" << (real_time ? "" : " - playing back as fast as possible");
+
+  if (real_time) {
+    throttle = gr::blocks::throttle::make(sizeof(gr_complex), samp_rate);
+    connect(reader, 0, throttle, 0);
+    connect(throttle, 0, self(), 0);
+  } else {
+    connect(reader, 0, self(), 0);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef INCLUDED_GR_IQ_FILE_SOURCE_H
+#define INCLUDED_GR_IQ_FILE_SOURCE_H
+
+#include <gnuradio/blocks/file_source.h>
+#include <gnuradio/blocks/throttle.h>
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/io_signature.h>
+#include <op25_repeater/include/op25_repeater/iqfile_source.h>
+
+class iq_file_source;
+
+#if GNURADIO_VERSION < 0x030900
+typedef boost::shared_ptr<iq_file_source> iq_file_source_sptr;
+#else
+typedef std::shared_ptr<iq_file_source> iq_file_source_sptr;
+#endif
+
+iq_file_source_sptr make_iq_file_source(std::string filename, std::string format, double samp_rate, bool real_time);
+
+/*
+ * Plays back a recording of complex IQ samples in place of an SDR, so the
+ * whole pipeline can be run against the same signal again and again.
+ * The samples can be paced to the sample rate, or read as fast as the
+ * flow graph will take them. Playback stops at the end of the file.
+ *
+ * Formats: cf32 (complex float), ci16 (interleaved signed 16 bit) and
+ * cu8 (interleaved unsigned 8 bit, like rtl_sdr writes).
+ */
+class iq_file_source : public gr::hier_block2 {
+
+  friend iq_file_source_sptr make_iq_file_source(std::string filename, std::string format, double samp_rate, bool real_time);
+
+  gr::block_sptr reader;
+  gr::blocks::throttle::sptr throttle;
+  std::string filename;
+  double samp_rate;
+  uint64_t total_items;
+
+  iq_file_source(std::string filename, std::string format, double samp_rate, bool real_time);
+
+public:
+  ~iq_file_source();
+  static int get_item_size(std::string format);
+  uint64_t get_total_items();
+  uint64_t get_items_read();
+  double get_duration();
+  bool is_done();
+};
+
+#endif
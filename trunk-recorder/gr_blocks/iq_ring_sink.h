@@ -0,0 +1,50 @@
+#ifndef INCLUDED_GR_IQ_RING_SINK_H
+#define INCLUDED_GR_IQ_RING_SINK_H
+
+#include <gnuradio/blocks/api.h>
+#include <gnuradio/sync_block.h>
+#include <stdint.h>
+
+namespace gr {
+namespace blocks {
+
+/*!
+ * \brief Keeps the last few seconds of a source's IQ in memory
+ * \ingroup misc_blk
+ *
+ * \details
+ * A sink that writes every sample it is given into a circular buffer, so
+ * other threads can go back in time and read samples that arrived before
+ * they asked for them. Samples are addressed by their absolute index
+ * since the flow graph started. The buffer is mapped with huge pages
+ * when the system has them, to keep TLB misses down on large rings.
+ *
+ * There is one writer, the block's own thread, and any number of
+ * readers. A reader that falls so far behind that its samples have been
+ * overwritten is told so by read() instead of getting torn data.
+ */
+class BLOCKS_API iq_ring_sink : virtual public sync_block {
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<iq_ring_sink> sptr;
+#else
+  typedef std::shared_ptr<iq_ring_sink> sptr;
+#endif
+
+  static sptr make(double sampling_freq, double seconds);
+
+  // index of the next sample that will be written
+  virtual uint64_t head() const = 0;
+  virtual uint64_t capacity() const = 0;
+  virtual double sampling_freq() const = 0;
+  virtual bool uses_huge_pages() const = 0;
+
+  // Copies out samples [start, start + n). Returns false if any of them
+  // have not arrived yet, or were overwritten before the copy finished.
+  virtual bool read(uint64_t start, gr_complex *out, size_t n) const = 0;
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_IQ_RING_SINK_H */
@@ -0,0 +1,115 @@
+#include "iq_ring_sink_impl.h"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <gnuradio/io_signature.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+
+namespace gr {
+namespace blocks {
+
+static const size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+
+iq_ring_sink::sptr
+iq_ring_sink::make(double sampling_freq, double seconds) {
+  return gnuradio::get_initial_sptr(new iq_ring_sink_impl(sampling_freq, seconds));
+}
+
+iq_ring_sink_impl::iq_ring_sink_impl(double sampling_freq, double seconds)
+    : sync_block("iq_ring_sink",
+                 io_signature::make(1, 1, sizeof(gr_complex)),
+                 io_signature::make(0, 0, 0)),
+      d_sampling_freq(sampling_freq),
+      d_buf(NULL),
+      d_huge_pages(false),
+      d_head(0),
+      d_writing(0) {
+
+  size_t bytes = (size_t)(sampling_freq * seconds) * sizeof(gr_complex);
+  d_map_bytes = std::max(((bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES) * HUGE_PAGE_BYTES, HUGE_PAGE_BYTES);
+
+  void *buf = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  buf = mmap(NULL, d_map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  d_huge_pages = (buf != MAP_FAILED);
+#endif
+  if (buf == MAP_FAILED) {
+    buf = mmap(NULL, d_map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) {
+      throw std::runtime_error("iq_ring_sink: unable to map the IQ ring");
+    }
+#ifdef MADV_HUGEPAGE
+    // no reserved huge pages, so let transparent huge pages back it if they can
+    madvise(buf, d_map_bytes, MADV_HUGEPAGE);
+#endif
+  }
+
+  d_buf = (gr_complex *)buf;
+  d_capacity = d_map_bytes / sizeof(gr_complex);
+
+  BOOST_LOG_TRIVIAL(info) << "IQ Ring: " << (double)d_capacity / sampling_freq << " seconds, " << d_map_bytes / (1024 * 1024) << " MB" << (d_huge_pages ? " in huge pages" : "");
+}
+
+iq_ring_sink_impl::~iq_ring_sink_impl() {
+  if (d_buf) {
+    munmap(d_buf, d_map_bytes);
+  }
+}
+
+uint64_t iq_ring_sink_impl::head() const {
+  return d_head.load(std::memory_order_acquire);
+}
+
+uint64_t iq_ring_sink_impl::capacity() const {
+  return d_capacity;
+}
+
+double iq_ring_sink_impl::sampling_freq() const {
+  return d_sampling_freq;
+}
+
+bool iq_ring_sink_impl::uses_huge_pages() const {
+  return d_huge_pages;
+}
+
+bool iq_ring_sink_impl::read(uint64_t start, gr_complex *out, size_t n) const {
+  if ((n > d_capacity) || (start + n > d_head.load(std::memory_order_acquire))) {
+    return false;
+  }
+
+  size_t pos = start % d_capacity;
+  size_t first = std::min((size_t)(d_capacity - pos), n);
+  memcpy(out, d_buf + pos, first * sizeof(gr_complex));
+  memcpy(out + first, d_buf, (n - first) * sizeof(gr_complex));
+
+  // if the writer had started on any of these slots, the copy can't be trusted
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return start + d_capacity >= d_writing.load(std::memory_order_relaxed);
+}
+
+int iq_ring_sink_impl::work(int noutput_items,
+                            gr_vector_const_void_star &input_items,
+                            gr_vector_void_star &output_items) {
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  uint64_t head = d_head.load(std::memory_order_relaxed);
+  size_t n = std::min((uint64_t)noutput_items, d_capacity);
+
+  in += noutput_items - n;
+  head += noutput_items - n;
+
+  d_writing.store(head + n, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size_t pos = head % d_capacity;
+  size_t first = std::min((size_t)(d_capacity - pos), n);
+  memcpy(d_buf + pos, in, first * sizeof(gr_complex));
+  memcpy(d_buf, in + first, (n - first) * sizeof(gr_complex));
+
+  d_head.store(head + n, std::memory_order_release);
+
+  return noutput_items;
+}
+
+} /* namespace blocks */
+} /* namespace gr */
@@ -0,0 +1,41 @@
+#ifndef INCLUDED_GR_IQ_RING_SINK_IMPL_H
+#define INCLUDED_GR_IQ_RING_SINK_IMPL_H
+
+#include "iq_ring_sink.h"
+#include <atomic>
+
+namespace gr {
+namespace blocks {
+
+class iq_ring_sink_impl : public iq_ring_sink {
+private:
+  double d_sampling_freq;
+  gr_complex *d_buf;
+  size_t d_map_bytes;
+  uint64_t d_capacity;
+  bool d_huge_pages;
+
+  // d_writing is moved past a region before it is overwritten, and
+  // d_head once the new samples are in place.
+  std::atomic<uint64_t> d_head;
+  std::atomic<uint64_t> d_writing;
+
+public:
+  iq_ring_sink_impl(double sampling_freq, double seconds);
+  ~iq_ring_sink_impl();
+
+  uint64_t head() const;
+  uint64_t capacity() const;
+  double sampling_freq() const;
+  bool uses_huge_pages() const;
+  bool read(uint64_t start, gr_complex *out, size_t n) const;
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_IQ_RING_SINK_IMPL_H */
@@ -27,12 +27,14 @@
 #include <boost/math/special_functions/round.hpp>
 #include <climits>
 #include <cmath>
+#include <cerrno>
 #include <cstring>
 #include <fcntl.h>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/thread/thread.h>
 #include <stdexcept>
 #include <stdio.h>
+#include <unistd.h>
 
 // win32 (mingw/msvc) specific
 #ifdef HAVE_IO_H
@@ -65,6 +67,9 @@ transmission_sink::transmission_sink(int n_channels, unsigned int sample_rate, i
       d_sample_rate(sample_rate),
       d_nchans(n_channels),
       d_current_call(NULL),
+      d_preallocate_seconds(0),
+      d_flush_seconds(0),
+      d_flushed_sample_count(0),
       d_fp(0) {
 
   if ((bits_per_sample != 8) && (bits_per_sample != 16)) {
@@ -186,6 +191,18 @@ bool transmission_sink::open_internal(const char *filename) {
     fprintf(stderr, "[%s] could not write to WAV file\n", __FILE__);
     return false;
   }
+  d_flushed_sample_count = 0;
+
+#ifdef __linux__
+  // Reserving the space up front keeps the files of many recorders writing at
+  // the same time from getting fragmented. close_wav() trims off what is left.
+  if (d_preallocate_seconds > 0) {
+    off_t length = 44 + (off_t)d_preallocate_seconds * d_sample_rate * d_nchans * d_bytes_per_sample;
+    if (fallocate(fd, 0, 0, length) != 0) {
+      BOOST_LOG_TRIVIAL(debug) << "wav preallocate failed: " << strerror(errno);
+    }
+  }
+#endif
 
   if (d_bytes_per_sample == 1) {
     d_max_sample_val = UCHAR_MAX;
@@ -278,6 +295,12 @@ void transmission_sink::stop_recording() {
 void transmission_sink::close_wav(bool close_call) {
   unsigned int byte_count = d_sample_count * d_bytes_per_sample;
   wavheader_complete(d_fp, byte_count);
+  if (d_preallocate_seconds > 0) {
+    fflush(d_fp);
+    if (ftruncate(fileno(d_fp), 44 + byte_count) != 0) {
+      BOOST_LOG_TRIVIAL(error) << "wav trimming preallocated space failed: " << current_filename << " " << strerror(errno);
+    }
+  }
   fclose(d_fp);
   d_fp = NULL;
 }
@@ -447,7 +470,6 @@ std::vector<Transmission> transmission_sink::get_transmission_list() {
 int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
   // block
   int n_in_chans = input_items.size();
-  int16_t sample_buf_s;
   int nwritten = 0;
 
   if (state == STOPPED) {
@@ -525,21 +547,15 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
   }
 
   if (state == RECORDING) {
-    for (nwritten = 0; nwritten < noutput_items; nwritten++) {
-      for (int chan = 0; chan < d_nchans; chan++) {
-        // Write zeros to channels which are in the WAV file
-        // but don't have any inputs here
-        if (chan < n_in_chans) {
-          int16_t **in = (int16_t **)&input_items[0];
-          sample_buf_s = in[chan][nwritten];
-        } else {
-          sample_buf_s = 0;
-        }
-
-        wav_write_sample(d_fp, sample_buf_s, d_bytes_per_sample);
+    // Channels which are in the WAV file but don't have any inputs here get zeros
+    if (wav_write_samples(d_fp, (const int16_t *const *)&input_items[0], n_in_chans, d_nchans, noutput_items, d_bytes_per_sample, d_write_buf)) {
+      nwritten = noutput_items;
+      d_sample_count += noutput_items * d_nchans;
+    }
 
-        d_sample_count++;
-      }
+    if ((d_flush_seconds > 0) && (d_sample_count - d_flushed_sample_count >= (unsigned)d_flush_seconds * d_sample_rate * d_nchans)) {
+      fflush(d_fp);
+      d_flushed_sample_count = d_sample_count;
     }
   }
 
@@ -562,6 +578,16 @@ void transmission_sink::set_bits_per_sample(int bits_per_sample) {
   }
 }
 
+// preallocate_seconds of audio is reserved on disk when each file is opened,
+// and the file is flushed every flush_seconds of audio instead of only when
+// its buffer fills up. 0 turns either one off.
+void transmission_sink::set_write_policy(int preallocate_seconds, int flush_seconds) {
+  gr::thread::scoped_lock guard(d_mutex);
+
+  d_preallocate_seconds = preallocate_seconds;
+  d_flush_seconds = flush_seconds;
+}
+
 void transmission_sink::set_sample_rate(unsigned int sample_rate) {
   gr::thread::scoped_lock guard(d_mutex);
 
@@ -67,6 +67,10 @@ private:
   long d_current_call_talkgroup;
   long d_current_call_talkgroup_encoded;
   std::string d_current_call_talkgroup_display;
+  int d_preallocate_seconds;
+  int d_flush_seconds;
+  unsigned d_flushed_sample_count;
+  std::vector<unsigned char> d_write_buf;
 
 protected:
   unsigned d_sample_count;
@@ -127,6 +131,7 @@ public:
   void set_source(long src);
   void set_sample_rate(unsigned int sample_rate);
   void set_bits_per_sample(int bits_per_sample);
+  void set_write_policy(int preallocate_seconds, int flush_seconds);
   void clear_transmission_list();
   std::vector<Transmission> get_transmission_list();
   void add_transmission(Transmission t);
@@ -229,6 +229,41 @@ void wav_write_sample(FILE *fp, short int sample, int bytes_per_sample) {
   fwrite(data_ptr, 1, bytes_per_sample, fp);
 }
 
+bool wav_write_samples(FILE *fp, const int16_t *const *in, int n_in_chans, int nchans, int nsamples, int bytes_per_sample, std::vector<unsigned char> &buf) {
+  size_t byte_count = (size_t)nsamples * nchans * bytes_per_sample;
+  if (buf.size() < byte_count) {
+    buf.resize(byte_count);
+  }
+
+  if (bytes_per_sample == 1) {
+    unsigned char *out = buf.data();
+    for (int i = 0; i < nsamples; i++) {
+      for (int chan = 0; chan < nchans; chan++) {
+        *out++ = (chan < n_in_chans) ? (unsigned char)in[chan][i] : 0;
+      }
+    }
+  } else {
+    int16_t *out = (int16_t *)buf.data();
+    if ((nchans == 1) && (n_in_chans == 1)) {
+#ifdef GR_IS_BIG_ENDIAN
+      for (int i = 0; i < nsamples; i++) {
+        out[i] = host_to_wav(in[0][i]);
+      }
+#else
+      memcpy(out, in[0], nsamples * sizeof(int16_t));
+#endif
+    } else {
+      for (int i = 0; i < nsamples; i++) {
+        for (int chan = 0; chan < nchans; chan++) {
+          *out++ = (chan < n_in_chans) ? host_to_wav(in[chan][i]) : 0;
+        }
+      }
+    }
+  }
+
+  return fwrite(buf.data(), 1, byte_count, fp) == byte_count;
+}
+
 bool wavheader_complete(FILE *fp, unsigned int byte_count) {
   uint32_t chunk_size = (uint32_t)byte_count;
   chunk_size = host_to_wav(chunk_size);
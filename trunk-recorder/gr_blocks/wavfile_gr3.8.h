@@ -27,6 +27,8 @@
 #define _GR_WAVFILE_GR_3_8_H_
 
 #include <cstdio>
+#include <stdint.h>
+#include <vector>
 #include <gnuradio/blocks/api.h>
 
 namespace gr {
@@ -80,6 +82,18 @@ wavheader_write(FILE *fp, unsigned int sample_rate, int nchans, int bytes_per_sa
  */
 BLOCKS_API void wav_write_sample(FILE *fp, short int sample, int bytes_per_sample);
 
+/*!
+ * \brief Write a whole block of samples to an open WAV file with one fwrite().
+ *
+ * \details
+ * Interleaves the channels, fills channels past n_in_chans with zeros and
+ * takes care of endianness. buf is scratch space that is grown as needed
+ * and can be reused between calls.
+ *
+ * \return False if not every byte could be written.
+ */
+BLOCKS_API bool wav_write_samples(FILE *fp, const int16_t *const *in, int n_in_chans, int nchans, int nsamples, int bytes_per_sample, std::vector<unsigned char> &buf);
+
 /*!
  * \brief Complete a WAV header
  *
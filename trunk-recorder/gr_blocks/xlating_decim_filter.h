@@ -0,0 +1,42 @@
+#ifndef INCLUDED_GR_XLATING_DECIM_FILTER_H
+#define INCLUDED_GR_XLATING_DECIM_FILTER_H
+
+#include <gnuradio/blocks/api.h>
+#include <gnuradio/sync_decimator.h>
+#include <vector>
+
+namespace gr {
+namespace blocks {
+
+/*!
+ * \brief Frequency translating, decimating low pass filter
+ * \ingroup filter_blk
+ *
+ * \details
+ * Moves the signal at center_freq down to 0 Hz, low pass filters it
+ * with a real prototype and decimates, all in one pass over the input.
+ * The mix is folded into the filter by rotating the taps up to
+ * center_freq, so the only per-sample work left is the filter itself.
+ * The small residual rotation is applied at the decimated rate.
+ *
+ * Short filters compared to the decimation are run directly, with only
+ * the kept outputs being computed. Long ones go through an FFT kernel.
+ */
+class BLOCKS_API xlating_decim_filter : virtual public sync_decimator {
+public:
+#if GNURADIO_VERSION < 0x030900
+  typedef boost::shared_ptr<xlating_decim_filter> sptr;
+#else
+  typedef std::shared_ptr<xlating_decim_filter> sptr;
+#endif
+
+  static sptr make(int decimation, const std::vector<float> &taps, double center_freq, double sampling_freq);
+
+  virtual void set_center_freq(double center_freq) = 0;
+  virtual double center_freq() const = 0;
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_XLATING_DECIM_FILTER_H */
@@ -0,0 +1,113 @@
+#include "xlating_decim_filter_impl.h"
+#include <gnuradio/io_signature.h>
+#include <math.h>
+#include <volk/volk.h>
+
+namespace gr {
+namespace blocks {
+
+// Above this many taps per input sample dropped, the FFT kernel is cheaper
+// than computing each kept output as a dot product.
+static const unsigned int MAX_DIRECT_TAPS_PER_DECIM = 8;
+
+xlating_decim_filter::sptr
+xlating_decim_filter::make(int decimation, const std::vector<float> &taps, double center_freq, double sampling_freq) {
+  return gnuradio::get_initial_sptr(new xlating_decim_filter_impl(decimation, taps, center_freq, sampling_freq));
+}
+
+xlating_decim_filter_impl::xlating_decim_filter_impl(int decimation, const std::vector<float> &taps, double center_freq, double sampling_freq)
+    : sync_decimator("xlating_decim_filter",
+                     io_signature::make(1, 1, sizeof(gr_complex)),
+                     io_signature::make(1, 1, sizeof(gr_complex)),
+                     decimation),
+      d_decim(decimation),
+      d_proto_taps(taps),
+      d_center_freq(center_freq),
+      d_sampling_freq(sampling_freq),
+      d_updated(false),
+      d_taps(NULL),
+      d_ntaps(taps.size()) {
+
+  d_use_fft = d_ntaps > MAX_DIRECT_TAPS_PER_DECIM * (unsigned int)d_decim;
+
+  if (d_use_fft) {
+    d_fft_filter.reset(new gr::filter::kernel::fft_filter_ccc(d_decim, std::vector<gr_complex>(d_ntaps, 0)));
+  } else {
+    d_taps = (gr_complex *)volk_malloc(d_ntaps * sizeof(gr_complex), volk_get_alignment());
+    set_history(d_ntaps);
+  }
+
+  build_taps();
+}
+
+xlating_decim_filter_impl::~xlating_decim_filter_impl() {
+  if (d_taps) {
+    volk_free(d_taps);
+  }
+}
+
+void xlating_decim_filter_impl::build_taps() {
+  // bandpass taps centered on the channel: h[k] * e^(j w k)
+  double phase_inc = (2.0 * M_PI * d_center_freq) / d_sampling_freq;
+  std::vector<gr_complex> rtaps(d_ntaps);
+
+  for (unsigned int k = 0; k < d_ntaps; k++) {
+    rtaps[k] = d_proto_taps[k] * gr_complex(cos(phase_inc * k), sin(phase_inc * k));
+  }
+
+  if (d_use_fft) {
+    int nsamples = d_fft_filter->set_taps(rtaps);
+    set_output_multiple(nsamples);
+  } else {
+    for (unsigned int k = 0; k < d_ntaps; k++) {
+      d_taps[k] = rtaps[d_ntaps - 1 - k];
+    }
+  }
+
+  // what is left of the mix is a rotation of d_decim * w per output sample
+  double out_phase_inc = -phase_inc * d_decim;
+  d_r.set_phase_incr(gr_complex(cos(out_phase_inc), sin(out_phase_inc)));
+}
+
+void xlating_decim_filter_impl::set_center_freq(double center_freq) {
+  gr::thread::scoped_lock l(d_mutex);
+  d_center_freq = center_freq;
+  d_updated = true;
+}
+
+double xlating_decim_filter_impl::center_freq() const {
+  return d_center_freq;
+}
+
+int xlating_decim_filter_impl::work(int noutput_items,
+                                    gr_vector_const_void_star &input_items,
+                                    gr_vector_void_star &output_items) {
+  const gr_complex *in = (const gr_complex *)input_items[0];
+  gr_complex *out = (gr_complex *)output_items[0];
+
+  gr::thread::scoped_lock l(d_mutex);
+
+  if (d_updated) {
+    d_updated = false;
+    build_taps();
+    if (d_use_fft) {
+      // the output multiple may have changed along with the taps
+      return 0;
+    }
+  }
+
+  if (d_use_fft) {
+    d_fft_filter->filter(noutput_items, in, out);
+  } else {
+    for (int i = 0; i < noutput_items; i++) {
+      volk_32fc_x2_dot_prod_32fc(&out[i], &in[i * d_decim], d_taps, d_ntaps);
+    }
+  }
+
+  d_r.rotateN(out, out, noutput_items);
+
+  return noutput_items;
+}
+
+} /* namespace blocks */
+} /* namespace gr */
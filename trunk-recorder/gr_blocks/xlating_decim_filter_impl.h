@@ -0,0 +1,50 @@
+#ifndef INCLUDED_GR_XLATING_DECIM_FILTER_IMPL_H
+#define INCLUDED_GR_XLATING_DECIM_FILTER_IMPL_H
+
+#include "xlating_decim_filter.h"
+#include <gnuradio/blocks/rotator.h>
+#include <gnuradio/filter/fft_filter.h>
+#include <gnuradio/thread/thread.h>
+#include <memory>
+#include <vector>
+
+namespace gr {
+namespace blocks {
+
+class xlating_decim_filter_impl : public xlating_decim_filter {
+private:
+  int d_decim;
+  std::vector<float> d_proto_taps;
+  double d_center_freq;
+  double d_sampling_freq;
+  bool d_updated;
+  bool d_use_fft;
+
+  // direct kernel: rotated taps, reversed so they line up with the input
+  gr_complex *d_taps;
+  unsigned int d_ntaps;
+
+  // FFT kernel for filters that are long compared to the decimation
+  std::unique_ptr<gr::filter::kernel::fft_filter_ccc> d_fft_filter;
+
+  gr::blocks::rotator d_r;
+  gr::thread::mutex d_mutex;
+
+  void build_taps();
+
+public:
+  xlating_decim_filter_impl(int decimation, const std::vector<float> &taps, double center_freq, double sampling_freq);
+  ~xlating_decim_filter_impl();
+
+  void set_center_freq(double center_freq);
+  double center_freq() const;
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items);
+};
+
+} /* namespace blocks */
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_XLATING_DECIM_FILTER_IMPL_H */
@@ -19,17 +19,28 @@
 #include <boost/log/utility/setup/file.hpp>
 #include <boost/tokenizer.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <exception>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <pthread.h>
 #include <signal.h>
 #include <sstream>
+#include <stdexcept>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <sys/resource.h>
 #include <sys/time.h>
+#include <thread>
 #include <time.h>
 #include <unistd.h>
 #include <utility>
@@ -45,6 +56,7 @@
 
 #include "call.h"
 #include "call_conventional.h"
+#include "call_table.h"
 #include "systems/p25_parser.h"
 #include "systems/p25_trunking.h"
 #include "systems/parser.h"
@@ -56,6 +68,7 @@
 #include <osmosdr/source.h>
 
 #include "formatter.h"
+#include <gnuradio/block_detail.h>
 #include <gnuradio/blocks/file_sink.h>
 #include <gnuradio/gr_complex.h>
 #include <gnuradio/message.h>
@@ -64,6 +77,8 @@
 
 #include "plugin_manager/plugin_manager.h"
 
+#include <vocoder_service.h>
+
 #include "cmake.h"
 #include "git.h"
 
@@ -77,21 +92,85 @@ std::vector<Source *> sources;
 std::vector<System *> systems;
 std::map<long, long> unit_affiliations;
 
-std::vector<Call *> calls;
+Call_Table calls;
 
 gr::top_block_sptr tb;
 
 volatile sig_atomic_t exit_flag = 0;
+volatile sig_atomic_t reload_flag = 0;
 int exit_code = EXIT_SUCCESS;
 SmartnetParser *smartnet_parser;
 P25Parser *p25_parser;
 Config config;
 
+// CPU time used by the process while none of the trunk Recorders were active
+double idle_cpu_seconds = 0;
+double idle_wall_seconds = 0;
+double idle_recorder_cpu_seconds = 0;
+double last_cpu_sample = -1;
+double last_recorder_cpu_sample = 0;
+double last_wall_sample = 0;
+bool last_sample_idle = false;
+double last_status_cpu = -1;
+double last_status_wall = 0;
+
+// Control channel messages are pulled off each System's msg_queue by a pump thread and handed to
+// the main loop, so a grant is handled as soon as it has been decoded instead of on the next poll
+struct Trunk_Queue_Entry {
+  System_impl *system;
+  gr::message::sptr msg;
+  std::chrono::steady_clock::time_point received;
+};
+
+std::deque<Trunk_Queue_Entry> trunk_queue;
+std::mutex trunk_queue_mutex;
+std::condition_variable trunk_queue_cv;
+std::vector<std::thread> pump_threads;
+std::atomic<bool> pumps_stopping(false);
+
+// Guards the Calls and the Recorders while the main loop or a System thread is working on them.
+// With systemThreads each pump thread parses its own messages and only takes this to handle them.
+// Handling is not per System: grants touch the shared Calls and Recorders, and the plugin callbacks
+// made for every message are not thread safe, so a System that is slow to handle still holds up the rest.
+std::mutex trunk_mutex;
+
+// The conventional decoders and the plugins that override poll_one() still have to be polled.
+// Without them the main loop only wakes for messages and the one second timer.
+const std::chrono::milliseconds poll_interval(50);
+
+// Grant received to Recorder started latency, the bucket bounds are in microseconds
+const long grant_latency_bounds[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000};
+const int grant_latency_bucket_count = sizeof(grant_latency_bounds) / sizeof(grant_latency_bounds[0]) + 1;
+long grant_latency_buckets[grant_latency_bucket_count] = {0};
+long grant_latency_count = 0;
+long grant_latency_max = 0;
+std::chrono::steady_clock::time_point current_message_received;
+
+// Totals for the run, reported when the playback of an IQ file has finished
+long grants_decoded = 0;
+long calls_recorded = 0;
+double run_start_wall = 0;
+double run_start_cpu = 0;
+double replay_done_wall = 0;
+
+// A SIGHUP reads the Talkgroup and Unit Tag files again on their own thread. The main loop swaps
+// the new ones in, so the flow graph and the Recorders keep running through a reload.
+struct Tag_Reload {
+  System *system;
+  Talkgroups_Snapshot talkgroups;
+  Unit_Tags_Snapshot unit_tags;
+};
+
+std::future<std::vector<Tag_Reload>> tag_reload;
 
 void exit_interupt(int sig) { // can be called asynchronously
   exit_flag = 1;              // set flag
 }
 
+void reload_interupt(int sig) {
+  reload_flag = 1;
+}
+
 unsigned GCD(unsigned u, unsigned v) {
   while (v != 0) {
     unsigned r = u % v;
@@ -104,7 +183,7 @@ unsigned GCD(unsigned u, unsigned v) {
 int get_total_recorders() {
   int total_recorders = 0;
 
-  for (vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
+  for (Call_Table::const_iterator it = calls.begin(); it != calls.end(); it++) {
     Call *call = *it;
 
     if (call->get_state() == RECORDING) {
@@ -130,7 +209,7 @@ void process_signal(long unitId, const char *signaling_type, gr::blocks::SignalT
 }
 
 bool start_recorder(Call *call, TrunkMessage message, System *sys) {
-  Talkgroup *talkgroup = sys->find_talkgroup(call->get_talkgroup());
+  std::shared_ptr<const Talkgroup> talkgroup = sys->find_talkgroup(call->get_talkgroup());
 
   bool source_found = false;
   bool recorder_found = false;
@@ -185,10 +264,10 @@ bool start_recorder(Call *call, TrunkMessage message, System *sys) {
           }
         }
         if (talkgroup->mode.compare("A") == 0) {
-          recorder = source->get_analog_recorder(talkgroup, priority, call);
+          recorder = source->get_analog_recorder(talkgroup.get(), priority, call);
           call->set_is_analog(true);
         } else {
-          recorder = source->get_digital_recorder(talkgroup, priority, call);
+          recorder = source->get_digital_recorder(talkgroup.get(), priority, call);
         }
       } else {
         BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "]\t\033[0;34m" << call->get_call_num() << "C\033[0m\tTG: " << call->get_talkgroup_display() << "\tFreq: " << format_freq(call->get_freq()) << "\tTG not in Talkgroup File ";
@@ -267,6 +346,17 @@ bool start_recorder(Call *call, TrunkMessage message, System *sys) {
   return false;
 }
 
+bool has_conventional_recorders() {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System_impl *sys = (System_impl *)*it;
+
+    if (!sys->conventional_recorders.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 // This is to handle the messages that come off the Analog recorder.
 void process_message_queues() {
   for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
@@ -326,10 +416,145 @@ void manage_conventional_call(Call *call) {
   }
 }
 
+double get_cpu_seconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + ((usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0);
+}
+
+double get_wall_seconds() {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return now.tv_sec + (now.tv_usec / 1000000.0);
+}
+
+int get_trunk_recorder_count(bool active_only) {
+  int count = 0;
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    Source *source = *it;
+    std::vector<Recorder *> recorders = source->get_recorders();
+    for (vector<Recorder *>::iterator rec_it = recorders.begin(); rec_it != recorders.end(); rec_it++) {
+      Recorder *recorder = *rec_it;
+      if ((recorder->get_type() != P25) && (recorder->get_type() != ANALOG)) {
+        continue;
+      }
+      if (!active_only || recorder->is_active()) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+// CPU time used by the threads of the trunk Recorders' blocks. The thread per block scheduler
+// gives every block its own thread, which does not change once the flowgraph has been started
+double get_recorder_cpu_seconds() {
+  double seconds = 0;
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    Source *source = *it;
+    std::vector<Recorder *> recorders = source->get_recorders();
+    for (vector<Recorder *>::iterator rec_it = recorders.begin(); rec_it != recorders.end(); rec_it++) {
+      Recorder *recorder = *rec_it;
+      if ((recorder->get_type() != P25) && (recorder->get_type() != ANALOG)) {
+        continue;
+      }
+      std::vector<gr::basic_block_sptr> blocks = recorder->get_blocks();
+      for (std::vector<gr::basic_block_sptr>::iterator block_it = blocks.begin(); block_it != blocks.end(); block_it++) {
+        gr::block_sptr block = gr::cast_to_block_sptr(*block_it);
+        if (!block || !block->detail() || !block->detail()->threaded) {
+          continue;
+        }
+        clockid_t clock;
+        struct timespec ts;
+        if ((pthread_getcpuclockid(block->detail()->thread, &clock) == 0) && (clock_gettime(clock, &ts) == 0)) {
+          seconds += ts.tv_sec + (ts.tv_nsec / 1000000000.0);
+        }
+      }
+    }
+  }
+  return seconds;
+}
+
+// Called once a second. CPU time is only counted as idle when no trunk Recorders were active
+// at the start or the end of the second, so the idle cost can be compared with the number of Recorders
+void sample_cpu_usage() {
+  double cpu = get_cpu_seconds();
+  double wall = get_wall_seconds();
+  double recorder_cpu = get_recorder_cpu_seconds();
+  bool idle = (get_trunk_recorder_count(true) == 0);
+
+  if ((last_cpu_sample >= 0) && idle && last_sample_idle) {
+    idle_cpu_seconds += cpu - last_cpu_sample;
+    idle_wall_seconds += wall - last_wall_sample;
+    idle_recorder_cpu_seconds += recorder_cpu - last_recorder_cpu_sample;
+  }
+  last_cpu_sample = cpu;
+  last_recorder_cpu_sample = recorder_cpu;
+  last_wall_sample = wall;
+  last_sample_idle = idle;
+}
+
+void print_cpu_usage() {
+  double cpu = get_cpu_seconds();
+  double wall = get_wall_seconds();
+
+  if ((last_status_cpu >= 0) && (wall > last_status_wall)) {
+    BOOST_LOG_TRIVIAL(info) << "CPU Usage: " << std::fixed << std::setprecision(1) << (100.0 * (cpu - last_status_cpu) / (wall - last_status_wall)) << "%";
+  }
+  last_status_cpu = cpu;
+  last_status_wall = wall;
+
+  int recorder_count = get_trunk_recorder_count(false);
+  if ((idle_wall_seconds > 0) && (recorder_count > 0)) {
+    double idle_usage = 100.0 * idle_cpu_seconds / idle_wall_seconds;
+    double recorder_usage = 100.0 * idle_recorder_cpu_seconds / idle_wall_seconds;
+    // The process figure includes the control channels and SDRs, the Recorders' figure is only the
+    // threads running their blocks, which is what the recorderPool saves
+    BOOST_LOG_TRIVIAL(info) << "Idle CPU Usage: " << std::fixed << std::setprecision(1) << idle_usage << "% process over " << (int)idle_wall_seconds << " sec, " << recorder_usage << "% for the threads of " << recorder_count << " Recorders, " << std::setprecision(2) << (recorder_usage / recorder_count) << "% per Recorder";
+  }
+  idle_cpu_seconds = 0;
+  idle_wall_seconds = 0;
+  idle_recorder_cpu_seconds = 0;
+}
+
+void record_grant_latency() {
+  long latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - current_message_received).count();
+  int bucket = 0;
+
+  while ((bucket < grant_latency_bucket_count - 1) && (latency > grant_latency_bounds[bucket])) {
+    bucket++;
+  }
+  grant_latency_buckets[bucket]++;
+  grant_latency_count++;
+  if (latency > grant_latency_max) {
+    grant_latency_max = latency;
+  }
+}
+
+void print_grant_latency() {
+  if (grant_latency_count == 0) {
+    return;
+  }
+
+  std::stringstream histogram;
+  for (int i = 0; i < grant_latency_bucket_count; i++) {
+    if (i < grant_latency_bucket_count - 1) {
+      histogram << " <=" << (grant_latency_bounds[i] / 1000.0) << "ms: " << grant_latency_buckets[i];
+    } else {
+      histogram << " >" << (grant_latency_bounds[i - 1] / 1000.0) << "ms: " << grant_latency_buckets[i];
+    }
+    grant_latency_buckets[i] = 0;
+  }
+  BOOST_LOG_TRIVIAL(info) << "Grant to Recorder Start Latency: " << grant_latency_count << " grants, max " << std::fixed << std::setprecision(2) << (grant_latency_max / 1000.0) << "ms";
+  BOOST_LOG_TRIVIAL(info) << "\t" << histogram.str();
+  grant_latency_count = 0;
+  grant_latency_max = 0;
+}
+
 void print_status() {
   BOOST_LOG_TRIVIAL(info) << "Currently Active Calls: " << calls.size();
 
-  for (vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
+  for (Call_Table::const_iterator it = calls.begin(); it != calls.end(); it++) {
     Call *call = *it;
     Recorder *recorder = call->get_recorder();
 
@@ -359,25 +584,74 @@ void print_status() {
       BOOST_LOG_TRIVIAL(info) << "[" << sys->get_short_name() << "] " << sys->get_decode_rate() << " msg/sec";
     }
   }
+
+  print_cpu_usage();
+  print_grant_latency();
+  Call_Concluder::print_stats();
+}
+
+void print_replay_stats() {
+  double wall = get_wall_seconds() - run_start_wall;
+  double cpu = get_cpu_seconds() - run_start_cpu;
+  double iq_duration = 0;
+
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    Source *source = *it;
+    if (source->get_iq_file()) {
+      iq_duration = std::max(iq_duration, source->get_iq_file()->get_duration());
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "IQ File Playback Finished";
+  BOOST_LOG_TRIVIAL(info) << "\tGrants Decoded: " << grants_decoded << " Calls Recorded: " << calls_recorded;
+  if (wall > 0) {
+    BOOST_LOG_TRIVIAL(info) << "\t" << std::fixed << std::setprecision(1) << iq_duration << " sec of IQ in " << wall << " sec, " << std::setprecision(2) << (iq_duration / wall) << "x real time, CPU Usage: " << std::setprecision(1) << (100.0 * cpu / wall) << "%";
+  }
+}
+
+// Once every IQ file has been played back, the flow graph gets a second to drain before exiting
+void check_replay_sources() {
+  bool replaying = false;
+
+  for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
+    Source *source = *it;
+    if (source->get_iq_file()) {
+      replaying = true;
+      if (!source->get_iq_file()->is_done()) {
+        return;
+      }
+    }
+  }
+
+  if (!replaying) {
+    return;
+  }
+
+  if (replay_done_wall == 0) {
+    replay_done_wall = get_wall_seconds();
+    return;
+  }
+
+  print_replay_stats();
+  exit_flag = 1;
 }
 
 void manage_calls() {
-  bool ended_call = false;
-  for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
-    Call *call = *it;
+  // Removing a Call moves the last one into its place, so i only moves on when the Call is kept
+  for (size_t i = 0; i < calls.size();) {
+    Call *call = calls[i];
     State state = call->get_state();
     // Handle Conventional Calls
     if (call->is_conventional()) {
       manage_conventional_call(call);
-      ++it;
+      ++i;
       continue;
     }
 
     // Handle Trunked Calls
 
     if ((state == MONITORING) && (call->since_last_update() > config.call_timeout)) {
-      ended_call = true;
-      it = calls.erase(it);
+      calls.remove(call);
       delete call;
       continue;
     }
@@ -392,11 +666,10 @@ void manage_calls() {
         BOOST_LOG_TRIVIAL(trace) << "[" << call->get_short_name() << "]\t\033[0;34m" << call->get_call_num() << "C\033[0m\tTG: " << call->get_talkgroup_display() << "\tFreq: " << format_freq(call->get_freq()) << "\t\u001b[36m Stopping Call because of Recorder \u001b[0m Rec last write: " << recorder->since_last_write() << " State: " << format_state(recorder->get_state());
         call->conclude_call();
         // The State of the Recorders has changed, so lets send an update
-        ended_call = true;
         if (recorder != NULL) {
           plugman_setup_recorder(recorder);
         }
-        it = calls.erase(it);
+        calls.remove(call);
         delete call;
         continue;
       }
@@ -405,12 +678,10 @@ void manage_calls() {
 
       BOOST_LOG_TRIVIAL(trace) << "[" << call->get_short_name() << "]\t\033[0;34m" << call->get_call_num() << "C\033[0m\tTG: " << call->get_talkgroup_display() << "\tFreq: " << format_freq(call->get_freq()) << "\t\u001b[36m  Call UPDATEs has been inactive for more than " << config.call_timeout << " Sec \u001b[0m Rec last write: " << recorder->since_last_write() << " State: " << format_state(recorder->get_state());
     }
-    ++it;
+    ++i;
   } // foreach loggers
 
-  if (ended_call) {
-    plugman_calls_active(calls);
-  }
+  plugman_calls_active(calls.get_calls());
 }
 
 void current_system_status(TrunkMessage message, System *sys) {
@@ -461,6 +732,10 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
   bool superseding_grant = false;
   bool recording_started [[maybe_unused]] = false;
 
+  if (grant_message) {
+    grants_decoded++;
+  }
+
   Call *original_call;
 
   /* Notes: it is possible for 2 Calls to exist for the same talkgroup on different freq. This happens when a Talkgroup starts on a freq
@@ -477,64 +752,63 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
   unsigned long call_rfss_site = 0;
   unsigned long sys_rfss_site = 0;
 
-  Talkgroup *message_talkgroup = sys->find_talkgroup(message.talkgroup);
+  std::shared_ptr<const Talkgroup> message_talkgroup = sys->find_talkgroup(message.talkgroup);
   if (message_talkgroup) {
     message_preferredNAC = message_talkgroup->get_preferredNAC();
   }
 
-  for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
+  /* This is for Multi-Site support */
+  // Find candidate duplicate calls with the same talkgroup and different multisite-enabled systems
+  const std::vector<Call *> &talkgroup_calls = calls.find_talkgroup(message.talkgroup);
+  for (vector<Call *>::const_iterator it = talkgroup_calls.begin(); it != talkgroup_calls.end(); it++) {
     Call *call = *it;
 
-    /* This is for Multi-Site support */
-    // Find candidate duplicate calls with the same talkgroup and different multisite-enabled systems
-    if (call->get_talkgroup() == message.talkgroup) {
-      if (call->get_sys_num() != message.sys_num) {
-        if (call->get_system()->get_multiSite() && sys->get_multiSite()) {
-          if (call->get_system()->get_wacn() == sys->get_wacn()) {
-            // Default mode to match WACN and use RFSS/Site to identify duplicate calls
-            sys_rfss_site = sys->get_sys_rfss() * 10000 + sys->get_sys_site_id();
-            call_rfss_site = call->get_system()->get_sys_rfss() * 10000 + call->get_system()->get_sys_site_id();
-            if ((sys_rfss_site != call_rfss_site) && (call->get_system()->get_multiSiteSystemName() == "")) {
-              if (call->get_state() == RECORDING) {
-
-                duplicate_grant = true;
-                original_call = call;
-
-                unsigned long call_preferredNAC = 0;
-                Talkgroup *call_talkgroup = call->get_system()->find_talkgroup(message.talkgroup);
-                if (call_talkgroup) {
-                  call_preferredNAC = call_talkgroup->get_preferredNAC();
-                }
+    if (call->get_sys_num() != message.sys_num) {
+      if (call->get_system()->get_multiSite() && sys->get_multiSite()) {
+        if (call->get_system()->get_wacn() == sys->get_wacn()) {
+          // Default mode to match WACN and use RFSS/Site to identify duplicate calls
+          sys_rfss_site = sys->get_sys_rfss() * 10000 + sys->get_sys_site_id();
+          call_rfss_site = call->get_system()->get_sys_rfss() * 10000 + call->get_system()->get_sys_site_id();
+          if ((sys_rfss_site != call_rfss_site) && (call->get_system()->get_multiSiteSystemName() == "")) {
+            if (call->get_state() == RECORDING) {
+
+              duplicate_grant = true;
+              original_call = call;
+
+              unsigned long call_preferredNAC = 0;
+              std::shared_ptr<const Talkgroup> call_talkgroup = call->get_system()->find_talkgroup(message.talkgroup);
+              if (call_talkgroup) {
+                call_preferredNAC = call_talkgroup->get_preferredNAC();
+              }
 
-                // Evaluate superseding grants by comparing call NAC or RFSS-Site against preferred NAC/site in talkgroup .csv
-                if ((call_preferredNAC != call->get_system()->get_nac()) && (message_preferredNAC == sys->get_nac())) {
-                  superseding_grant = true;
-                } else if ((call_preferredNAC != call_rfss_site) && (message_preferredNAC == sys_rfss_site)) {
-                  superseding_grant = true;
-                }
+              // Evaluate superseding grants by comparing call NAC or RFSS-Site against preferred NAC/site in talkgroup .csv
+              if ((call_preferredNAC != call->get_system()->get_nac()) && (message_preferredNAC == sys->get_nac())) {
+                superseding_grant = true;
+              } else if ((call_preferredNAC != call_rfss_site) && (message_preferredNAC == sys_rfss_site)) {
+                superseding_grant = true;
               }
             }
+          }
 
-            // Secondary mode to match multiSiteSystemName and use multiSiteSystemNumber.
-            // If a multiSiteSystemName has been manually entered;
-            // We already know that Call's system number does not match the message system number.
-            // In this case, we check that the multiSiteSystemName is present, and that the Call and System multiSiteSystemNames are the same.
-            else if ((call->get_system()->get_multiSiteSystemName() != "") && (call->get_system()->get_multiSiteSystemName() == sys->get_multiSiteSystemName())) {
-              if (call->get_state() == RECORDING) {
+          // Secondary mode to match multiSiteSystemName and use multiSiteSystemNumber.
+          // If a multiSiteSystemName has been manually entered;
+          // We already know that Call's system number does not match the message system number.
+          // In this case, we check that the multiSiteSystemName is present, and that the Call and System multiSiteSystemNames are the same.
+          else if ((call->get_system()->get_multiSiteSystemName() != "") && (call->get_system()->get_multiSiteSystemName() == sys->get_multiSiteSystemName())) {
+            if (call->get_state() == RECORDING) {
 
-                duplicate_grant = true;
-                original_call = call;
+              duplicate_grant = true;
+              original_call = call;
 
-                unsigned long call_preferredNAC = 0;
-                Talkgroup *call_talkgroup = call->get_system()->find_talkgroup(message.talkgroup);
-                if (call_talkgroup) {
-                  call_preferredNAC = call_talkgroup->get_preferredNAC();
-                }
+              unsigned long call_preferredNAC = 0;
+              std::shared_ptr<const Talkgroup> call_talkgroup = call->get_system()->find_talkgroup(message.talkgroup);
+              if (call_talkgroup) {
+                call_preferredNAC = call_talkgroup->get_preferredNAC();
+              }
 
-                if ((call->get_system()->get_multiSiteSystemNumber() != 0) && (sys->get_multiSiteSystemNumber() != 0)) {
-                  if ((call_preferredNAC != call->get_system()->get_multiSiteSystemNumber()) && (message_preferredNAC == sys->get_multiSiteSystemNumber())) {
-                    superseding_grant = true;
-                  }
+              if ((call->get_system()->get_multiSiteSystemNumber() != 0) && (sys->get_multiSiteSystemNumber() != 0)) {
+                if ((call_preferredNAC != call->get_system()->get_multiSiteSystemNumber()) && (message_preferredNAC == sys->get_multiSiteSystemNumber())) {
+                  superseding_grant = true;
                 }
               }
             }
@@ -542,8 +816,17 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
         }
       }
     }
+  }
+
+  const std::vector<Call *> &channel_calls = calls.find_channel(message.sys_num, message.freq);
+  for (vector<Call *>::const_iterator it = channel_calls.begin(); it != channel_calls.end(); it++) {
+    Call *call = *it;
+
+    if ((call->get_tdma_slot() != message.tdma_slot) || (call->get_phase2_tdma() != message.phase2_tdma)) {
+      continue;
+    }
 
-    if ((call->get_talkgroup() == message.talkgroup) && (call->get_sys_num() == message.sys_num) && (call->get_freq() == message.freq) && (call->get_tdma_slot() == message.tdma_slot) && (call->get_phase2_tdma() == message.phase2_tdma)) {
+    if (call->get_talkgroup() == message.talkgroup) {
       call_found = true;
       bool source_updated = call->update(message);
       if (source_updated) {
@@ -553,7 +836,7 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
 
     // There is an existing call on freq and slot that the new call will be started on. We should stop the older call. The older recorder will
     // keep writing to the file until it hits a termination flag, so no packets should be dropped.
-    if ((call->get_state() == RECORDING) && (call->get_talkgroup() != message.talkgroup) && (call->get_sys_num() == message.sys_num) && (call->get_freq() == message.freq) && (call->get_tdma_slot() == message.tdma_slot) && (call->get_phase2_tdma() == message.phase2_tdma)) {
+    if ((call->get_state() == RECORDING) && (call->get_talkgroup() != message.talkgroup)) {
       Recorder *recorder = call->get_recorder();
       string recorder_state = "UNKNOWN";
       if (recorder != NULL) {
@@ -561,14 +844,12 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
       }
       BOOST_LOG_TRIVIAL(trace) << "[" << call->get_short_name() << "]\t\033[0;34m" << call->get_call_num() << "C\033[0m\tTG: " << call->get_talkgroup_display() << "\tFreq: " << format_freq(call->get_freq()) << "\t\u001b[36mShould be Stopping RECORDING call, Recorder State: " << recorder_state << " RX overlapping TG message Freq, TG:" << message.talkgroup << "\u001b[0m";
     }
-
-    it++;
   }
 
   if (!call_found) {
-    Call *call = Call::make(message, sys, config);
+    Call *call = Call::make(message, sys, get_config_snapshot());
 
-    Talkgroup *talkgroup = sys->find_talkgroup(call->get_talkgroup());
+    std::shared_ptr<const Talkgroup> talkgroup = sys->find_talkgroup(call->get_talkgroup());
 
     if (talkgroup) {
       call->set_talkgroup_tag(talkgroup->alpha_tag);
@@ -612,9 +893,15 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message) {
         BOOST_LOG_TRIVIAL(info) << "[" << call->get_short_name() << "]\t\033[0;34m" << call->get_call_num() << "C\033[0m\tTG: " << call->get_talkgroup_display() << "\tFreq: " << format_freq(call->get_freq()) << "\t\u001b[36mThis was an UPDATE\u001b[0m";
       }
     }
-    calls.push_back(call);
+    if (recording_started) {
+      calls_recorded++;
+      if (grant_message) {
+        record_grant_latency();
+      }
+    }
+    calls.add(call);
     plugman_call_start(call);
-    plugman_calls_active(calls);
+    plugman_calls_active(calls.get_calls());
   }
 }
 
@@ -629,11 +916,12 @@ void handle_call_update(TrunkMessage message, System *sys) {
   going until it gets a termination flag.
   */
 
-  for (vector<Call *>::iterator it = calls.begin(); it != calls.end(); ++it) {
+  const std::vector<Call *> &channel_calls = calls.find_channel(message.sys_num, message.freq);
+  for (vector<Call *>::const_iterator it = channel_calls.begin(); it != channel_calls.end(); ++it) {
     Call *call = *it;
 
     // BOOST_LOG_TRIVIAL(info) << "TG: " << call->get_talkgroup() << " | " << message.talkgroup << " sys num: " << call->get_sys_num() << " | " << message.sys_num << " freq: " << call->get_freq() << " | " << message.freq << " TDMA Slot" << call->get_tdma_slot() << " | " << message.tdma_slot << " TDMA: " << call->get_phase2_tdma() << " | " << message.phase2_tdma;
-    if ((call->get_talkgroup() == message.talkgroup) && (call->get_sys_num() == message.sys_num) && (call->get_freq() == message.freq) && (call->get_tdma_slot() == message.tdma_slot) && (call->get_phase2_tdma() == message.phase2_tdma)) {
+    if ((call->get_talkgroup() == message.talkgroup) && (call->get_tdma_slot() == message.tdma_slot) && (call->get_phase2_tdma() == message.phase2_tdma)) {
       call_found = true;
 
       bool source_updated = call->update(message);
@@ -855,88 +1143,238 @@ void check_message_count(float timeDiff) {
   }
 }
 
-void monitor_messages() {
-  gr::message::sptr msg;
-  int sys_num;
-  System *sys;
+std::vector<TrunkMessage> parse_trunk_message(System_impl *system, gr::message::sptr msg, SmartnetParser *smartnet, P25Parser *p25) {
+  if (system->get_system_type() == "smartnet") {
+    return smartnet->parse_message(msg, system);
+  }
+
+  if (system->get_system_type() == "p25") {
+    return p25->parse_message(msg, system);
+  }
+  return std::vector<TrunkMessage>();
+}
+
+// trunk_mutex has to be held
+void dispatch_trunk_messages(System_impl *system, gr::message::sptr msg, std::vector<TrunkMessage> &trunk_messages) {
+  system->set_message_count(system->get_message_count() + 1);
+  handle_message(trunk_messages, system);
+  plugman_trunk_message(trunk_messages, system);
 
-  time_t last_status_time = time(NULL);
-  time_t last_decode_rate_check = time(NULL);
-  time_t management_timestamp = time(NULL);
-  time_t current_time = time(NULL);
+  if (msg->type() == -1) {
+    BOOST_LOG_TRIVIAL(error) << "[" << system->get_short_name() << "]\t process_data_unit timeout";
+  }
+}
+
+void pump_messages(System_impl *system) {
+  gr::msg_queue::sptr queue = system->get_msg_queue();
+  // The parsers keep per System state, so a System thread can have its own
+  SmartnetParser smartnet;
+  P25Parser p25;
   std::vector<TrunkMessage> trunk_messages;
 
-  while (1) {
+  while (!pumps_stopping) {
+    // blocks until the control channel decoder has something
+    gr::message::sptr msg = queue->delete_head();
 
-    if (exit_flag) { // my action when signal set it 1
-      BOOST_LOG_TRIVIAL(info) << "Caught an Exit Signal...";
-      for (vector<Call *>::iterator it = calls.begin(); it != calls.end();) {
-        Call *call = *it;
+    if (pumps_stopping) {
+      break;
+    }
 
-        if (call->get_state() != MONITORING) {
-          call->conclude_call();
-        }
+    if (config.system_threads) {
+      std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+      trunk_messages = parse_trunk_message(system, msg, &smartnet, &p25);
 
-        it = calls.erase(it);
-        delete call;
+      std::lock_guard<std::mutex> lock(trunk_mutex);
+      if (pumps_stopping) {
+        break;
       }
+      current_message_received = received;
+      dispatch_trunk_messages(system, msg, trunk_messages);
+      continue;
+    }
 
-      BOOST_LOG_TRIVIAL(info) << "Cleaning up & Exiting...";
+    {
+      std::lock_guard<std::mutex> lock(trunk_queue_mutex);
+      trunk_queue.push_back({system, msg, std::chrono::steady_clock::now()});
+    }
+    trunk_queue_cv.notify_one();
+  }
+}
 
-      // Sleep for 5 seconds to allow for all of the Call Concluder threads to finish.
-      boost::this_thread::sleep(boost::posix_time::milliseconds(5000));
-      return;
+void start_message_pumps() {
+  for (vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); sys_it++) {
+    System_impl *system = (System_impl *)*sys_it;
+
+    if ((system->get_system_type() == "p25") || (system->get_system_type() == "smartnet")) {
+      pump_threads.push_back(std::thread(pump_messages, system));
+    }
+  }
+}
+
+// The flow graph has to be stopped first, so nothing else is added to the msg_queues
+void stop_message_pumps() {
+  pumps_stopping = true;
+
+  for (vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); sys_it++) {
+    System_impl *system = (System_impl *)*sys_it;
+
+    if ((system->get_system_type() == "p25") || (system->get_system_type() == "smartnet")) {
+      // wake up the pump if it is waiting on an empty queue
+      system->get_msg_queue()->flush();
+      system->get_msg_queue()->insert_tail(gr::message::make(0));
     }
+  }
 
-    process_message_queues();
+  for (std::vector<std::thread>::iterator it = pump_threads.begin(); it != pump_threads.end(); it++) {
+    it->join();
+  }
+  pump_threads.clear();
+}
 
-    plugman_poll_one();
+std::vector<Tag_Reload> load_tags(std::vector<System *> reload_systems) {
+  std::vector<Tag_Reload> loaded;
 
-    for (vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); sys_it++) {
-      System_impl *system = (System_impl *)*sys_it;
+  for (vector<System *>::iterator sys_it = reload_systems.begin(); sys_it != reload_systems.end(); sys_it++) {
+    System *system = *sys_it;
+    Tag_Reload reload = {system, system->get_talkgroups_snapshot(), system->get_unit_tags_snapshot()};
 
-      if ((system->get_system_type() == "p25") || (system->get_system_type() == "smartnet")) {
-        msg.reset();
-        msg = system->get_msg_queue()->delete_head_nowait();
-        while (msg != 0) {
-          system->set_message_count(system->get_message_count() + 1);
+    // the Channel file also decides which conventional Recorders are created, so it is only read at startup
+    if (!system->has_channel_file() && (system->get_talkgroups_file() != "")) {
+      std::shared_ptr<Talkgroups> talkgroups = std::make_shared<Talkgroups>();
+      if (!talkgroups->load_talkgroups(system->get_sys_num(), system->get_talkgroups_file())) {
+        throw std::runtime_error("unable to load Talkgroup file " + system->get_talkgroups_file());
+      }
+      reload.talkgroups = talkgroups;
+    }
 
-          if (system->get_system_type() == "smartnet") {
-            trunk_messages = smartnet_parser->parse_message(msg->to_string(), system);
-            handle_message(trunk_messages, system);
-            plugman_trunk_message(trunk_messages, system);
-          }
+    if (system->get_unit_tags_file() != "") {
+      Unit_Tags_Snapshot unit_tags = std::make_shared<UnitTags>();
+      if (!unit_tags->load_unit_tags(system->get_unit_tags_file())) {
+        throw std::runtime_error("unable to load Unit Tag file " + system->get_unit_tags_file());
+      }
+      reload.unit_tags = unit_tags;
+    }
 
-          if (system->get_system_type() == "p25") {
-            trunk_messages = p25_parser->parse_message(msg, system);
-            handle_message(trunk_messages, system);
-            plugman_trunk_message(trunk_messages, system);
-          }
+    loaded.push_back(reload);
+  }
+  return loaded;
+}
+
+// Called with the trunk_mutex held, so nothing is looking up a Talkgroup while they are swapped
+void check_tag_reload() {
+  if (reload_flag && !tag_reload.valid()) {
+    reload_flag = 0;
+    BOOST_LOG_TRIVIAL(info) << "Caught a Reload Signal, reading the Talkgroup and Unit Tag files...";
+    tag_reload = std::async(std::launch::async, load_tags, systems);
+  }
+
+  if (!tag_reload.valid() || (tag_reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+    return;
+  }
+
+  try {
+    std::vector<Tag_Reload> loaded = tag_reload.get();
+
+    // all of the files have to load before any System is changed
+    for (std::vector<Tag_Reload>::iterator it = loaded.begin(); it != loaded.end(); it++) {
+      it->system->set_talkgroups_snapshot(it->talkgroups);
+      it->system->set_unit_tags_snapshot(it->unit_tags);
+    }
+    BOOST_LOG_TRIVIAL(info) << "Reloaded the Talkgroups and Unit Tags, Calls in progress keep the ones they started with";
+  } catch (std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "Reload failed, keeping the current Talkgroups and Unit Tags: " << e.what();
+  }
+}
+
+void monitor_messages() {
+  std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point last_decode_rate_check = current_time;
+  std::chrono::steady_clock::time_point next_poll = current_time + poll_interval;
+  std::chrono::steady_clock::time_point next_management = current_time + std::chrono::seconds(1);
+  std::chrono::steady_clock::time_point next_decode_rate_check = current_time + std::chrono::seconds(3);
+  std::chrono::steady_clock::time_point next_status = current_time + std::chrono::seconds(200);
+  bool conventional = has_conventional_recorders();
+  // Every plugin is polled once to find out if it overrides poll_one()
+  bool poll_needed = true;
+  std::deque<Trunk_Queue_Entry> pending;
+  std::vector<TrunkMessage> trunk_messages;
+
+  while (1) {
 
-          if (msg->type() == -1) {
-            BOOST_LOG_TRIVIAL(error) << "[" << system->get_short_name() << "]\t process_data_unit timeout";
+    if (exit_flag) { // my action when signal set it 1
+      {
+        std::lock_guard<std::mutex> lock(trunk_mutex);
+        // the System threads must not start new Calls from here on
+        pumps_stopping = true;
+        BOOST_LOG_TRIVIAL(info) << "Caught an Exit Signal...";
+        while (calls.size() > 0) {
+          Call *call = calls[calls.size() - 1];
+
+          if (call->get_state() != MONITORING) {
+            call->conclude_call();
           }
 
-          msg.reset();
-          msg = system->get_msg_queue()->delete_head_nowait();
+          calls.remove(call);
+          delete call;
         }
       }
-    }
-    current_time = time(NULL);
 
-    if ((current_time - management_timestamp) >= 1.0) {
-      manage_calls();
+      BOOST_LOG_TRIVIAL(info) << "Cleaning up & Exiting...";
+
+      // Let the Call Concluder finish the calls that are queued up. This can take a while with
+      // uploads and retries, so it is done without the trunk_mutex a System thread may be waiting on
+      Call_Concluder::stop_workers();
       Call_Concluder::manage_call_data_workers();
-      management_timestamp = current_time;
+      return;
     }
 
-    boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    // Sleep until a message arrives or the next timer is due. The exit and reload signals can not
+    // notify the condition variable, so they are picked up at the latest by the poll timer, or by
+    // the management timer when nothing needs polling.
+    {
+      std::unique_lock<std::mutex> lock(trunk_queue_mutex);
+      std::chrono::steady_clock::time_point deadline = std::min({next_management, next_decode_rate_check, next_status});
+      if (poll_needed) {
+        deadline = std::min(deadline, next_poll);
+      }
+      trunk_queue_cv.wait_until(lock, deadline, [] { return !trunk_queue.empty(); });
+      pending.swap(trunk_queue);
+    }
 
-    float decode_rate_check_time_diff = current_time - last_decode_rate_check;
+    std::lock_guard<std::mutex> lock(trunk_mutex);
 
-    if (decode_rate_check_time_diff >= 3.0) {
+    for (std::deque<Trunk_Queue_Entry>::iterator it = pending.begin(); it != pending.end(); it++) {
+      current_message_received = it->received;
+      trunk_messages = parse_trunk_message(it->system, it->msg, smartnet_parser, p25_parser);
+      dispatch_trunk_messages(it->system, it->msg, trunk_messages);
+    }
+    pending.clear();
+
+    current_time = std::chrono::steady_clock::now();
+
+    if ((poll_needed && (current_time >= next_poll)) || (!poll_needed && (current_time >= next_management))) {
+      if (conventional) {
+        process_message_queues();
+      }
+      plugman_poll_one();
+      check_tag_reload();
+      poll_needed = conventional || plugman_poll_needed();
+      next_poll = current_time + poll_interval;
+    }
+
+    if (current_time >= next_management) {
+      manage_calls();
+      Call_Concluder::manage_call_data_workers();
+      sample_cpu_usage();
+      check_replay_sources();
+      next_management = current_time + std::chrono::seconds(1);
+    }
+
+    if (current_time >= next_decode_rate_check) {
+      float decode_rate_check_time_diff = std::chrono::duration<float>(current_time - last_decode_rate_check).count();
       check_message_count(decode_rate_check_time_diff);
       last_decode_rate_check = current_time;
+      next_decode_rate_check = current_time + std::chrono::seconds(3);
       for (vector<System *>::iterator sys_it = systems.begin(); sys_it != systems.end(); sys_it++) {
         System *system = *sys_it;
         if (system->get_system_type() == "p25") {
@@ -945,10 +1383,8 @@ void monitor_messages() {
       }
     }
 
-    float print_status_time_diff = current_time - last_status_time;
-
-    if (print_status_time_diff > 200) {
-      last_status_time = current_time;
+    if (current_time >= next_status) {
+      next_status = current_time + std::chrono::seconds(200);
       print_status();
     }
   }
@@ -971,11 +1407,11 @@ bool setup_convetional_channel(System *system, double frequency, long channel_in
 
       Call_conventional *call = NULL;
       if (system->has_channel_file()) {
-        Talkgroup *tg = system->find_talkgroup_by_freq(frequency);
-        call = new Call_conventional(tg->number, tg->freq, system, config);
+        std::shared_ptr<const Talkgroup> tg = system->find_talkgroup_by_freq(frequency);
+        call = new Call_conventional(tg->number, tg->freq, system, get_config_snapshot());
         call->set_talkgroup_tag(tg->alpha_tag);
       } else {
-        call = new Call_conventional(channel_index, frequency, system, config);
+        call = new Call_conventional(channel_index, frequency, system, get_config_snapshot());
       }
       BOOST_LOG_TRIVIAL(info) << "[" << system->get_short_name() << "]\tMonitoring " << system->get_system_type() << " channel: " << format_freq(frequency) << " Talkgroup: " << channel_index;
       if (system->get_system_type() == "conventional") {
@@ -986,7 +1422,7 @@ bool setup_convetional_channel(System *system, double frequency, long channel_in
         call->set_recorder((Recorder *)rec.get());
         call->set_state(RECORDING);
         system->add_conventional_recorder(rec);
-        calls.push_back(call);
+        calls.add(call);
         plugman_setup_recorder((Recorder *)rec.get());
         plugman_call_start(call);
       } else if (system->get_system_type() == "conventionalDMR") {
@@ -997,7 +1433,7 @@ bool setup_convetional_channel(System *system, double frequency, long channel_in
         rec = source->create_dmr_conventional_recorder(tb);
         call->set_recorder((Recorder *)rec.get());
         system->add_conventionalDMR_recorder(rec);
-        calls.push_back(call);
+        calls.add(call);
       } else { // has to be "conventional P25"
         // Because of dynamic mod assignment we can not start the recorder until the graph has been unlocked.
         // This has something to do with the way the Selector block works.
@@ -1006,7 +1442,7 @@ bool setup_convetional_channel(System *system, double frequency, long channel_in
         rec = source->create_digital_conventional_recorder(tb);
         call->set_recorder((Recorder *)rec.get());
         system->add_conventionalP25_recorder(rec);
-        calls.push_back(call);
+        calls.add(call);
       }
 
       // break out of the for loop
@@ -1020,9 +1456,9 @@ bool setup_conventional_system(System *system) {
   bool system_added = false;
 
   if (system->has_channel_file()) {
-    std::vector<Talkgroup *> talkgroups = system->get_talkgroups();
-    for (vector<Talkgroup *>::iterator tg_it = talkgroups.begin(); tg_it != talkgroups.end(); tg_it++) {
-      Talkgroup *tg = *tg_it;
+    std::vector<std::shared_ptr<const Talkgroup>> talkgroups = system->get_talkgroups();
+    for (vector<std::shared_ptr<const Talkgroup>>::iterator tg_it = talkgroups.begin(); tg_it != talkgroups.end(); tg_it++) {
+      std::shared_ptr<const Talkgroup> tg = *tg_it;
 
       bool channel_added = setup_convetional_channel(system, tg->freq, tg->number);
 
@@ -1152,12 +1588,19 @@ int main(int argc, char **argv) {
   if (!load_config(config_file, config, tb, sources, systems)) {
     exit(1);
   }
+  publish_config(config);
 
   start_plugins(sources, systems);
+  Call_Concluder::start_workers(config.call_concluder_threads, config.call_concluder_queue_limit);
+  vocoder_service::start(config.vocoder_threads);
 
   if (setup_systems()) {
     signal(SIGINT, exit_interupt);
+    signal(SIGHUP, reload_interupt);
     tb->start();
+    run_start_wall = get_wall_seconds();
+    run_start_cpu = get_cpu_seconds();
+    start_message_pumps();
 
     monitor_messages();
 
@@ -1167,12 +1610,14 @@ int main(int argc, char **argv) {
     BOOST_LOG_TRIVIAL(info) << "stopping flow graph" << std::endl;
     tb->stop();
     tb->wait();
+    stop_message_pumps();
 
     BOOST_LOG_TRIVIAL(info) << "stopping plugins" << std::endl;
     stop_plugins();
   } else {
     BOOST_LOG_TRIVIAL(error) << "Unable to setup a System to record, exiting..." << std::endl;
   }
+  vocoder_service::stop();
 
   return exit_code;
 }
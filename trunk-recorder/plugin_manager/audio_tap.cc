@@ -0,0 +1,215 @@
+#include "audio_tap.h"
+#include "../call.h"
+#include "../recorders/recorder.h"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+#include <string.h>
+
+static std::vector<std::shared_ptr<Audio_Tap>> audio_taps;
+static std::atomic<bool> audio_taps_started(false);
+
+Audio_Tap_Ring::Audio_Tap_Ring(size_t depth) : next_seq(0), head(0), tail(0), overruns(0), retired(false) {
+  size_t size = 1;
+  while (size < depth) {
+    size <<= 1;
+  }
+  slots.resize(size);
+  mask = size - 1;
+}
+
+Audio_Tap_Block *Audio_Tap_Ring::begin_write() {
+  uint64_t h = head.load(std::memory_order_relaxed);
+  if (h - tail.load(std::memory_order_acquire) == slots.size()) {
+    return NULL;
+  }
+  return &slots[h & mask];
+}
+
+void Audio_Tap_Ring::end_write() {
+  head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void Audio_Tap_Ring::overrun() {
+  next_seq++;
+  overruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The last thing the producer does with the ring
+void Audio_Tap_Ring::retire() {
+  retired.store(true, std::memory_order_release);
+}
+
+const Audio_Tap_Block *Audio_Tap_Ring::front() {
+  uint64_t t = tail.load(std::memory_order_relaxed);
+  if (t == head.load(std::memory_order_acquire)) {
+    return NULL;
+  }
+  return &slots[t & mask];
+}
+
+void Audio_Tap_Ring::pop() {
+  tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+Audio_Tap::Audio_Tap(std::string name, size_t depth) : name(name), depth(depth), retired_overruns(0), next_ring(0), waiting(false) {
+}
+
+std::shared_ptr<Audio_Tap_Ring> Audio_Tap::add_ring() {
+  std::shared_ptr<Audio_Tap_Ring> ring = std::make_shared<Audio_Tap_Ring>(depth);
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  rings.push_back(ring);
+  return ring;
+}
+
+const Audio_Tap_Block *Audio_Tap::front() {
+  if (current) {
+    const Audio_Tap_Block *block = current->front();
+    if (block) {
+      return block;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(rings_mutex);
+
+  // a retired ring has had its last block written, once that is read it can go
+  for (std::vector<std::shared_ptr<Audio_Tap_Ring>>::iterator it = rings.begin(); it != rings.end();) {
+    if ((*it)->is_retired() && !(*it)->front()) {
+      retired_overruns += (*it)->get_overruns();
+      it = rings.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (size_t i = 0; i < rings.size(); i++) {
+    size_t index = (next_ring + i) % rings.size();
+    const Audio_Tap_Block *block = rings[index]->front();
+    if (block) {
+      current = rings[index];
+      next_ring = (index + 1) % rings.size();
+      return block;
+    }
+  }
+  current.reset();
+  return NULL;
+}
+
+void Audio_Tap::pop() {
+  if (current) {
+    current->pop();
+    current.reset();
+  }
+}
+
+void Audio_Tap::wait_for(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(wait_mutex);
+  waiting.store(true);
+  if (front()) {
+    waiting.store(false);
+    return;
+  }
+  wait_cv.wait_for(lock, timeout);
+  waiting.store(false);
+}
+
+// The producer only touches the mutex when the consumer is asleep, so a
+// busy consumer never makes a recorder wait.
+void Audio_Tap::notify() {
+  if (waiting.exchange(false)) {
+    std::lock_guard<std::mutex> lock(wait_mutex);
+    wait_cv.notify_one();
+  }
+}
+
+uint64_t Audio_Tap::get_overruns() {
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  uint64_t total = retired_overruns;
+  for (std::vector<std::shared_ptr<Audio_Tap_Ring>>::iterator it = rings.begin(); it != rings.end(); ++it) {
+    total += (*it)->get_overruns();
+  }
+  return total;
+}
+
+std::shared_ptr<Audio_Tap> audio_tap_subscribe(std::string name, size_t depth) {
+  if (audio_taps_started.load()) {
+    BOOST_LOG_TRIVIAL(error) << "Audio Tap: " << name << " subscribed after audio started flowing, it has to subscribe while the plugin is starting up";
+    return NULL;
+  }
+  std::shared_ptr<Audio_Tap> tap = std::make_shared<Audio_Tap>(name, std::max(depth, (size_t)1));
+  audio_taps.push_back(tap);
+  BOOST_LOG_TRIVIAL(info) << "Audio Tap: " << name << " subscribed, buffering " << depth << " blocks per recorder";
+  return tap;
+}
+
+// The rings a thread publishes to, retired when the thread exits
+struct Audio_Tap_Producer {
+  std::vector<std::shared_ptr<Audio_Tap>> taps;
+  std::vector<std::shared_ptr<Audio_Tap_Ring>> rings;
+
+  ~Audio_Tap_Producer() {
+    for (size_t i = 0; i < rings.size(); i++) {
+      rings[i]->retire();
+      taps[i]->notify();
+    }
+  }
+};
+
+// Called from the thread of each recorder's audio sink. Every sink gets its
+// own ring per tap the first time it publishes, which keeps each ring to a
+// single producer even where a recorder has more than one sink.
+void audio_tap_publish(Call *call, Recorder *recorder, int16_t *samples, int sampleCount) {
+  thread_local Audio_Tap_Producer producer;
+  std::vector<std::shared_ptr<Audio_Tap_Ring>> &rings = producer.rings;
+
+  if (audio_taps.empty()) {
+    return;
+  }
+  if (!audio_taps_started.load(std::memory_order_relaxed)) {
+    audio_taps_started.store(true);
+  }
+  while (rings.size() < audio_taps.size()) {
+    producer.taps.push_back(audio_taps[rings.size()]);
+    rings.push_back(audio_taps[rings.size()]->add_ring());
+  }
+
+  for (int offset = 0; offset < sampleCount; offset += AUDIO_TAP_BLOCK_SAMPLES) {
+    int count = std::min(sampleCount - offset, AUDIO_TAP_BLOCK_SAMPLES);
+
+    for (size_t i = 0; i < audio_taps.size(); i++) {
+      Audio_Tap_Ring *ring = rings[i].get();
+      Audio_Tap_Block *block = ring->begin_write();
+      if (!block) {
+        ring->overrun();
+        continue;
+      }
+
+      block->seq = ring->next_seq++;
+      block->rec_num = recorder->get_num();
+      block->sample_rate = recorder->get_wav_hz();
+      if (call) {
+        block->sys_num = call->get_sys_num();
+        block->call_num = call->get_call_num();
+        block->talkgroup = call->get_talkgroup();
+        block->source_id = call->get_current_source_id();
+        block->freq = call->get_freq();
+      } else {
+        block->sys_num = -1;
+        block->call_num = -1;
+        block->talkgroup = 0;
+        block->source_id = 0;
+        block->freq = 0;
+      }
+      block->sample_count = count;
+      memcpy(block->samples, samples + offset, count * sizeof(int16_t));
+      ring->end_write();
+      audio_taps[i]->notify();
+    }
+  }
+}
+
+void audio_tap_print_stats() {
+  for (std::vector<std::shared_ptr<Audio_Tap>>::iterator it = audio_taps.begin(); it != audio_taps.end(); ++it) {
+    BOOST_LOG_TRIVIAL(info) << "Audio Tap: " << (*it)->get_name() << " Overruns: " << (*it)->get_overruns() << " blocks";
+  }
+}
@@ -0,0 +1,104 @@
+#ifndef AUDIO_TAP_H
+#define AUDIO_TAP_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class Call;
+class Recorder;
+
+const int AUDIO_TAP_BLOCK_SAMPLES = 512;
+
+// One block of PCM from a recorder, along with what was being recorded.
+// seq counts every block the producer tried to publish to this tap, so a
+// gap in seq means blocks were dropped because the consumer fell behind.
+struct Audio_Tap_Block {
+  uint64_t seq;
+  int rec_num;
+  int sys_num;
+  long call_num;
+  long talkgroup;
+  long source_id;
+  double freq;
+  long sample_rate;
+  int sample_count;
+  int16_t samples[AUDIO_TAP_BLOCK_SAMPLES];
+};
+
+// Single producer, single consumer ring of blocks. The producer is the
+// GNU Radio thread of one recorder's audio sink and never waits: when the
+// ring is full the new block is dropped and counted as an overrun. A ring is
+// retired when its thread exits, which happens to every block thread when
+// the flow graph is locked for a retune, and is removed once it has been
+// read empty.
+class Audio_Tap_Ring {
+public:
+  Audio_Tap_Ring(size_t depth);
+
+  Audio_Tap_Block *begin_write();
+  void end_write();
+  void overrun();
+  void retire();
+  bool is_retired() const { return retired.load(std::memory_order_acquire); }
+
+  const Audio_Tap_Block *front();
+  void pop();
+
+  uint64_t get_overruns() const { return overruns.load(std::memory_order_relaxed); }
+  uint64_t next_seq;
+
+private:
+  std::vector<Audio_Tap_Block> slots;
+  size_t mask;
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> overruns;
+  std::atomic<bool> retired;
+};
+
+// A plugin's subscription to the audio of every recorder. Blocks are read
+// in place with front()/pop() from the plugin's own thread, round robin
+// across recorders.
+class Audio_Tap {
+public:
+  Audio_Tap(std::string name, size_t depth);
+
+  const Audio_Tap_Block *front();
+  void pop();
+  // Sleeps until a block may be available or the timeout passes.
+  void wait_for(std::chrono::milliseconds timeout);
+
+  uint64_t get_overruns();
+  std::string get_name() { return name; }
+
+  std::shared_ptr<Audio_Tap_Ring> add_ring();
+  void notify();
+
+private:
+  std::string name;
+  size_t depth;
+  std::mutex rings_mutex;
+  std::vector<std::shared_ptr<Audio_Tap_Ring>> rings;
+  uint64_t retired_overruns;
+  size_t next_ring;
+  // holds on to the ring the last front() came from until it is popped
+  std::shared_ptr<Audio_Tap_Ring> current;
+
+  std::mutex wait_mutex;
+  std::condition_variable wait_cv;
+  std::atomic<bool> waiting;
+};
+
+// Subscriptions have to be made from a plugin's parse_config(), init() or
+// start(), before any audio is published. depth is in blocks, per recorder.
+std::shared_ptr<Audio_Tap> audio_tap_subscribe(std::string name, size_t depth);
+void audio_tap_publish(Call *call, Recorder *recorder, int16_t *samples, int sampleCount);
+void audio_tap_print_stats();
+
+#endif // AUDIO_TAP_H
@@ -0,0 +1,72 @@
+#include "call_journal.h"
+#include "../call.h"
+#include "../recorders/recorder.h"
+
+Call_Journal::Call_Journal() : version(0), pass(0) {
+}
+
+void Call_Journal::add_change(call_change_t type, long call_num, const Call_Entry &entry, Call *call) {
+  Call_Change change;
+  change.type = type;
+  change.version = ++version;
+  change.call_num = call_num;
+  change.sys_num = entry.sys_num;
+  change.talkgroup = entry.talkgroup;
+  change.start_time = entry.start_time;
+  change.call = call;
+  changes.push_back(change);
+}
+
+// The returned changes are only good until the next update().
+const std::vector<Call_Change> &Call_Journal::update(const std::vector<Call *> &calls) {
+  changes.clear();
+  pass++;
+
+  for (std::vector<Call *>::const_iterator it = calls.begin(); it != calls.end(); ++it) {
+    Call *call = *it;
+    Call_Entry current;
+    current.state = call->get_state();
+    current.monitoring_state = call->get_monitoring_state();
+    current.recorder = call->get_recorder();
+    current.source_id = call->get_current_source_id();
+    current.freq = call->get_freq();
+    current.encrypted = call->get_encrypted();
+    current.emergency = call->get_emergency();
+    current.sys_num = call->get_sys_num();
+    current.talkgroup = call->get_talkgroup();
+    current.start_time = call->get_start_time();
+    current.seen = pass;
+
+    std::unordered_map<long, Call_Entry>::iterator found = entries.find(call->get_call_num());
+    if (found == entries.end()) {
+      entries[call->get_call_num()] = current;
+      add_change(CALL_ADDED, call->get_call_num(), current, call);
+      continue;
+    }
+
+    Call_Entry &previous = found->second;
+    bool changed = (previous.state != current.state) ||
+                   (previous.monitoring_state != current.monitoring_state) ||
+                   (previous.recorder != current.recorder) ||
+                   (previous.source_id != current.source_id) ||
+                   (previous.freq != current.freq) ||
+                   (previous.encrypted != current.encrypted) ||
+                   (previous.emergency != current.emergency) ||
+                   (previous.talkgroup != current.talkgroup);
+    previous = current;
+    if (changed) {
+      add_change(CALL_UPDATED, call->get_call_num(), current, call);
+    }
+  }
+
+  for (std::unordered_map<long, Call_Entry>::iterator it = entries.begin(); it != entries.end();) {
+    if (it->second.seen != pass) {
+      add_change(CALL_REMOVED, it->first, it->second, NULL);
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  return changes;
+}
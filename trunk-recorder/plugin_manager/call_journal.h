@@ -0,0 +1,65 @@
+#ifndef CALL_JOURNAL_H
+#define CALL_JOURNAL_H
+
+#include <stdint.h>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+
+class Call;
+class Recorder;
+
+typedef enum {
+  CALL_ADDED,
+  CALL_UPDATED,
+  CALL_REMOVED
+} call_change_t;
+
+// One change to the table of active Calls. call points at the live Call for
+// CALL_ADDED and CALL_UPDATED and is NULL for CALL_REMOVED, since the Call
+// has already been deleted by then. version increases by one per change.
+struct Call_Change {
+  call_change_t type;
+  uint64_t version;
+  long call_num;
+  int sys_num;
+  long talkgroup;
+  time_t start_time;
+  Call *call;
+};
+
+// Works out what changed in the active Calls since the last time they were
+// published. A Call only counts as UPDATED when something a listener would
+// act on changes; the length and elapsed time are left out because they
+// change every time they are looked at.
+class Call_Journal {
+public:
+  Call_Journal();
+
+  const std::vector<Call_Change> &update(const std::vector<Call *> &calls);
+  uint64_t get_version() const { return version; }
+
+private:
+  struct Call_Entry {
+    int state;
+    int monitoring_state;
+    Recorder *recorder;
+    long source_id;
+    double freq;
+    bool encrypted;
+    bool emergency;
+    int sys_num;
+    long talkgroup;
+    time_t start_time;
+    uint64_t seen;
+  };
+
+  void add_change(call_change_t type, long call_num, const Call_Entry &entry, Call *call);
+
+  uint64_t version;
+  uint64_t pass;
+  std::unordered_map<long, Call_Entry> entries;
+  std::vector<Call_Change> changes;
+};
+
+#endif // CALL_JOURNAL_H
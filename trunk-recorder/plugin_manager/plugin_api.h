@@ -7,6 +7,8 @@
 #include "../systems/system.h"
 #include "../systems/parser.h"
 #include "../formatter.h"
+#include "audio_tap.h"
+#include "call_journal.h"
 #include <json.hpp>
 
 typedef enum {
@@ -26,13 +28,45 @@ public:
   virtual int parse_config(json config_data) { return 0; }; // const { BOOST_LOG_TRIVIAL(info) << "plugin_api created!";return 0; };
   virtual int start() { return 0; };
   virtual int stop() { return 0; };
-  virtual int poll_one() { return 0; };
+  // Only reached by plugins that do not override poll_one(), they are not polled again
+  virtual int poll_one() { poll_wanted = false; return 0; };
   virtual int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) { return 0; };
   virtual int audio_stream(Call *call, Recorder *recorder, int16_t *samples, int sampleCount) { return 0; };
   virtual int trunk_message(std::vector<TrunkMessage> messages, System *system) { return 0; };
   virtual int call_start(Call *call) { return 0; };
-  virtual int call_end(Call_Data_t call_info) { return 0; }; //= 0; //{ BOOST_LOG_TRIVIAL(info) << "plugin_api call_end"; return 0; };
+  // Older plugins override call_end() taking Call_Data_t by value, the default const reference
+  // version hands them a copy so they are still called.
+  [[deprecated("override call_end(const Call_Data_t &) instead")]]
+  virtual int call_end(Call_Data_t call_info) { return 0; };
+  virtual int call_end(const Call_Data_t &call_info) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    int (Plugin_Api::*by_value)(Call_Data_t) = &Plugin_Api::call_end;
+#pragma GCC diagnostic pop
+    return (this->*by_value)(call_info);
+  };
+  // Older plugins override calls_active() taking the vector by value. Both
+  // overloads are kept so those overrides are still called: the default
+  // const reference version hands a copy to the by-value one.
+  [[deprecated("override calls_active(const std::vector<Call *> &) instead")]]
   virtual int calls_active(std::vector<Call *> calls) { return 0; };
+  virtual int calls_active(const std::vector<Call *> &calls) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    int (Plugin_Api::*by_value)(std::vector<Call *>) = &Plugin_Api::calls_active;
+#pragma GCC diagnostic pop
+    return (this->*by_value)(calls);
+  };
+  // changes is everything that happened to the active Calls since the last
+  // call, and may be empty. Plugins that only want the whole table can keep
+  // overriding calls_active(), which is called whenever something changed.
+  virtual int calls_changed(const std::vector<Call_Change> &changes, const std::vector<Call *> &calls) {
+    if (changes.empty()) {
+      return 0;
+    }
+    int (Plugin_Api::*by_reference)(const std::vector<Call *> &) = &Plugin_Api::calls_active;
+    return (this->*by_reference)(calls);
+  };
   virtual int setup_recorder(Recorder *recorder) { return 0; };
   virtual int setup_system(System *system) { return 0; };
   virtual int setup_systems(std::vector<System *> systems) { return 0; };
@@ -47,7 +81,11 @@ public:
   virtual int unit_answer_request(System *sys, long source_id, long talkgroup) { return 0; };
   virtual int unit_location(System *sys, long source_id, long talkgroup_num) { return 0; };
   //void set_frequency_format(int f) { frequencyFormat = f; }
+  bool wants_poll() const { return poll_wanted; };
   virtual ~Plugin_Api(){};
+
+private:
+  bool poll_wanted = true;
 };
 
 #endif
@@ -12,6 +12,7 @@
 #include <vector>
 
 std::vector<Plugin *> plugins;
+Call_Journal call_journal;
 
 Plugin *setup_plugin(std::string plugin_lib, std::string plugin_name) {
   BOOST_LOG_TRIVIAL(info) << "Setting up plugin -  Name: " << plugin_name << "\t Library file: " << plugin_lib;
@@ -115,18 +116,31 @@ void stop_plugins() {
     }
     plugin->state = PLUGIN_STOPPED;
   }
+  audio_tap_print_stats();
 }
 
 void plugman_poll_one() {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
-    if (plugin->state == PLUGIN_RUNNING) {
+    if ((plugin->state == PLUGIN_RUNNING) && plugin->api->wants_poll()) {
       plugin->api->poll_one();
     }
   }
 }
 
+bool plugman_poll_needed() {
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    if ((plugin->state == PLUGIN_RUNNING) && plugin->api->wants_poll()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void plugman_audio_callback(Call *call, Recorder *recorder, int16_t *samples, int sampleCount) {
+  audio_tap_publish(call, recorder, samples, sampleCount);
+
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
@@ -168,12 +182,13 @@ int plugman_call_start(Call *call) {
   return error;
 }
 
-int plugman_call_end(Call_Data_t call_info) {
+int plugman_call_end(const Call_Data_t &call_info) {
   int total_error = 0;
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      int plugin_error = plugin->api->call_end(call_info);
+      int (Plugin_Api::*by_reference)(const Call_Data_t &) = &Plugin_Api::call_end;
+      int plugin_error = (plugin->api.get()->*by_reference)(call_info);
       if (plugin_error) {
         BOOST_LOG_TRIVIAL(error) << "Plugin Manager: call_end -  " << plugin->name << " failed";
       }
@@ -183,12 +198,15 @@ int plugman_call_end(Call_Data_t call_info) {
   return total_error;
 }
 
-int plugman_calls_active(std::vector<Call *> calls) {
+// Called at least once a second with the current Calls, whether or not
+// anything changed, so plugins get a regular chance to send a snapshot.
+int plugman_calls_active(const std::vector<Call *> &calls) {
   int error = 0;
+  const std::vector<Call_Change> &changes = call_journal.update(calls);
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->calls_active(calls);
+      plugin->api->calls_changed(changes, calls);
     }
   }
   return error;
@@ -7,6 +7,8 @@
 #include "../systems/system.h"
 #include "../systems/system_impl.h"
 
+#include "audio_tap.h"
+#include "call_journal.h"
 #include "plugin_api.h"
 #if GNURADIO_VERSION >= 0x030a00
 #include <boost/function.hpp>
@@ -31,12 +33,13 @@ void start_plugins(std::vector<Source *> sources, std::vector<System *> systems)
 void stop_plugins();
 
 void plugman_poll_one();
+bool plugman_poll_needed();
 void plugman_audio_callback(Call *call, Recorder *recorder, int16_t *samples, int sampleCount);
 int plugman_signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder);
 int plugman_trunk_message(std::vector<TrunkMessage> messages, System *system);
 int plugman_call_start(Call *call);
-int plugman_call_end(Call_Data_t call_info);
-int plugman_calls_active(std::vector<Call *> calls);
+int plugman_call_end(const Call_Data_t &call_info);
+int plugman_calls_active(const std::vector<Call *> &calls);
 void plugman_setup_recorder(Recorder *recorder);
 void plugman_setup_system(System *system);
 void plugman_setup_systems(std::vector<System *> systems);
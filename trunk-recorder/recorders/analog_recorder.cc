@@ -116,9 +116,7 @@ analog_recorder::analog_recorder(Source *src, Recorder_Type type)
   //  channel_lpf_taps =  gr::filter::firdes::low_pass_2(1.0, pre_channel_rate, 5000, 2000, 60);
   channel_lpf_taps = gr::filter::firdes::low_pass_2(1.0, initial_rate, 4000, 1000, 100);
 
-  std::vector<gr_complex> dest(inital_lpf_taps.begin(), inital_lpf_taps.end());
-
-  prefilter = make_freq_xlating_fft_filter(initial_decim, dest, offset, samp_rate);
+  prefilter = gr::blocks::xlating_decim_filter::make(initial_decim, inital_lpf_taps, offset, samp_rate);
 
   channel_lpf = gr::filter::fft_filter_ccf::make(decim, channel_lpf_taps);
 
@@ -199,6 +197,9 @@ analog_recorder::analog_recorder(Source *src, Recorder_Type type)
   // tm *ltm = localtime(&starttime);
 
   wav_sink = gr::blocks::transmission_sink::make(1, wav_sample_rate, 16); //  Configurable
+  if (config != NULL) {
+    wav_sink->set_write_policy(config->wav_preallocate_seconds, config->wav_flush_seconds);
+  }
 
   if (use_streaming) {
     BOOST_LOG_TRIVIAL(info) << "\t Creating plugin sink..." << std::endl;
@@ -279,6 +280,9 @@ void analog_recorder::stop() {
     recording_duration += wav_sink->length_in_seconds();
     state = INACTIVE;
     valve->set_enabled(false);
+    if (type == ANALOG) {
+      source->set_recorder_enabled(this, false);
+    }
     wav_sink->stop_recording();
   } else {
 
@@ -403,9 +407,20 @@ bool analog_recorder::start(Call *call) {
 
   state = ACTIVE;
   valve->set_enabled(true);
+  if (type == ANALOG) {
+    source->set_recorder_enabled(this, true);
+  }
   return true;
 }
 
 double analog_recorder::get_output_sample_rate() {
   return wav_sample_rate;
 }
+
+std::vector<gr::basic_block_sptr> analog_recorder::get_blocks() {
+  std::vector<gr::basic_block_sptr> blocks = {valve, prefilter, channel_lpf, arb_resampler, squelch, demod, deemph, decim_audio, high_f, low_f, squelch_two, sym_filter, levels, converter, wav_sink, plugin_sink};
+  std::vector<gr::basic_block_sptr> decoders = decoder_sink->get_blocks();
+
+  blocks.insert(blocks.end(), decoders.begin(), decoders.end());
+  return blocks;
+}
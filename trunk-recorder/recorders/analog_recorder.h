@@ -45,7 +45,7 @@ class Source;
 class analog_recorder;
 
 #include "../gr_blocks/decoder_wrapper.h"
-#include "../gr_blocks/freq_xlating_fft_filter.h"
+#include "../gr_blocks/xlating_decim_filter.h"
 #include "../gr_blocks/plugin_wrapper.h"
 #include "../gr_blocks/transmission_sink.h"
 #include "../systems/system.h"
@@ -96,6 +96,7 @@ public:
   void plugin_callback_handler(int16_t *samples, int sampleCount);
   double get_output_sample_rate();
   double since_last_write();
+  std::vector<gr::basic_block_sptr> get_blocks();
 
 private:
   double center_freq, chan_freq;
@@ -129,7 +130,7 @@ private:
   Config *config;
   Source *source;
   void calculate_iir_taps(double tau);
-  freq_xlating_fft_filter_sptr prefilter;
+  gr::blocks::xlating_decim_filter::sptr prefilter;
 
   /* GR blocks */
   gr::filter::iir_filter_ffd::sptr deemph;
@@ -91,8 +91,6 @@ void dmr_recorder_impl::initialize_prefilter() {
 
   valve = gr::blocks::copy::make(sizeof(gr_complex));
   valve->set_enabled(false);
-  lo = gr::analog::sig_source_c::make(input_rate, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
-  mixer = gr::blocks::multiply_cc::make();
 
   dmr_recorder_impl::DecimSettings decim_settings = get_decim(input_rate);
   if (decim_settings.decim != -1) {
@@ -103,20 +101,18 @@ void dmr_recorder_impl::initialize_prefilter() {
     fa = 6250;
     fb = if2 / 2;
     BOOST_LOG_TRIVIAL(info) << "\t DMR Recorder two-stage decimator - Initial decimated rate: " << if1 << " Second decimated rate: " << if2 << " FA: " << fa << " FB: " << fb << " System Rate: " << input_rate;
-    bandpass_filter_coeffs = gr::filter::firdes::complex_band_pass(1.0, input_rate, -if1 / 2, if1 / 2, if1 / 2);
+    prefilter_coeffs = gr::filter::firdes::low_pass(1.0, input_rate, if1 / 2, if1 / 2);
     lowpass_filter_coeffs = gr::filter::firdes::low_pass(1.0, if1, (fb + fa) / 2, fb - fa);
-    bandpass_filter = gr::filter::fft_filter_ccc::make(decim_settings.decim, bandpass_filter_coeffs);
+    prefilter = gr::blocks::xlating_decim_filter::make(decim_settings.decim, prefilter_coeffs, 0, input_rate);
     lowpass_filter = gr::filter::fft_filter_ccf::make(decim_settings.decim2, lowpass_filter_coeffs);
     resampled_rate = if2;
-    bfo = gr::analog::sig_source_c::make(if1, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
   } else {
     double_decim = false;
     BOOST_LOG_TRIVIAL(info) << "\t DMR Recorder single-stage decimator - Initial decimated rate: " << if1 << " Second decimated rate: " << if2 << " Initial Decimation: " << decim << " System Rate: " << input_rate;
-    lo = gr::analog::sig_source_c::make(input_rate, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
     lowpass_filter_coeffs = gr::filter::firdes::low_pass(1.0, input_rate, 7250, 1450);
     decim = floor(input_rate / if_rate);
     resampled_rate = input_rate / decim;
-    lowpass_filter = gr::filter::fft_filter_ccf::make(decim, lowpass_filter_coeffs);
+    prefilter = gr::blocks::xlating_decim_filter::make(decim, lowpass_filter_coeffs, 0, input_rate);
   }
 
   // Cut-Off Filter
@@ -132,16 +128,13 @@ void dmr_recorder_impl::initialize_prefilter() {
   BOOST_LOG_TRIVIAL(info) << "\t DMR Recorder ARB - Initial Rate: " << input_rate << " Resampled Rate: " << resampled_rate << " Initial Decimation: " << decim << " ARB Rate: " << arb_rate;
 
   connect(self(), 0, valve, 0);
+  connect(valve, 0, prefilter, 0);
   if (double_decim) {
-    connect(valve, 0, bandpass_filter, 0);
-    connect(bandpass_filter, 0, mixer, 0);
-    connect(bfo, 0, mixer, 1);
+    connect(prefilter, 0, lowpass_filter, 0);
+    connect(lowpass_filter, 0, arb_resampler, 0);
   } else {
-    connect(valve, 0, mixer, 0);
-    connect(lo, 0, mixer, 1);
+    connect(prefilter, 0, arb_resampler, 0);
   }
-  connect(mixer, 0, lowpass_filter, 0);
-  connect(lowpass_filter, 0, arb_resampler, 0);
   connect(arb_resampler, 0, cutoff_filter, 0);
 }
 
@@ -217,6 +210,10 @@ void dmr_recorder_impl::initialize(Source *src) {
   slicer = gr::op25_repeater::fsk4_slicer_fb::make(msgq_id, debug, slices);
   wav_sink_slot0 = gr::blocks::transmission_sink::make(1, 8000, 16);
   wav_sink_slot1 = gr::blocks::transmission_sink::make(1, 8000, 16);
+  if (config != NULL) {
+    wav_sink_slot0->set_write_policy(config->wav_preallocate_seconds, config->wav_flush_seconds);
+    wav_sink_slot1->set_write_policy(config->wav_preallocate_seconds, config->wav_flush_seconds);
+  }
   // recorder->initialize(src);
 
   // OP25 Frame Assembler
@@ -351,22 +348,7 @@ void dmr_recorder_impl::tune_offset(double f) {
   if (abs(freq) > ((input_rate / 2) - (if1 / 2))) {
     BOOST_LOG_TRIVIAL(info) << "Tune Offset: Freq exceeds limit: " << abs(freq) << " compared to: " << ((input_rate / 2) - (if1 / 2));
   }
-  if (double_decim) {
-    bandpass_filter_coeffs = gr::filter::firdes::complex_band_pass(1.0, input_rate, -freq - if1 / 2, -freq + if1 / 2, if1 / 2);
-    bandpass_filter->set_taps(bandpass_filter_coeffs);
-    float bfz = (static_cast<float>(decim) * -freq) / (float)input_rate;
-    bfz = bfz - static_cast<int>(bfz);
-    if (bfz < -0.5) {
-      bfz = bfz + 1.0;
-    }
-    if (bfz > 0.5) {
-      bfz = bfz - 1.0;
-    }
-    bfo->set_frequency(-bfz * if1);
-
-  } else {
-    lo->set_frequency(freq);
-  }
+  prefilter->set_center_freq(-freq);
 }
 
 bool compareTransmissions(Transmission t1, Transmission t2) {
@@ -78,6 +78,7 @@
 #include "../gr_blocks/plugin_wrapper_impl.h"
 #include "../gr_blocks/selector.h"
 #include "../gr_blocks/transmission_sink.h"
+#include "../gr_blocks/xlating_decim_filter.h"
 #include "../source.h"
 #include "dmr_recorder.h"
 #include "recorder.h"
@@ -153,16 +154,12 @@ private:
 
   std::vector<float> arb_taps;
 
-  std::vector<gr_complex> bandpass_filter_coeffs;
+  std::vector<float> prefilter_coeffs;
   std::vector<float> lowpass_filter_coeffs;
   std::vector<float> cutoff_filter_coeffs;
 
-  gr::analog::sig_source_c::sptr lo;
-  gr::analog::sig_source_c::sptr bfo;
-  gr::blocks::multiply_cc::sptr mixer;
-
   /* GR blocks */
-  gr::filter::fft_filter_ccc::sptr bandpass_filter;
+  gr::blocks::xlating_decim_filter::sptr prefilter;
   gr::filter::fft_filter_ccf::sptr lowpass_filter;
   gr::filter::fft_filter_ccf::sptr cutoff_filter;
 
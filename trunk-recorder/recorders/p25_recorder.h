@@ -57,6 +57,8 @@ public:
   virtual long elapsed() = 0;
   virtual Source *get_source() = 0;
   virtual void autotune() = 0;
+  virtual uint64_t get_audio_samples_produced() = 0;
+  virtual uint64_t get_audio_samples_dropped() = 0;
 };
 
 #endif // ifndef P25_RECORDER_H
@@ -44,6 +44,10 @@ void p25_recorder_decode::set_source(long src) {
   wav_sink->set_source(src);
 }
 
+void p25_recorder_decode::set_write_policy(int preallocate_seconds, int flush_seconds) {
+  wav_sink->set_write_policy(preallocate_seconds, flush_seconds);
+}
+
 std::vector<Transmission> p25_recorder_decode::get_transmission_list() {
   return wav_sink->get_transmission_list();
 }
@@ -57,6 +61,14 @@ double p25_recorder_decode::get_current_length() {
   return wav_sink->total_length_in_seconds();
 }
 
+uint64_t p25_recorder_decode::get_samples_produced() {
+  return op25_frame_assembler->get_samples_produced();
+}
+
+uint64_t p25_recorder_decode::get_samples_dropped() {
+  return op25_frame_assembler->get_samples_dropped();
+}
+
 State p25_recorder_decode::get_state() {
   return wav_sink->get_state();
 }
@@ -143,4 +155,8 @@ void p25_recorder_decode::reset() {
 
 gr::op25_repeater::p25_frame_assembler::sptr p25_recorder_decode::get_transmission_sink() {
   return op25_frame_assembler;
-}
\ No newline at end of file
+}
+
+std::vector<gr::basic_block_sptr> p25_recorder_decode::get_blocks() {
+  return {slicer, op25_frame_assembler, converter, levels, wav_sink, plugin_sink};
+}
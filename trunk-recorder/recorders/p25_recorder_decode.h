@@ -58,6 +58,7 @@ public:
   void set_tdma_slot(int slot);
   std::vector<Transmission> get_transmission_list();
   void set_source(long src);
+  void set_write_policy(int preallocate_seconds, int flush_seconds);
   void set_xor_mask(const char *mask);
   void switch_tdma(bool phase2_tdma);
   void start(Call *call);
@@ -71,8 +72,11 @@ public:
   double get_current_length();
   void plugin_callback_handler(int16_t *samples, int sampleCount);
   double get_output_sample_rate();
+  uint64_t get_samples_produced();
+  uint64_t get_samples_dropped();
   State get_state();
   gr::op25_repeater::p25_frame_assembler::sptr get_transmission_sink();
+  std::vector<gr::basic_block_sptr> get_blocks();
 
 };
 #endif
\ No newline at end of file
@@ -36,6 +36,10 @@ void p25_recorder_fsk4_demod::reset() {
   //  fsk4_demod->reset(); This one may have been working but removing for now to be safe
 }
 
+std::vector<gr::basic_block_sptr> p25_recorder_fsk4_demod::get_blocks() {
+  return {cutoff_filter, pll_freq_lock, pll_amp, noise_filter, sym_filter, fm_demod, baseband_amp, fsk4_demod, slicer, clock_recovery};
+}
+
 void p25_recorder_fsk4_demod::initialize() {
   const double phase1_channel_rate = phase1_symbol_rate * phase1_samples_per_symbol;
   const double pi = M_PI;
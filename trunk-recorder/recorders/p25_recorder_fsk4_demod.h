@@ -47,6 +47,7 @@ public:
   p25_recorder_fsk4_demod();
   virtual ~p25_recorder_fsk4_demod();
   void reset();
+  std::vector<gr::basic_block_sptr> get_blocks();
 
 private:
   const int phase1_samples_per_symbol = 5;
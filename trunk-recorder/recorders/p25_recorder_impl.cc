@@ -90,11 +90,9 @@ void p25_recorder_impl::initialize_prefilter() {
 
   valve = gr::blocks::copy::make(sizeof(gr_complex));
   valve->set_enabled(false);
-  lo = gr::analog::sig_source_c::make(input_rate, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
-  mixer = gr::blocks::multiply_cc::make();
 
   p25_recorder_impl::DecimSettings decim_settings = get_decim(input_rate);
-  if (decim_settings.decim != -1) {
+  if ((decim_settings.decim != -1) && !channelized) {
     double_decim = true;
     decim = decim_settings.decim;
     if1 = input_rate / decim_settings.decim;
@@ -102,19 +100,17 @@ void p25_recorder_impl::initialize_prefilter() {
     fa = 6250;
     fb = if2 / 2;
     BOOST_LOG_TRIVIAL(info) << "\t P25 Recorder two-stage decimator - Initial decimated rate: " << if1 << " Second decimated rate: " << if2 << " FA: " << fa << " FB: " << fb << " System Rate: " << input_rate;
-    bandpass_filter_coeffs = gr::filter::firdes::complex_band_pass(1.0, input_rate, -if1 / 2, if1 / 2, if1 / 2);
+    prefilter_coeffs = gr::filter::firdes::low_pass(1.0, input_rate, if1 / 2, if1 / 2);
     #if GNURADIO_VERSION < 0x030900
         lowpass_filter_coeffs = gr::filter::firdes::low_pass(1.0, if1, (fb + fa) / 2, fb - fa, gr::filter::firdes::WIN_HAMMING);
     #else
         lowpass_filter_coeffs = gr::filter::firdes::low_pass(1.0, if1, (fb + fa) / 2, fb - fa, gr::fft::window::WIN_HAMMING);
     #endif
-    bandpass_filter = gr::filter::fft_filter_ccc::make(decim_settings.decim, bandpass_filter_coeffs);
+    prefilter = gr::blocks::xlating_decim_filter::make(decim_settings.decim, prefilter_coeffs, 0, input_rate);
     lowpass_filter = gr::filter::fft_filter_ccf::make(decim_settings.decim2, lowpass_filter_coeffs);
     resampled_rate = if2;
-    bfo = gr::analog::sig_source_c::make(if1, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
   } else {
     double_decim = false;
-    lo = gr::analog::sig_source_c::make(input_rate, gr::analog::GR_SIN_WAVE, 0, 1.0, 0.0);
 
     #if GNURADIO_VERSION < 0x030900
         lowpass_filter_coeffs = gr::filter::firdes::low_pass(1.0, input_rate, 7250, 1450, gr::filter::firdes::WIN_HANN);
@@ -123,7 +119,7 @@ void p25_recorder_impl::initialize_prefilter() {
     #endif
     decim = floor(input_rate / if_rate);
     resampled_rate = input_rate / decim;
-    lowpass_filter = gr::filter::fft_filter_ccf::make(decim, lowpass_filter_coeffs);
+    prefilter = gr::blocks::xlating_decim_filter::make(decim, lowpass_filter_coeffs, 0, input_rate);
     BOOST_LOG_TRIVIAL(info) << "\t P25 Recorder single-stage decimator - Initial decimated rate: " << if1 << " Second decimated rate: " << if2 << " Initial Decimation: " << decim << " System Rate: " << input_rate;
   }
 
@@ -159,19 +155,16 @@ void p25_recorder_impl::initialize_prefilter() {
 
 
   connect(self(), 0, valve, 0);
+  connect(valve, 0, prefilter, 0);
+  gr::basic_block_sptr decimated = prefilter;
   if (double_decim) {
-    connect(valve, 0, bandpass_filter, 0);
-    connect(bandpass_filter, 0, mixer, 0);
-    connect(bfo, 0, mixer, 1);
-  } else {
-    connect(valve, 0,  mixer, 0);
-    connect(lo, 0, mixer, 1);
+    connect(prefilter, 0, lowpass_filter, 0);
+    decimated = lowpass_filter;
   }
-  connect(mixer, 0,lowpass_filter, 0);
   if (arb_rate == 1.0) {
-    connect(lowpass_filter, 0, cutoff_filter, 0);
+    connect(decimated, 0, cutoff_filter, 0);
   } else {
-    connect(lowpass_filter, 0, arb_resampler, 0);
+    connect(decimated, 0, arb_resampler, 0);
     connect(arb_resampler, 0, cutoff_filter, 0);
   }
   connect(cutoff_filter,0, squelch, 0);
@@ -187,6 +180,12 @@ void p25_recorder_impl::initialize(Source *src) {
   config = source->get_config();
   d_soft_vocoder = config->soft_vocoder;
   input_rate = source->get_rate();
+  channelized = false;
+  // Trunk recorders on a channelized Source get a narrowband channel instead of the full Source bandwidth
+  if ((type == P25) && source->is_channelized()) {
+    channelized = true;
+    input_rate = source->get_channel_rate();
+  }
   qpsk_mod = true;
   silence_frames = source->get_silence_frames();
   squelch_db = 0;
@@ -215,6 +214,10 @@ void p25_recorder_impl::initialize(Source *src) {
   qpsk_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
   fsk4_demod = make_p25_recorder_fsk4_demod();
   fsk4_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
+  if (config != NULL) {
+    qpsk_p25_decode->set_write_policy(config->wav_preallocate_seconds, config->wav_flush_seconds);
+    fsk4_p25_decode->set_write_policy(config->wav_preallocate_seconds, config->wav_flush_seconds);
+  }
 
   modulation_selector->set_enabled(true);
 
@@ -271,14 +274,10 @@ void p25_recorder_impl::reset_block(gr::basic_block_sptr block) {
 void p25_recorder_impl::clear() {
   // This lead to weird SegFaults, but the goal was to clear out buffers inbetween transmissions.
   /*
+  reset_block(prefilter);
   if (double_decim) {
-    //reset_block(bandpass_filter);
-    //reset_block(bfo);
-  } else {
-  //reset_block(lo);
+    reset_block(lowpass_filter);
   }
-  reset_block(lowpass_filter);
-  reset_block(mixer);
 
   if (arb_rate != 1.0) {
   reset_block(arb_resampler);
@@ -385,6 +384,31 @@ double p25_recorder_impl::get_freq() {
   return chan_freq;
 }
 
+uint64_t p25_recorder_impl::get_audio_samples_produced() {
+  return qpsk_p25_decode->get_samples_produced() + fsk4_p25_decode->get_samples_produced();
+}
+
+uint64_t p25_recorder_impl::get_audio_samples_dropped() {
+  return qpsk_p25_decode->get_samples_dropped() + fsk4_p25_decode->get_samples_dropped();
+}
+
+boost::property_tree::ptree p25_recorder_impl::get_stats() {
+  boost::property_tree::ptree node = Recorder::get_stats();
+  node.put("audioSamples", get_audio_samples_produced());
+  node.put("audioDropped", get_audio_samples_dropped());
+  return node;
+}
+
+std::vector<gr::basic_block_sptr> p25_recorder_impl::get_blocks() {
+  std::vector<gr::basic_block_sptr> blocks = {valve, prefilter, lowpass_filter, arb_resampler, cutoff_filter, squelch, rms_agc, fll_band_edge, modulation_selector};
+  std::vector<gr::basic_block_sptr> inner[] = {fsk4_demod->get_blocks(), fsk4_p25_decode->get_blocks(), qpsk_demod->get_blocks(), qpsk_p25_decode->get_blocks()};
+
+  for (std::vector<gr::basic_block_sptr> &part : inner) {
+    blocks.insert(blocks.end(), part.begin(), part.end());
+  }
+  return blocks;
+}
+
 double p25_recorder_impl::get_current_length() {
   if (qpsk_mod) {
     return qpsk_p25_decode->get_current_length();
@@ -408,27 +432,16 @@ void p25_recorder_impl::tune_freq(double f) {
 }
 void p25_recorder_impl::tune_offset(double f) {
 
+  if (channelized) {
+    f = source->tune_channel(this, f);
+  }
+
   float freq = static_cast<float>(f);
 
   if (abs(freq) > ((input_rate / 2) - (if1 / 2))) {
     BOOST_LOG_TRIVIAL(info) << "Tune Offset: Freq exceeds limit: " << abs(freq) << " compared to: " << ((input_rate / 2) - (if1 / 2));
   }
-  if (double_decim) {
-    bandpass_filter_coeffs = gr::filter::firdes::complex_band_pass(1.0, input_rate, -freq - if1 / 2, -freq + if1 / 2, if1 / 2);
-    bandpass_filter->set_taps(bandpass_filter_coeffs);
-    float bfz = (static_cast<float>(decim) * -freq) / (float)input_rate;
-    bfz = bfz - static_cast<int>(bfz);
-    if (bfz < -0.5) {
-      bfz = bfz + 1.0;
-    }
-    if (bfz > 0.5) {
-      bfz = bfz - 1.0;
-    }
-    bfo->set_frequency(-bfz * if1);
-
-  } else {
-    lo->set_frequency(freq);
-  }
+  prefilter->set_center_freq(-freq);
   /*
   if (!qpsk_mod) {
     fsk4_demod->reset();
@@ -467,6 +480,9 @@ void p25_recorder_impl::stop() {
 
     state = INACTIVE;
     valve->set_enabled(false);
+    if (type == P25) {
+      source->set_recorder_enabled(this, false);
+    }
     clear();
     if (qpsk_mod) {
       qpsk_p25_decode->stop();
@@ -535,6 +551,9 @@ bool p25_recorder_impl::start(Call *call) {
     state = ACTIVE;
     valve->set_enabled(true);
     modulation_selector->set_enabled(true);
+    if (type == P25) {
+      source->set_recorder_enabled(this, true);
+    }
 
     recording_count++;
   } else {
@@ -55,6 +55,7 @@
 #include "../gr_blocks/transmission_sink.h"
 //#include <op25_repeater/include/op25_repeater/rmsagc_ff.h>
 #include "../gr_blocks/rms_agc.h"
+#include "../gr_blocks/xlating_decim_filter.h"
 #include "p25_recorder.h"
 #include "p25_recorder_decode.h"
 #include "p25_recorder_fsk4_demod.h"
@@ -106,6 +107,10 @@ public:
   long elapsed();
   Source *get_source();
   void autotune();
+  uint64_t get_audio_samples_produced();
+  uint64_t get_audio_samples_dropped();
+  boost::property_tree::ptree get_stats();
+  std::vector<gr::basic_block_sptr> get_blocks();
 
 protected:
   State state;
@@ -151,6 +156,7 @@ private:
   bool d_phase2_tdma;
   bool d_soft_vocoder;
   bool double_decim;
+  bool channelized;
   long if1;
   long if2;
   long input_rate;
@@ -161,16 +167,12 @@ private:
 
   std::vector<float> arb_taps;
 
-  std::vector<gr_complex> bandpass_filter_coeffs;
+  std::vector<float> prefilter_coeffs;
   std::vector<float> lowpass_filter_coeffs;
   std::vector<float> cutoff_filter_coeffs;
 
-  gr::analog::sig_source_c::sptr lo;
-  gr::analog::sig_source_c::sptr bfo;
-  gr::blocks::multiply_cc::sptr mixer;
-
   /* GR blocks */
-  gr::filter::fft_filter_ccc::sptr bandpass_filter;
+  gr::blocks::xlating_decim_filter::sptr prefilter;
   gr::filter::fft_filter_ccf::sptr lowpass_filter;
   gr::filter::fft_filter_ccf::sptr cutoff_filter;
 
@@ -39,6 +39,10 @@ void p25_recorder_qpsk_demod::reset() {
     reset_block(rescale);*/
 }
 
+std::vector<gr::basic_block_sptr> p25_recorder_qpsk_demod::get_blocks() {
+  return {agc, noise_filter, sym_filter, clock, diffdec, costas, to_float, rescale};
+}
+
 void p25_recorder_qpsk_demod::switch_tdma(bool phase2) {
   double omega;
   double fmax;
@@ -51,6 +51,7 @@ public:
   virtual ~p25_recorder_qpsk_demod();
   void switch_tdma(bool phase2);
   void reset();
+  std::vector<gr::basic_block_sptr> get_blocks();
 
 private:
   double system_channel_rate;
@@ -101,6 +101,8 @@ public:
   virtual int get_recording_count() { return recording_count; }
   virtual double get_recording_duration() { return recording_duration; }
   virtual void process_message_queues(void){};
+  // The GNU Radio blocks inside of the Recorder, so the CPU time of their threads can be measured
+  virtual std::vector<gr::basic_block_sptr> get_blocks() { return {}; };
   virtual double get_output_sample_rate() { return 0; }
   virtual int get_output_channels() { return 1; }
   virtual bool get_enable_audio_streaming() { return d_enable_audio_streaming; };
@@ -1,6 +1,14 @@
 
 #include "sigmf_recorder_impl.h"
+#include "../formatter.h"
 #include <boost/log/trivial.hpp>
+#include <chrono>
+#include <fstream>
+#include <json.hpp>
+#include <volk/volk.h>
+
+// Input samples are taken from the ring this many filter blocks at a time.
+static const int BLOCKS_PER_PASS = 16;
 
 // static int rec_counter=0;
 
@@ -10,10 +18,12 @@ sigmf_recorder_sptr make_sigmf_recorder(Source *src) {
   return gnuradio::get_initial_sptr(recorder);
 }
 
+// The recorder isn't connected into the flow graph: it reads from the
+// source's IQ ring, which is fed whether or not anything is recording.
 sigmf_recorder_impl::sigmf_recorder_impl(Source *src)
     : gr::hier_block2("sigmf_recorder",
-                      gr::io_signature::make(1, 1, sizeof(gr_complex)),
-                      gr::io_signature::make(0, 0, sizeof(float))),
+                      gr::io_signature::make(0, 0, 0),
+                      gr::io_signature::make(0, 0, 0)),
       Recorder(SIGMF) {
   source = src;
   freq = source->get_center();
@@ -27,26 +37,33 @@ sigmf_recorder_impl::sigmf_recorder_impl(Source *src)
   rec_num = rec_counter++;
 
   state = INACTIVE;
-
-  // double symbol_rate         = 4800;
+  stopping = false;
+  stop_index = 0;
+  data_file = NULL;
+  samples_written = 0;
+  pre_roll_samples = 0;
+  overruns = 0;
 
   timestamp = time(NULL);
   starttime = time(NULL);
 
-  valve = gr::blocks::copy::make(sizeof(gr_complex));
-  valve->set_enabled(false);
+  iq_ring = source->get_iq_ring();
+  datatype = source->get_sigmf_datatype();
 
-  // tm *ltm = localtime(&starttime);
+  double rate = iq_ring->sampling_freq();
+  decim = std::max((int)floor(rate / source->get_sigmf_channel_rate()), 1);
+  out_rate = rate / decim;
 
-  int nchars = snprintf(filename, 160, "%ld-%ld_%g.raw", talkgroup, starttime, freq);
+  BOOST_LOG_TRIVIAL(info) << "\t SigMF Recorder - Decimation: " << decim << " Channel Rate: " << FormatSamplingRate(out_rate) << " Datatype: " << datatype;
+}
 
-  if (nchars >= 160) {
-    BOOST_LOG_TRIVIAL(error) << "Analog Recorder: Path longer than 160 charecters";
+sigmf_recorder_impl::~sigmf_recorder_impl() {
+  if (state == ACTIVE) {
+    stop();
+  }
+  if (worker.joinable()) {
+    worker.join();
   }
-  raw_sink = gr::blocks::file_sink::make(sizeof(gr_complex), filename);
-
-  connect(self(), 0, valve, 0);
-  connect(valve, 0, raw_sink, 0);
 }
 
 int sigmf_recorder_impl::get_num() {
@@ -66,7 +83,11 @@ double sigmf_recorder_impl::get_freq() {
 }
 
 double sigmf_recorder_impl::get_current_length() {
-  return 0;
+  return samples_written / out_rate;
+}
+
+double sigmf_recorder_impl::get_output_sample_rate() {
+  return out_rate;
 }
 
 int sigmf_recorder_impl::lastupdate() {
@@ -87,12 +108,151 @@ State sigmf_recorder_impl::get_state() {
   return state;
 }
 
+void sigmf_recorder_impl::build_channel_filter(double offset) {
+  double rate = iq_ring->sampling_freq();
+  std::vector<float> taps = gr::filter::firdes::low_pass(1.0, rate, out_rate * 0.4, out_rate * 0.2);
+  std::vector<gr_complex> rtaps(taps.size());
+
+  // same trick as the xlating_decim_filter: mix by rotating the taps, and
+  // leave only the residual rotation for the decimated output
+  double phase_inc = (2.0 * M_PI * offset) / rate;
+  for (size_t k = 0; k < taps.size(); k++) {
+    rtaps[k] = taps[k] * gr_complex(cos(phase_inc * k), sin(phase_inc * k));
+  }
+
+  channel_filter.reset(new gr::filter::kernel::fft_filter_ccc(decim, rtaps));
+  int nsamples = channel_filter->set_taps(rtaps);
+  block_inputs = nsamples * decim;
+
+  double out_phase_inc = -phase_inc * decim;
+  channel_rotator = gr::blocks::rotator();
+  channel_rotator.set_phase_incr(gr_complex(cos(out_phase_inc), sin(out_phase_inc)));
+}
+
+void sigmf_recorder_impl::skip_ahead(uint64_t head) {
+  uint64_t skip_to = head - iq_ring->capacity() / 2;
+  BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Logger [ " << rec_num << " ] fell behind the IQ ring, skipping " << (skip_to - read_index) / iq_ring->sampling_freq() << "s";
+  read_index = skip_to;
+  overruns++;
+}
+
+// Runs the channel filter over whole blocks of the ring, up to end.
+// Returns false once there is not a whole block left to process.
+bool sigmf_recorder_impl::process(uint64_t end) {
+  thread_local std::vector<gr_complex> in_buf;
+  thread_local std::vector<gr_complex> out_buf;
+  thread_local std::vector<char> file_buf;
+
+  uint64_t head = iq_ring->head();
+  uint64_t capacity = iq_ring->capacity();
+
+  if (head > read_index + capacity) {
+    skip_ahead(head);
+  }
+
+  if (read_index >= std::min(head, end)) {
+    return false;
+  }
+
+  uint64_t available = std::min(head, end) - read_index;
+  int nblocks = std::min((uint64_t)BLOCKS_PER_PASS, available / block_inputs);
+  if (nblocks == 0) {
+    return false;
+  }
+
+  int ninputs = nblocks * block_inputs;
+  int noutputs = ninputs / decim;
+  in_buf.resize(ninputs);
+  out_buf.resize(noutputs);
+
+  if (!iq_ring->read(read_index, in_buf.data(), ninputs)) {
+    // overwritten while it was being copied
+    skip_ahead(iq_ring->head());
+    return true;
+  }
+  read_index += ninputs;
+
+  channel_filter->filter(noutputs, in_buf.data(), out_buf.data());
+  channel_rotator.rotateN(out_buf.data(), out_buf.data(), noutputs);
+
+  const float *iq = (const float *)out_buf.data();
+  if (datatype == "ci8") {
+    file_buf.resize(noutputs * 2);
+    volk_32f_s32f_convert_8i((int8_t *)file_buf.data(), iq, 127.0, noutputs * 2);
+  } else {
+    file_buf.resize(noutputs * 2 * sizeof(int16_t));
+    volk_32f_s32f_convert_16i((int16_t *)file_buf.data(), iq, 32767.0, noutputs * 2);
+  }
+
+  if (fwrite(file_buf.data(), file_buf.size(), 1, data_file) != 1) {
+    BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Unable to write to " << filename << ".sigmf-data";
+  }
+  samples_written += noutputs;
+  return true;
+}
+
+void sigmf_recorder_impl::work_loop() {
+  while (true) {
+    bool done = stopping.load();
+    uint64_t end = done ? stop_index.load() : UINT64_MAX;
+
+    if (!process(end)) {
+      if (done) {
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+  }
+
+  fclose(data_file);
+  data_file = NULL;
+  write_meta();
+
+  BOOST_LOG_TRIVIAL(info) << "sigmf_recorder.cc: Finished Logger \t[ " << rec_num << " ] - freq[ " << freq << "] \t talkgroup[ " << talkgroup << " ] \t Length: " << samples_written / out_rate << "s \t Overruns: " << overruns;
+  state = INACTIVE;
+}
+
+void sigmf_recorder_impl::write_meta() {
+  nlohmann::ordered_json meta;
+  meta["global"]["core:datatype"] = (datatype == "ci8") ? "ci8" : "ci16_le";
+  meta["global"]["core:sample_rate"] = out_rate;
+  meta["global"]["core:version"] = "1.0.0";
+  meta["global"]["core:recorder"] = "trunk-recorder";
+  meta["global"]["core:description"] = short_name + " talkgroup " + std::to_string(talkgroup);
+
+  nlohmann::ordered_json capture;
+  capture["core:sample_start"] = 0;
+  capture["core:frequency"] = freq;
+  capture["core:datetime"] = first_sample_time;
+  meta["captures"] = nlohmann::ordered_json::array({capture});
+
+  meta["annotations"] = nlohmann::ordered_json::array();
+  if (pre_roll_samples > 0) {
+    nlohmann::ordered_json annotation;
+    annotation["core:sample_start"] = 0;
+    annotation["core:sample_count"] = std::min(pre_roll_samples, samples_written);
+    annotation["core:label"] = "pre-roll";
+    annotation["core:comment"] = "received before the call was granted";
+    meta["annotations"].push_back(annotation);
+  }
+
+  std::ofstream meta_file(std::string(filename) + ".sigmf-meta");
+  if (!meta_file.is_open()) {
+    BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Unable to write " << filename << ".sigmf-meta";
+    return;
+  }
+  meta_file << meta.dump(2) << std::endl;
+}
+
+// The rest of the call is filtered in the background, so stopping only
+// marks where the call ended. The recorder goes back to INACTIVE once its
+// files have been written.
 void sigmf_recorder_impl::stop() {
   if (state == ACTIVE) {
-    BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Stopping Logger \t[ " << rec_num << " ] - freq[ " << freq << "] \t talkgroup[ " << talkgroup << " ]";
-    state = INACTIVE;
-    valve->set_enabled(false);
-    raw_sink->close();
+    BOOST_LOG_TRIVIAL(info) << "sigmf_recorder.cc: Stopping Logger \t[ " << rec_num << " ] - freq[ " << freq << "] \t talkgroup[ " << talkgroup << " ]";
+    state = STOPPED;
+    stop_index = iq_ring->head();
+    stopping = true;
   } else {
     BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Trying to Stop an Inactive Logger!!!";
   }
@@ -100,6 +260,10 @@ void sigmf_recorder_impl::stop() {
 
 bool sigmf_recorder_impl::start(Call *call) {
   if (state == INACTIVE) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+
     timestamp = time(NULL);
     starttime = time(NULL);
     int nchars;
@@ -107,6 +271,7 @@ bool sigmf_recorder_impl::start(Call *call) {
 
     talkgroup = call->get_talkgroup();
     freq = call->get_freq();
+    short_name = call->get_short_name();
 
     BOOST_LOG_TRIVIAL(info) << "sigmf_recorder.cc: Starting Logger   \t[ " << rec_num << " ] - freq[ " << freq << "] \t talkgroup[ " << talkgroup << " ]";
 
@@ -117,14 +282,43 @@ bool sigmf_recorder_impl::start(Call *call) {
     std::string path_string = path_stream.str();
     boost::filesystem::create_directories(path_string);
 
-    nchars = snprintf(filename, 255, "%s/%ld-%ld_%.0f.raw", path_string.c_str(), talkgroup, starttime, call->get_freq());
-    if (nchars >= 255) {
-      BOOST_LOG_TRIVIAL(error) << "Call: Path longer than 255 charecters";
+    nchars = snprintf(filename, 240, "%s/%ld-%ld_%.0f", path_string.c_str(), talkgroup, starttime, call->get_freq());
+    if (nchars >= 240) {
+      BOOST_LOG_TRIVIAL(error) << "Call: Path longer than 240 charecters";
+    }
+
+    data_file = fopen((std::string(filename) + ".sigmf-data").c_str(), "wb");
+    if (!data_file) {
+      BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Unable to open " << filename << ".sigmf-data";
+      return false;
     }
 
-    raw_sink->open(filename);
+    build_channel_filter(freq - source->get_center());
+
+    // go back as far as the pre-roll asks, but not past what is still in
+    // the ring with some room to spare for this thread getting started
+    double rate = iq_ring->sampling_freq();
+    uint64_t head = iq_ring->head();
+    uint64_t back = std::min((uint64_t)(source->get_sigmf_pre_roll() * rate), iq_ring->capacity() / 2);
+    back = std::min(back, head);
+    read_index = head - back;
+    pre_roll_samples = back / decim;
+    samples_written = 0;
+    overruns = 0;
+
+    std::chrono::system_clock::time_point first = std::chrono::system_clock::now() - std::chrono::microseconds((long long)(back * 1e6 / rate));
+    time_t first_secs = std::chrono::system_clock::to_time_t(first);
+    long first_ms = std::chrono::duration_cast<std::chrono::milliseconds>(first.time_since_epoch()).count() % 1000;
+    tm first_tm;
+    gmtime_r(&first_secs, &first_tm);
+    char datetime[40];
+    strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%S", &first_tm);
+    snprintf(datetime + strlen(datetime), sizeof(datetime) - strlen(datetime), ".%03ldZ", first_ms);
+    first_sample_time = datetime;
+
+    stopping = false;
     state = ACTIVE;
-    valve->set_enabled(true);
+    worker = std::thread(&sigmf_recorder_impl::work_loop, this);
   } else {
     BOOST_LOG_TRIVIAL(error) << "sigmf_recorder.cc: Trying to Start an already Active Logger!!!";
   }
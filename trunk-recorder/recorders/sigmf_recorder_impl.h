@@ -67,7 +67,15 @@
 #include <gnuradio/message.h>
 #include <gnuradio/msg_queue.h>
 
+#include <gnuradio/blocks/rotator.h>
+#include <gnuradio/filter/fft_filter.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include "../gr_blocks/freq_xlating_fft_filter.h"
+#include "../gr_blocks/iq_ring_sink.h"
 #include "recorder.h"
 
 #include "../source.h"
@@ -76,6 +84,7 @@ class sigmf_recorder_impl : public sigmf_recorder {
 
 public:
   sigmf_recorder_impl(Source *src);
+  ~sigmf_recorder_impl();
 
   void tune_offset(double f);
   bool start(Call *call);
@@ -83,6 +92,7 @@ public:
   double get_freq();
   int get_num();
   double get_current_length();
+  double get_output_sample_rate();
   bool is_active();
   State get_state();
   int lastupdate();
@@ -104,22 +114,44 @@ private:
   Source *source;
   char filename[255];
   // int num;
-  State state;
+  std::atomic<State> state;
+
+  // The call's channel is cut out of the source's IQ ring on a thread of
+  // its own, starting a little before the call was granted.
+  gr::blocks::iq_ring_sink::sptr iq_ring;
+  std::string datatype;
+  int decim;
+  double out_rate;
+  std::unique_ptr<gr::filter::kernel::fft_filter_ccc> channel_filter;
+  gr::blocks::rotator channel_rotator;
+  int block_inputs;
+  std::thread worker;
+  std::atomic<bool> stopping;
+  std::atomic<uint64_t> stop_index;
+  uint64_t read_index;
+  uint64_t samples_written;
+  uint64_t pre_roll_samples;
+  uint64_t overruns;
+  std::string first_sample_time;
+  std::string short_name;
+  FILE *data_file;
+
+  void build_channel_filter(double offset);
+  void work_loop();
+  void skip_ahead(uint64_t head);
+  bool process(uint64_t end);
+  void write_meta();
 
   // std::vector<gr_complex> lpf_coeffs;
   std::vector<float> lpf_coeffs;
   std::vector<float> arb_taps;
   std::vector<float> sym_taps;
 
-  gr::filter::freq_xlating_fir_filter_ccf::sptr prefilter;
-
   gr::analog::quadrature_demod_cf::sptr fm_demod;
   gr::analog::feedforward_agc_cc::sptr agc;
   gr::analog::agc2_ff::sptr demod_agc;
   gr::analog::agc2_cc::sptr pre_demod_agc;
-  gr::blocks::file_sink::sptr raw_sink;
   gr::blocks::short_to_float::sptr converter;
-  gr::blocks::copy::sptr valve;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "source.h"
 #include "formatter.h"
+#include <unistd.h>
 
 static int src_counter = 0;
 
@@ -148,14 +149,24 @@ analog_recorder_sptr Source::create_conventional_recorder(gr::top_block_sptr tb)
 void Source::create_analog_recorders(gr::top_block_sptr tb, int r) {
   max_analog_recorders = r;
 
+  if (recorder_pool && (max_analog_recorders > 0)) {
+    analog_pool = gr::blocks::channel_router::make(sizeof(gr_complex));
+    tb->connect(source_block, 0, analog_pool, 0);
+  }
+
   for (int i = 0; i < max_analog_recorders; i++) {
     analog_recorder_sptr log = make_analog_recorder(this, ANALOG);
     analog_recorders.push_back(log);
-    tb->connect(source_block, 0, log, 0);
+    if (analog_pool) {
+      analog_pool->set_route(i, -1);
+      tb->connect(analog_pool, i, log, 0);
+    } else {
+      tb->connect(source_block, 0, log, 0);
+    }
   }
 }
 
-Recorder *Source::get_analog_recorder(Talkgroup *talkgroup, int priority, Call *call) {
+Recorder *Source::get_analog_recorder(const Talkgroup *talkgroup, int priority, Call *call) {
   int num_available_recorders = get_num_available_analog_recorders();
 
   if(talkgroup && (priority == -1)){
@@ -190,17 +201,158 @@ Recorder *Source::get_analog_recorder(Call *call) {
   return NULL;
 }
 
+void Source::set_channelizer_spacing(double s) {
+  channelizer_spacing = s;
+}
+
+double Source::get_channelizer_spacing() {
+  return channelizer_spacing;
+}
+
+bool Source::is_channelized() {
+  return channelizer_block != NULL;
+}
+
+double Source::get_channel_rate() {
+  if (channelizer_block) {
+    return channelizer_block->get_channel_rate();
+  }
+  return rate;
+}
+
+void Source::set_recorder_pool(bool p) {
+  recorder_pool = p;
+}
+
+bool Source::get_recorder_pool() {
+  return recorder_pool;
+}
+
+// For the file driver, the device is the path of the IQ recording to play back
+bool Source::open_iq_file(std::string format, bool real_time) {
+  if (driver != "file") {
+    return false;
+  }
+
+  if (iq_file_source::get_item_size(format) == 0) {
+    BOOST_LOG_TRIVIAL(error) << "IQ File format not recognized: " << format << ", needs to be cf32, ci16 or cu8";
+    return false;
+  }
+
+  if (access(device.c_str(), R_OK) != 0) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to read IQ File: " << device;
+    return false;
+  }
+
+  iq_file = make_iq_file_source(device, format, rate, real_time);
+  source_block = iq_file;
+  return true;
+}
+
+iq_file_source_sptr Source::get_iq_file() {
+  return iq_file;
+}
+
+// Returns which output of the channelizer or recorder pool a trunk Recorder is attached to
+int Source::get_recorder_output(Recorder *recorder) {
+  if (recorder->get_type() == ANALOG) {
+    for (int i = 0; i < analog_recorders.size(); i++) {
+      if (analog_recorders[i].get() == recorder) {
+        return i;
+      }
+    }
+  } else {
+    for (int i = 0; i < digital_recorders.size(); i++) {
+      if (digital_recorders[i].get() == recorder) {
+        return i;
+      }
+    }
+  }
+  return -1;
+}
+
+double Source::tune_channel(Recorder *recorder, double offset) {
+  if (!channelizer_block || (recorder->get_type() != P25)) {
+    return offset;
+  }
+  int output = get_recorder_output(recorder);
+  if (output == -1) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to find a channelizer output for Recorder Num [" << recorder->get_num() << "]";
+    return offset;
+  }
+  double residual = channelizer_block->select_channel(output, offset);
+
+  // Off grid channels are still received, but it usually means the spacing or the center
+  // frequency does not match the channel plan, so each one is reported once
+  if (fabs(residual) > (channelizer_block->get_spacing() * channelizer::grid_tolerance)) {
+    long freq = lround(center - offset);
+    if (off_grid_freqs.insert(freq).second) {
+      BOOST_LOG_TRIVIAL(error) << "Channelizer - " << format_freq(freq) << " is " << lround(residual) << " Hz off of the " << channelizer_block->get_spacing() << " Hz channel grid of Source " << src_num << ", it is routed to the nearest channel and the Recorder tunes out the rest. Check that channelizerSpacing and the center of the Source match the channel plan";
+    }
+  }
+  return residual;
+}
+
+void Source::set_recorder_enabled(Recorder *recorder, bool enabled) {
+  gr::blocks::channel_router::sptr pool;
+
+  if (recorder->get_type() == P25) {
+    if (channelizer_block) {
+      // The channel gets routed to the Recorder when it is tuned
+      if (!enabled) {
+        int output = get_recorder_output(recorder);
+        if (output != -1) {
+          channelizer_block->release_channel(output);
+        }
+      }
+      return;
+    }
+    pool = digital_pool;
+  } else if (recorder->get_type() == ANALOG) {
+    pool = analog_pool;
+  }
+
+  if (!pool) {
+    return;
+  }
+  int output = get_recorder_output(recorder);
+  if (output != -1) {
+    pool->set_route(output, enabled ? 0 : -1);
+  }
+}
+
 void Source::create_digital_recorders(gr::top_block_sptr tb, int r) {
   max_digital_recorders = r;
 
+  if ((channelizer_spacing > 0) && (max_digital_recorders > 0)) {
+    if (channelizer::valid_spacing(rate, channelizer_spacing)) {
+      channelizer_block = make_channelizer(rate, channelizer_spacing, max_digital_recorders);
+      tb->connect(source_block, 0, channelizer_block, 0);
+    } else {
+      BOOST_LOG_TRIVIAL(error) << "Channelizer spacing of " << channelizer_spacing << " does not evenly divide the Source rate of " << rate << " into a multiple of " << channelizer::oversample_rate << " channels, Digital Recorders will not be channelized";
+    }
+  }
+
+  if (!channelizer_block && recorder_pool && (max_digital_recorders > 0)) {
+    digital_pool = gr::blocks::channel_router::make(sizeof(gr_complex));
+    tb->connect(source_block, 0, digital_pool, 0);
+  }
+
   for (int i = 0; i < max_digital_recorders; i++) {
     p25_recorder_sptr log = make_p25_recorder(this, P25);
     digital_recorders.push_back(log);
-    tb->connect(source_block, 0, log, 0);
+    if (channelizer_block) {
+      tb->connect(channelizer_block, i, log, 0);
+    } else if (digital_pool) {
+      digital_pool->set_route(i, -1);
+      tb->connect(digital_pool, i, log, 0);
+    } else {
+      tb->connect(source_block, 0, log, 0);
+    }
   }
 }
 
-Recorder *Source::get_digital_recorder(Talkgroup *talkgroup, int priority, Call *call) {
+Recorder *Source::get_digital_recorder(const Talkgroup *talkgroup, int priority, Call *call) {
   int num_available_recorders = get_num_available_digital_recorders();
 
   if(talkgroup && (priority == -1)){
@@ -286,17 +438,45 @@ int Source::get_debug_recorder_port() {
   return debug_recorder_port;
 }
 
-void Source::create_sigmf_recorders(gr::top_block_sptr tb, int r) {
+// The SigMF Recorders all read from one ring of the source's IQ. It holds
+// the pre-roll, plus as long again so a recorder that is running behind
+// still finds its samples there.
+void Source::create_sigmf_recorders(gr::top_block_sptr tb, int r, double pre_roll, double channel_rate, std::string datatype) {
   max_sigmf_recorders = r;
+  sigmf_pre_roll = pre_roll;
+  sigmf_channel_rate = channel_rate;
+  sigmf_datatype = datatype;
+
+  if (max_sigmf_recorders == 0) {
+    return;
+  }
+
+  iq_ring = gr::blocks::iq_ring_sink::make(rate, std::max(2 * sigmf_pre_roll, 2.0));
+  tb->connect(source_block, 0, iq_ring, 0);
 
   for (int i = 0; i < max_sigmf_recorders; i++) {
     sigmf_recorder_sptr log = make_sigmf_recorder(this);
 
     sigmf_recorders.push_back(log);
-    tb->connect(source_block, 0, log, 0);
   }
 }
 
+gr::blocks::iq_ring_sink::sptr Source::get_iq_ring() {
+  return iq_ring;
+}
+
+double Source::get_sigmf_pre_roll() {
+  return sigmf_pre_roll;
+}
+
+double Source::get_sigmf_channel_rate() {
+  return sigmf_channel_rate;
+}
+
+std::string Source::get_sigmf_datatype() {
+  return sigmf_datatype;
+}
+
 Recorder *Source::get_sigmf_recorder() {
   for (std::vector<sigmf_recorder_sptr>::iterator it = sigmf_recorders.begin();
        it != sigmf_recorders.end(); it++) {
@@ -318,14 +498,14 @@ void Source::print_recorders() {
        it != digital_recorders.end(); it++) {
     p25_recorder_sptr rx = *it;
 
-    BOOST_LOG_TRIVIAL(info) << "\t[ " << rx->get_num() << " ] " << rx->get_type_string() << "\tState: " << format_state(rx->get_state());
+    BOOST_LOG_TRIVIAL(info) << "\t[ " << rx->get_num() << " ] " << rx->get_type_string() << "\tState: " << format_state(rx->get_state()) << "\tAudio: " << rx->get_audio_samples_produced() << " Dropped: " << rx->get_audio_samples_dropped();
   }
 
   for (std::vector<p25_recorder_sptr>::iterator it = digital_conv_recorders.begin();
        it != digital_conv_recorders.end(); it++) {
     p25_recorder_sptr rx = *it;
 
-    BOOST_LOG_TRIVIAL(info) << "\t[ " << rx->get_num() << " ] " << rx->get_type_string() << "\tState: " << format_state(rx->get_state());
+    BOOST_LOG_TRIVIAL(info) << "\t[ " << rx->get_num() << " ] " << rx->get_type_string() << "\tState: " << format_state(rx->get_state()) << "\tAudio: " << rx->get_audio_samples_produced() << " Dropped: " << rx->get_audio_samples_dropped();
   }
 
   for (std::vector<dmr_recorder_sptr>::iterator it = dmr_conv_recorders.begin();
@@ -460,6 +640,10 @@ Source::Source(double c, double r, double e, std::string drv, std::string dev, C
   max_sigmf_recorders = 0;
   max_analog_recorders = 0;
   debug_recorder_port = 0;
+  channelizer_spacing = 0;
+  recorder_pool = false;
+  sigmf_pre_roll = 0;
+  sigmf_channel_rate = 0;
 
   if (driver == "osmosdr") {
     osmosdr::source::sptr osmo_src;
@@ -524,6 +708,12 @@ Source::Source(double c, double r, double e, std::string drv, std::string dev, C
 
     source_block = usrp_src;
   }
+
+  if (driver == "file") {
+    BOOST_LOG_TRIVIAL(info) << "SOURCE TYPE IQ FILE (file)";
+    // there is no hardware, the recording is played back at the rate it was made at
+    actual_rate = rate;
+  }
 }
 
 std::vector<Recorder *> Source::get_recorders() {
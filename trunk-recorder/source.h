@@ -6,6 +6,7 @@
 #include <gnuradio/uhd/usrp_source.h>
 #include <iostream>
 #include <numeric>
+#include <set>
 #include <osmosdr/source.h>
 //#include "recorders/recorder.h"
 #include "recorders/analog_recorder.h"
@@ -13,6 +14,9 @@
 #include "recorders/dmr_recorder.h"
 #include "recorders/p25_recorder.h"
 #include "recorders/sigmf_recorder.h"
+#include "gr_blocks/channelizer.h"
+#include "gr_blocks/iq_file_source.h"
+#include "gr_blocks/iq_ring_sink.h"
 
 struct Gain_Stage_t {
   std::string stage_name;
@@ -49,6 +53,18 @@ class Source {
   int silence_frames;
   Config *config;
 
+  double channelizer_spacing;
+  channelizer_sptr channelizer_block;
+  std::set<long> off_grid_freqs;
+  bool recorder_pool;
+  gr::blocks::channel_router::sptr digital_pool;
+  gr::blocks::channel_router::sptr analog_pool;
+  iq_file_source_sptr iq_file;
+  gr::blocks::iq_ring_sink::sptr iq_ring;
+  double sigmf_pre_roll;
+  double sigmf_channel_rate;
+  std::string sigmf_datatype;
+
   std::vector<p25_recorder_sptr> digital_recorders;
   std::vector<p25_recorder_sptr> digital_conv_recorders;
   std::vector<debug_recorder_sptr> debug_recorders;
@@ -62,6 +78,7 @@ class Source {
   std::string antenna;
   gr::basic_block_sptr source_block;
   void add_gain_stage(std::string stage_name, int value);
+  int get_recorder_output(Recorder *recorder);
 
 public:
   int get_num_available_digital_recorders();
@@ -110,8 +127,23 @@ public:
   int analog_recorder_count();
   Config *get_config();
 
+  void set_channelizer_spacing(double s);
+  double get_channelizer_spacing();
+  bool is_channelized();
+  double get_channel_rate();
+  double tune_channel(Recorder *recorder, double offset);
+  void set_recorder_pool(bool p);
+  bool get_recorder_pool();
+  void set_recorder_enabled(Recorder *recorder, bool enabled);
+  bool open_iq_file(std::string format, bool real_time);
+  iq_file_source_sptr get_iq_file();
+  gr::blocks::iq_ring_sink::sptr get_iq_ring();
+  double get_sigmf_pre_roll();
+  double get_sigmf_channel_rate();
+  std::string get_sigmf_datatype();
+
   void create_debug_recorder(gr::top_block_sptr tb, int source_num);
-  void create_sigmf_recorders(gr::top_block_sptr tb, int r);
+  void create_sigmf_recorders(gr::top_block_sptr tb, int r, double pre_roll, double channel_rate, std::string datatype);
   void create_analog_recorders(gr::top_block_sptr tb, int r);
   void create_digital_recorders(gr::top_block_sptr tb, int r);
   analog_recorder_sptr create_conventional_recorder(gr::top_block_sptr tb);
@@ -119,9 +151,9 @@ public:
   dmr_recorder_sptr create_dmr_conventional_recorder(gr::top_block_sptr tb);
 
   Recorder *get_digital_recorder(Call *call);
-  Recorder *get_digital_recorder(Talkgroup *talkgroup, int priority, Call *call);
+  Recorder *get_digital_recorder(const Talkgroup *talkgroup, int priority, Call *call);
   Recorder *get_analog_recorder(Call *call);
-  Recorder *get_analog_recorder(Talkgroup *talkgroup, int priority, Call *call);
+  Recorder *get_analog_recorder(const Talkgroup *talkgroup, int priority, Call *call);
   Recorder *get_debug_recorder();
   Recorder *get_sigmf_recorder();
 
@@ -1,4 +1,5 @@
 #include "p25_parser.h"
+#include <algorithm>
 #include "../formatter.h"
 
 P25Parser::P25Parser() {}
@@ -68,27 +69,15 @@ std::string P25Parser::channel_id_to_string(int chan_id, int sys_num) {
   }
 }
 
-unsigned long P25Parser::bitset_shift_mask(boost::dynamic_bitset<> &tsbk, int shift, unsigned long long mask) {
-  boost::dynamic_bitset<> bitmask(tsbk.size(), mask);
-  unsigned long result = ((tsbk >> shift) & bitmask).to_ulong();
-
-  // std::cout << "    " << std::dec<< shift << " " << tsbk.size() << " [ " <<
-  // mask << " ]  = " << result << " - " << ((tsbk >> shift) & bitmask) <<
-  // std::endl;
-  return result;
+unsigned long P25Parser::bitset_shift_mask(P25Bits &tsbk, int shift, unsigned long long mask) {
+  return tsbk.field(shift, mask);
 }
 
-unsigned long P25Parser::bitset_shift_left_mask(boost::dynamic_bitset<> &tsbk, int shift, unsigned long long mask) {
-  boost::dynamic_bitset<> bitmask(tsbk.size(), mask);
-  unsigned long result = ((tsbk << shift) & bitmask).to_ulong();
-
-  // std::cout << "    " << std::dec<< shift << " " << tsbk.size() << " [ " <<
-  // mask << " ]  = " << result << " - " << ((tsbk >> shift) & bitmask) <<
-  // std::endl;
-  return result;
+unsigned long P25Parser::bitset_shift_left_mask(P25Bits &tsbk, int shift, unsigned long long mask) {
+  return (tsbk.field(0, mask >> shift) << shift) & mask;
 }
 
-std::vector<TrunkMessage> P25Parser::decode_mbt_data(unsigned long opcode, boost::dynamic_bitset<> &header, boost::dynamic_bitset<> &mbt_data, unsigned long sa, unsigned long nac, int sys_num) {
+std::vector<TrunkMessage> P25Parser::decode_mbt_data(unsigned long opcode, P25Bits &header, P25Bits &mbt_data, unsigned long sa, unsigned long nac, int sys_num) {
   std::vector<TrunkMessage> messages;
   TrunkMessage message;
   std::ostringstream os;
@@ -260,7 +249,7 @@ std::vector<TrunkMessage> P25Parser::decode_mbt_data(unsigned long opcode, boost
   return messages;
 }
 
-std::vector<TrunkMessage> P25Parser::decode_tsbk(boost::dynamic_bitset<> &tsbk, unsigned long nac, int sys_num) {
+std::vector<TrunkMessage> P25Parser::decode_tsbk(P25Bits &tsbk, unsigned long nac, int sys_num) {
   // self.stats['tsbks'] += 1
   std::vector<TrunkMessage> messages;
   TrunkMessage message;
@@ -925,10 +914,8 @@ std::vector<TrunkMessage> P25Parser::decode_tsbk(boost::dynamic_bitset<> &tsbk,
   return messages;
 }
 
-void P25Parser::print_bitset(boost::dynamic_bitset<> &tsbk) {
-  /*boost::dynamic_bitset<> bitmask(tsbk.size(), 0x3f);
-     unsigned long result = (tsbk & bitmask).to_ulong();
-     BOOST_LOG_TRIVIAL(debug) << tsbk << " = " << std::hex << result;*/
+void P25Parser::print_bitset(P25Bits &tsbk) {
+  /*BOOST_LOG_TRIVIAL(debug) << std::hex << tsbk.w[1] << " " << tsbk.w[0] << " = " << tsbk.field(0, 0x3f);*/
 }
 
 void printbincharpad(char c) {
@@ -968,34 +955,34 @@ std::vector<TrunkMessage> P25Parser::parse_message(gr::message::sptr msg, System
     return messages;
   }
 
-  std::string s = msg->to_string();
+  // the message is decoded straight out of its buffer, without copying it
+  const unsigned char *s = msg->msg();
+  size_t length = msg->length();
 
-  // # nac is always 1st two bytes
-  // ac = (ord(s[0]) << 8) + ord(s[1])
-  uint8_t s0 = (int)s[0];
-  uint8_t s1 = (int)s[1];
-  int shift = s0 << 8;
-  long nac = shift + s1;
-
-  if (s.length() < 2) {
-    BOOST_LOG_TRIVIAL(error) << "P25 Parse error, s: " << s << " s0: " << static_cast<int>(s0) << " s1: " << static_cast<int>(s1) << " shift: " << shift << " nac: " << nac << " type: " << type << " Len: " << s.length();
+  if (length < 2) {
+    BOOST_LOG_TRIVIAL(error) << "P25 Parse error, type: " << type << " Len: " << length;
     messages.push_back(message);
     return messages;
   }
 
+  // # nac is always 1st two bytes
+  // ac = (ord(s[0]) << 8) + ord(s[1])
+  long nac = (s[0] << 8) + s[1];
+
   if (nac == 0xffff) {
     // # TDMA
     // self.update_state('tdma_duid%d' % type, curr_time)
     messages.push_back(message);
     return messages;
   }
-  s = s.substr(2);
+  s += 2;
+  length -= 2;
 
-  BOOST_LOG_TRIVIAL(trace) << std::hex << "nac " << nac << std::dec << " type " << type << " size " << msg->to_string().length() << " mesg len: " << msg->length();
+  BOOST_LOG_TRIVIAL(trace) << std::hex << "nac " << nac << std::dec << " type " << type << " size " << msg->length() << " mesg len: " << msg->length();
   // //" at %f state %d len %d" %(nac, type, time.time(), self.state, len(s))
   if ((type != 7) && (type != 12)) // and nac not in self.trunked_systems:
   {
-    BOOST_LOG_TRIVIAL(debug) << std::hex << "NON TBSK: nac " << nac << std::dec << " type " << type << " size " << msg->to_string().length() << " mesg len: " << msg->length();
+    BOOST_LOG_TRIVIAL(debug) << std::hex << "NON TBSK: nac " << nac << std::dec << " type " << type << " size " << msg->length() << " mesg len: " << msg->length();
   
     /*
        if not self.configs:
@@ -1007,67 +994,22 @@ std::vector<TrunkMessage> P25Parser::parse_message(gr::message::sptr msg, System
   }
 
   if (type == 7) { // # trunk: TSBK
-    boost::dynamic_bitset<> b((s.length() + 2) * 8);
-
-    for (unsigned int i = 0; i < s.length(); ++i) {
-      unsigned char c = (unsigned char)s[i];
-      b <<= 8;
-
-      for (int j = 0; j < 8; j++) {
-        if (c & 0x1) {
-          b[j] = 1;
-        } else {
-          b[j] = 0;
-        }
-        c >>= 1;
-      }
-    }
-    b <<= 16; // for missing crc
+    P25Bits b;
+    b.load(s, length, 2); // for missing crc
 
     return decode_tsbk(b, nac, sys_num);
   } else if (type == 12) { // # trunk: MBT
-    std::string s1 = s.substr(0, 10);
-    std::string s2 = s.substr(10);
-    boost::dynamic_bitset<> header((s1.length() + 2) * 8);
-
-    for (unsigned int i = 0; i < s1.length(); ++i) {
-      unsigned char c = (unsigned char)s1[i];
-      header <<= 8;
-
-      for (int j = 0; j < 8; j++) {
-        if (c & 0x1) {
-          header[j] = 1;
-        } else {
-          header[j] = 0;
-        }
-        c >>= 1;
-      }
-    }
-    header <<= 16; // for missing crc
-
-    boost::dynamic_bitset<> mbt_data((s2.length() + 4) * 8);
-    for (unsigned int i = 0; i < s2.length(); ++i) {
-      unsigned char c = (unsigned char)s2[i];
-      mbt_data <<= 8;
+    size_t header_length = std::min(length, (size_t)10);
+    P25Bits header;
+    header.load(s, header_length, 2); // for missing crc
 
-      for (int j = 0; j < 8; j++) {
-        if (c & 0x1) {
-          mbt_data[j] = 1;
-        } else {
-          mbt_data[j] = 0;
-        }
-        c >>= 1;
-      }
-    }
-    mbt_data <<= 32; // for missing crc
+    P25Bits mbt_data;
+    mbt_data.load(s + header_length, length - header_length, 4); // for missing crc
     unsigned long opcode = bitset_shift_mask(header, 32, 0x3f);
     unsigned long link_id = bitset_shift_mask(header, 48, 0xffffff);
-    /*BOOST_LOG_TRIVIAL(debug) << "RAW  Data    " <<b;
-    BOOST_LOG_TRIVIAL(debug) << "RAW  Data Length " <<s.length();*/
+    /*BOOST_LOG_TRIVIAL(debug) << "RAW  Data Length " << length;*/
     BOOST_LOG_TRIVIAL(debug) << "MBT:  opcode: $" << std::hex << opcode;
-    /* BOOST_LOG_TRIVIAL(debug) << "MBT  type :$" << std::hex << type << " len $" << std::hex << s1.length() << "/" << s2.length();
-    BOOST_LOG_TRIVIAL(debug) <<  "MBT Header: " <<  header;
-    BOOST_LOG_TRIVIAL(debug) <<  "MBT  Data   " <<  mbt_data; */
+    /* BOOST_LOG_TRIVIAL(debug) << "MBT  type :$" << std::hex << type << " len $" << std::hex << header_length << "/" << length - header_length; */
     return decode_mbt_data(opcode, header, mbt_data, link_id, nac, sys_num);
     // self.trunked_systems[nac].decode_mbt_data(opcode, header << 16, mbt_data
     // << 32)
@@ -2,7 +2,7 @@
 #define P25_PARSE_H
 #include "parser.h"
 #include <bitset>
-#include <boost/dynamic_bitset.hpp>
+#include <cstdint>
 #include <boost/log/trivial.hpp>
 #include <gnuradio/message.h>
 #include "system.h"
@@ -22,6 +22,27 @@ struct Channel {
   double bandwidth;
 };
 
+// The low 256 bits of a TSBK or MBT. The bytes are big endian and followed by zeros in place of
+// the missing CRC, so bit 0 is the LSB of w[0]. Every field that gets decoded is below bit 196.
+struct P25Bits {
+  uint64_t w[4];
+
+  void load(const unsigned char *data, size_t length, int pad_bytes) {
+    w[0] = w[1] = w[2] = w[3] = 0;
+
+    for (int k = pad_bytes; k < 32; k++) {
+      if ((size_t)(k - pad_bytes) >= length) {
+        break;
+      }
+      w[k >> 3] |= (uint64_t)data[length - 1 - (k - pad_bytes)] << ((k & 7) * 8);
+    }
+  }
+
+  constexpr unsigned long field(int shift, unsigned long long mask) const {
+    return (unsigned long)((((w[shift >> 6] >> (shift & 63)) | (((shift & 63) && (shift < 192)) ? (w[(shift >> 6) + 1] << (64 - (shift & 63))) : 0))) & mask);
+  }
+};
+
 class P25Parser : public TrunkParser {
   std::map<int, std::map<int, Channel>> channels;
   std::map<int, Channel>::iterator it;
@@ -30,12 +51,12 @@ public:
   P25Parser();
   long get_tdma_slot(int chan_id, int sys_num);
   double get_bandwidth(int chan_id, int sys_num);
-  std::vector<TrunkMessage> decode_mbt_data(unsigned long opcode, boost::dynamic_bitset<> &header, boost::dynamic_bitset<> &mbt_data, unsigned long link_id, unsigned long nac, int sys_num);
-  std::vector<TrunkMessage> decode_tsbk(boost::dynamic_bitset<> &tsbk, unsigned long nac, int sys_num);
-  unsigned long bitset_shift_mask(boost::dynamic_bitset<> &tsbk, int shift, unsigned long long mask);
-  unsigned long bitset_shift_left_mask(boost::dynamic_bitset<> &tsbk, int shift, unsigned long long mask);
+  std::vector<TrunkMessage> decode_mbt_data(unsigned long opcode, P25Bits &header, P25Bits &mbt_data, unsigned long link_id, unsigned long nac, int sys_num);
+  std::vector<TrunkMessage> decode_tsbk(P25Bits &tsbk, unsigned long nac, int sys_num);
+  unsigned long bitset_shift_mask(P25Bits &tsbk, int shift, unsigned long long mask);
+  unsigned long bitset_shift_left_mask(P25Bits &tsbk, int shift, unsigned long long mask);
   std::string channel_id_to_string(int chan_id, int sys_num);
-  void print_bitset(boost::dynamic_bitset<> &tsbk);
+  void print_bitset(P25Bits &tsbk);
   void add_channel(int chan_id, Channel chan, int sys_num);
   double channel_id_to_frequency(int chan_id, int sys_num);
   std::vector<TrunkMessage> parse_message(gr::message::sptr msg, System *system);
@@ -24,6 +24,7 @@
 #include "smartnet_crc.h"
 #include "smartnet_types.h"
 #include <boost/log/trivial.hpp>
+#include <cstring>
 #include <gnuradio/io_signature.h>
 #include <gnuradio/tags.h>
 #include <sstream>
@@ -174,11 +175,9 @@ int smartnet_crc::work(int noutput_items,
       // parse the message into readable chunks
       smartnet_packet pkt = parse(databits);
 
-      // and throw it at the msgq
-      std::ostringstream payload;
-      payload.str("");
-      payload << pkt.address << "," << pkt.groupflag << "," << pkt.command;
-      gr::message::sptr msg = gr::message::make_from_string(std::string(payload.str()), pkt.command, this->sys_num, 0);
+      // and throw it at the msgq, as is
+      gr::message::sptr msg = gr::message::make(pkt.command, this->sys_num, 0, sizeof(smartnet_packet));
+      memcpy(msg->msg(), &pkt, sizeof(smartnet_packet));
       d_queue->insert_tail(msg);
     } else if (VERBOSE)
       BOOST_LOG_TRIVIAL(info) << "CRC FAILED";
@@ -1,4 +1,5 @@
 #include "smartnet_parser.h"
+#include <cstring>
 #include "../formatter.h"
 
 using namespace std;
@@ -101,7 +102,19 @@ bool SmartnetParser::is_first_normal(int cmd, System *sys) {
   }
 }
 
-std::vector<TrunkMessage> SmartnetParser::parse_message(std::string s,
+std::vector<TrunkMessage> SmartnetParser::parse_message(gr::message::sptr msg, System *system) {
+  if (msg->length() != sizeof(smartnet_packet)) {
+    BOOST_LOG_TRIVIAL(error)
+        << "SmartNet Parser recieved invalid message." << msg->length();
+    return std::vector<TrunkMessage>();
+  }
+
+  smartnet_packet pkt;
+  memcpy(&pkt, msg->msg(), sizeof(smartnet_packet));
+  return parse_message(pkt, system);
+}
+
+std::vector<TrunkMessage> SmartnetParser::parse_message(const smartnet_packet &pkt,
                                                         System *system) {
   std::vector<TrunkMessage> messages;
   TrunkMessage message;
@@ -123,20 +136,11 @@ std::vector<TrunkMessage> SmartnetParser::parse_message(std::string s,
   message.emergency = false;
   message.opcode = 0;
 
-  std::vector<std::string> x;
-  boost::split(x, s, boost::is_any_of(","), boost::token_compress_on);
-
-  if (x.size() < 3) {
-    BOOST_LOG_TRIVIAL(error)
-        << "SmartNet Parser recieved invalid message." << x.size();
-    return messages;
-  }
-
-  int full_address = atoi(x[0].c_str());
+  int full_address = pkt.address;
   int status = full_address & 0x000F;
   long address = full_address & 0xFFF0;
-  int groupflag = atoi(x[1].c_str());
-  int command = atoi(x[2].c_str());
+  int groupflag = pkt.groupflag;
+  int command = pkt.command;
 
   struct osw_stru bosw;
   bosw.id = address;
@@ -190,9 +194,6 @@ std::vector<TrunkMessage> SmartnetParser::parse_message(std::string s,
     return messages;
   }
 
-  x.clear();
-  vector<string>().swap(x);
-
   // raw OSW stream
    //BOOST_LOG_TRIVIAL(info)
    //    << "[" << system->get_short_name()
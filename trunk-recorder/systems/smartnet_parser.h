@@ -1,17 +1,16 @@
 #ifndef SMARTNET_PARSE_H
 #define SMARTNET_PARSE_H
 #include "parser.h"
+#include "smartnet_types.h"
 #include "system.h"
 #include "system_impl.h"
 #include <iostream>
 #include <vector>
 
-#include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/split.hpp>
-#include <boost/tokenizer.hpp>
 #include <stdio.h>
 
 #include <boost/log/trivial.hpp>
+#include <gnuradio/message.h>
 
 // OSW commands range from $000 to $3ff
 // Within this range are 4 ranges for channel indicators
@@ -90,6 +89,7 @@ public:
   bool is_chan_outbound(int cmd, System *system);
   bool is_chan_inbound_obt(int cmd, System *system);
   bool is_first_normal(int cmd, System *system);
-  std::vector<TrunkMessage> parse_message(std::string s, System *system);
+  std::vector<TrunkMessage> parse_message(gr::message::sptr msg, System *system);
+  std::vector<TrunkMessage> parse_message(const smartnet_packet &pkt, System *system);
 };
 #endif
@@ -1,4 +1,7 @@
+#ifndef SMARTNET_TYPES_H
+#define SMARTNET_TYPES_H
 // datatypes for smartnet decoder
+// smartnet_packet is also what gets passed through the msg_queue to the SmartnetParser
 
 struct smartnet_packet {
   unsigned int address;
@@ -6,3 +9,5 @@ struct smartnet_packet {
   unsigned int command;
   unsigned int crc;
 };
+
+#endif
@@ -110,13 +110,17 @@ public:
   virtual std::string get_unit_tags_file() = 0;
   virtual Source *get_source() = 0;
   virtual void set_source(Source *) = 0;
-  virtual Talkgroup *find_talkgroup(long tg) = 0;
-  virtual Talkgroup *find_talkgroup_by_freq(double freq) = 0;
+  virtual std::shared_ptr<const Talkgroup> find_talkgroup(long tg) = 0;
+  virtual std::shared_ptr<const Talkgroup> find_talkgroup_by_freq(double freq) = 0;
   virtual std::string find_unit_tag(long unitID) = 0;
-  virtual void set_talkgroups_file(std::string) = 0;
-  virtual void set_channel_file(std::string channel_file) = 0;
+  virtual bool set_talkgroups_file(std::string) = 0;
+  virtual bool set_channel_file(std::string channel_file) = 0;
   virtual bool has_channel_file() = 0;
   virtual void set_unit_tags_file(std::string) = 0;
+  virtual Talkgroups_Snapshot get_talkgroups_snapshot() = 0;
+  virtual void set_talkgroups_snapshot(Talkgroups_Snapshot talkgroups) = 0;
+  virtual Unit_Tags_Snapshot get_unit_tags_snapshot() = 0;
+  virtual void set_unit_tags_snapshot(Unit_Tags_Snapshot unit_tags) = 0;
   virtual int control_channel_count() = 0;
   virtual void add_control_channel(double channel) = 0;
   virtual double get_next_control_channel() = 0;
@@ -135,7 +139,7 @@ public:
   virtual std::vector<dmr_recorder_sptr> get_conventionalDMR_recorders() = 0;
   virtual std::vector<double> get_channels() = 0;
   virtual std::vector<double> get_control_channels() = 0;
-  virtual std::vector<Talkgroup *> get_talkgroups() = 0;
+  virtual std::vector<std::shared_ptr<const Talkgroup>> get_talkgroups() = 0;
   virtual void set_bandplan(std::string) = 0;
   virtual std::string get_bandplan() = 0;
   virtual void set_bandfreq(int) = 0;
@@ -88,9 +88,9 @@ System_impl::System_impl(int sys_num) {
   xor_mask_len = 0;
   xor_mask = NULL;
   // Setup the talkgroups from the CSV file
-  talkgroups = new Talkgroups();
+  talkgroups = std::make_shared<Talkgroups>();
   // Setup the unit tags from the CSV file
-  unit_tags = new UnitTags();
+  unit_tags = std::make_shared<UnitTags>();
   talkgroup_patches = {};
   d_hideEncrypted = false;
   d_hideUnknown = false;
@@ -294,13 +294,18 @@ std::string System_impl::get_unit_tags_file() {
   return this->unit_tags_file;
 }
 
-void System_impl::set_channel_file(std::string channel_file) {
+bool System_impl::set_channel_file(std::string channel_file) {
   BOOST_LOG_TRIVIAL(info) << "Loading Talkgroups...";
   this->channel_file = channel_file;
-  this->talkgroups->load_channels(sys_num, channel_file);
+  std::shared_ptr<Talkgroups> loaded = std::make_shared<Talkgroups>();
+  if (!loaded->load_channels(sys_num, channel_file)) {
+    return false;
+  }
+  set_talkgroups_snapshot(loaded);
   for (auto& tg : this->get_talkgroups()) {
     this->add_channel(tg->freq);
   }
+  return true;
 }
 
 bool System_impl::has_channel_file() {
@@ -311,16 +316,43 @@ bool System_impl::has_channel_file() {
   }
 }
 
-void System_impl::set_talkgroups_file(std::string talkgroups_file) {
+bool System_impl::set_talkgroups_file(std::string talkgroups_file) {
   BOOST_LOG_TRIVIAL(info) << "Loading Talkgroups...";
   this->talkgroups_file = talkgroups_file;
-  this->talkgroups->load_talkgroups(sys_num, talkgroups_file);
+  std::shared_ptr<Talkgroups> loaded = std::make_shared<Talkgroups>();
+  if (!loaded->load_talkgroups(sys_num, talkgroups_file)) {
+    return false;
+  }
+  set_talkgroups_snapshot(loaded);
+  return true;
 }
 
 void System_impl::set_unit_tags_file(std::string unit_tags_file) {
   BOOST_LOG_TRIVIAL(info) << "Loading Unit Tags...";
   this->unit_tags_file = unit_tags_file;
-  this->unit_tags->load_unit_tags(unit_tags_file);
+  Unit_Tags_Snapshot loaded = std::make_shared<UnitTags>();
+  // a missing Unit Tag file has never stopped trunk-recorder from starting
+  loaded->load_unit_tags(unit_tags_file);
+  set_unit_tags_snapshot(loaded);
+}
+
+// The lookups can come from any thread, a reload swaps the pointer and never
+// changes the Talkgroups or UnitTags a reader might already be holding. A
+// Talkgroup that has been found is kept alive by its own shared_ptr.
+Talkgroups_Snapshot System_impl::get_talkgroups_snapshot() {
+  return std::atomic_load(&talkgroups);
+}
+
+void System_impl::set_talkgroups_snapshot(Talkgroups_Snapshot talkgroups) {
+  std::atomic_store(&this->talkgroups, talkgroups);
+}
+
+Unit_Tags_Snapshot System_impl::get_unit_tags_snapshot() {
+  return std::atomic_load(&unit_tags);
+}
+
+void System_impl::set_unit_tags_snapshot(Unit_Tags_Snapshot unit_tags) {
+  std::atomic_store(&this->unit_tags, unit_tags);
 }
 
 Source *System_impl::get_source() {
@@ -331,23 +363,23 @@ void System_impl::set_source(Source *s) {
   this->source = s;
 }
 
-Talkgroup *System_impl::find_talkgroup(long tg_number) {
-  return talkgroups->find_talkgroup(sys_num, tg_number);
+std::shared_ptr<const Talkgroup> System_impl::find_talkgroup(long tg_number) {
+  return get_talkgroups_snapshot()->find_talkgroup(sys_num, tg_number);
 }
 
-Talkgroup *System_impl::find_talkgroup_by_freq(double freq) {
-  return talkgroups->find_talkgroup_by_freq(sys_num, freq);
+std::shared_ptr<const Talkgroup> System_impl::find_talkgroup_by_freq(double freq) {
+  return get_talkgroups_snapshot()->find_talkgroup_by_freq(sys_num, freq);
 }
 std::string System_impl::find_unit_tag(long unitID) {
-  return unit_tags->find_unit_tag(unitID);
+  return get_unit_tags_snapshot()->find_unit_tag(unitID);
 }
 
 std::vector<double> System_impl::get_channels() {
   return channels;
 }
 
-std::vector<Talkgroup *> System_impl::get_talkgroups() {
-  return talkgroups->get_talkgroups();
+std::vector<std::shared_ptr<const Talkgroup>> System_impl::get_talkgroups() {
+  return get_talkgroups_snapshot()->get_talkgroups();
 }
 int System_impl::channel_count() {
   return channels.size();
@@ -49,8 +49,8 @@ class System_impl : public System {
   int sys_site_id;
 
 public:
-  Talkgroups *talkgroups;
-  UnitTags *unit_tags;
+  Talkgroups_Snapshot talkgroups;
+  Unit_Tags_Snapshot unit_tags;
   p25p2_lfsr *lfsr;
   Source *source;
   std::string talkgroups_file;
@@ -170,13 +170,17 @@ public:
   std::string get_unit_tags_file();
   Source *get_source();
   void set_source(Source *);
-  Talkgroup *find_talkgroup(long tg);
-  Talkgroup *find_talkgroup_by_freq(double freq);
+  std::shared_ptr<const Talkgroup> find_talkgroup(long tg);
+  std::shared_ptr<const Talkgroup> find_talkgroup_by_freq(double freq);
   std::string find_unit_tag(long unitID);
-  void set_talkgroups_file(std::string);
-  void set_channel_file(std::string channel_file);
+  bool set_talkgroups_file(std::string);
+  bool set_channel_file(std::string channel_file);
   bool has_channel_file();
   void set_unit_tags_file(std::string);
+  Talkgroups_Snapshot get_talkgroups_snapshot();
+  void set_talkgroups_snapshot(Talkgroups_Snapshot talkgroups);
+  Unit_Tags_Snapshot get_unit_tags_snapshot();
+  void set_unit_tags_snapshot(Unit_Tags_Snapshot unit_tags);
   int control_channel_count();
   int get_message_count();
   void set_message_count(int count);
@@ -195,7 +199,7 @@ public:
   std::vector<dmr_recorder_sptr> get_conventionalDMR_recorders();
   std::vector<double> get_channels();
   std::vector<double> get_control_channels();
-  std::vector<Talkgroup *> get_talkgroups();
+  std::vector<std::shared_ptr<const Talkgroup>> get_talkgroups();
   gr::msg_queue::sptr msg_queue;
   System_impl(int sys_id);
   void set_bandplan(std::string);
@@ -30,7 +30,7 @@ Talkgroup::Talkgroup(int sys_num, long num, double freq, double tone, std::strin
   this->preferredNAC = 0;
 }
 
-std::string Talkgroup::menu_string() {
+std::string Talkgroup::menu_string() const {
   char buff[150];
 
   // std::ostringstream oss;
@@ -44,11 +44,11 @@ std::string Talkgroup::menu_string() {
   return buffAsStdStr;
 }
 
-int Talkgroup::get_priority() {
+int Talkgroup::get_priority() const {
   return priority;
 }
 
-unsigned long Talkgroup::get_preferredNAC() {
+unsigned long Talkgroup::get_preferredNAC() const {
   return preferredNAC;
 }
 
@@ -57,7 +57,7 @@ void Talkgroup::set_priority(int new_priority) {
   return;
 }
 
-bool Talkgroup::is_active() {
+bool Talkgroup::is_active() const {
   return active;
 }
 
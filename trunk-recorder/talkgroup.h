@@ -25,12 +25,12 @@ public:
   Talkgroup(int sys_num, long num, std::string mode, std::string alpha_tag, std::string description, std::string tag, std::string group, int priority, unsigned long preferredNAC);
   Talkgroup(int sys_num, long num, double freq, double tone, std::string alpha_tag, std::string description, std::string tag, std::string group);
 
-  bool is_active();
-  int get_priority();
-  unsigned long get_preferredNAC();
+  bool is_active() const;
+  int get_priority() const;
+  unsigned long get_preferredNAC() const;
   void set_priority(int new_priority);
   void set_active(bool a);
-  std::string menu_string();
+  std::string menu_string() const;
 
 private:
   unsigned long preferredNAC;
@@ -16,11 +16,19 @@
 
 Talkgroups::Talkgroups() {}
 
+void Talkgroups::add_talkgroup(Talkgroup *loaded) {
+  std::shared_ptr<const Talkgroup> tg(loaded);
+  talkgroups.push_back(tg);
+  // emplace() will not replace an existing entry, so the first row in the file still wins, like the old linear search
+  number_index[tg->sys_num].emplace(tg->number, tg);
+  freq_index[tg->sys_num].emplace(tg->freq, tg);
+}
+
 using namespace csv;
 
-void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
+bool Talkgroups::load_talkgroups(int sys_num, std::string filename) {
   if (filename == "") {
-    return;
+    return true;
   } else {
     BOOST_LOG_TRIVIAL(info) << "Reading Talkgroup CSV File: " << filename;
   }
@@ -37,7 +45,7 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
     BOOST_LOG_TRIVIAL(error) << "The first column must be 'Decimal'";
     BOOST_LOG_TRIVIAL(error) << "Required columns are: 'Decimal', 'Mode', 'Description'";
     BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Hex', 'Category', 'Tag', 'Priority', 'Preferred NAC'";
-    exit(0);
+    return false;
   } else {
     BOOST_LOG_TRIVIAL(info) << "Found Columns: " << internals::format_row(reader.get_col_names(), ", ");
   }
@@ -47,7 +55,7 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       BOOST_LOG_TRIVIAL(error) << "Unknown column header: " << headers[i];
       BOOST_LOG_TRIVIAL(error) << "Required columns are: 'Decimal', 'Mode', 'Description'";
       BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Hex', 'Category', 'Tag', 'Priority', 'Preferred NAC'";
-      exit(0);
+      return false;
     }
   }
 
@@ -67,23 +75,21 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       tg_number = row["Decimal"].get<long>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "'Decimal' is required for specifying the Talkgroup number - Row: " << reader.n_rows();
-      exit(0);
+      return false;
     }
 
     if ((reader.index_of("Mode") >= 0) && row["Mode"].is_str()) {
       mode = row["Mode"].get<std::string>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "Mode is required for Row: " << reader.n_rows();
-      ;
-      exit(0);
+      return false;
     }
 
     if ((reader.index_of("Description") >= 0) && row["Description"].is_str()) {
       description = row["Description"].get<std::string>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "Description is required for Row: " << reader.n_rows();
-      ;
-      exit(0);
+      return false;
     }
 
     if ((reader.index_of("Alpha Tag") >= 0) && row["Alpha Tag"].is_str()) {
@@ -106,17 +112,18 @@ void Talkgroups::load_talkgroups(int sys_num, std::string filename) {
       preferredNAC = row["Preferred NAC"].get<unsigned long>();
     }
     tg = new Talkgroup(sys_num, tg_number, mode, alpha_tag, description, tag, group, priority, preferredNAC);
-    talkgroups.push_back(tg);
+    add_talkgroup(tg);
     lines_pushed++;
   }
 
   BOOST_LOG_TRIVIAL(info) << "Read " << lines_pushed << " talkgroups.";
+  return true;
 }
 
-void Talkgroups::load_channels(int sys_num, std::string filename) {
+bool Talkgroups::load_channels(int sys_num, std::string filename) {
 
   if (filename == "") {
-    return;
+    return true;
   } else {
     BOOST_LOG_TRIVIAL(info) << "Reading Channel CSV File: " << filename;
   }
@@ -133,7 +140,7 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
     BOOST_LOG_TRIVIAL(error) << "The first column must be 'TG Number'";
     BOOST_LOG_TRIVIAL(error) << "Required columns are: 'TG Number', 'Tone', 'Frequency',";
     BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Description', 'Category', 'Tag', 'Enable', 'Comment'";
-    exit(0);
+    return false;
   } else {
     BOOST_LOG_TRIVIAL(info) << "Found Columns: " << internals::format_row(reader.get_col_names(), ", ");
   }
@@ -143,7 +150,7 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
       BOOST_LOG_TRIVIAL(error) << "Unknown column header: " << headers[i];
       BOOST_LOG_TRIVIAL(error) << "Required columns are: 'TG Number', 'Tone', 'Frequency',";
       BOOST_LOG_TRIVIAL(error) << "Optional columns are: 'Alpha Tag', 'Description', 'Category', 'Tag', 'Enable', 'Comment'";
-      exit(0);
+      return false;
     }
   }
 
@@ -165,7 +172,7 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
       tg_number = row["TG Number"].get<long>();
     } else {
       BOOST_LOG_TRIVIAL(error) << "'TG Number' is required for specifying the Talkgroup number - Row: " << reader.n_rows();
-      exit(0);
+      return false;
     }
 
     if ((reader.index_of("Description") >= 0) && row["Description"].is_str()) {
@@ -203,42 +210,45 @@ void Talkgroups::load_channels(int sys_num, std::string filename) {
     }
     if (enable) {
       tg = new Talkgroup(sys_num, tg_number, freq, tone, alpha_tag, description, tag, group);
-      talkgroups.push_back(tg);
+      add_talkgroup(tg);
       lines_pushed++;
     }
 
     BOOST_LOG_TRIVIAL(info) << "Read " << lines_pushed << " channels.";
   }
+  return true;
 }
 
-Talkgroup *Talkgroups::find_talkgroup(int sys_num, long tg_number) {
-  Talkgroup *tg_match = NULL;
+std::shared_ptr<const Talkgroup> Talkgroups::find_talkgroup(int sys_num, long tg_number) const {
+  std::unordered_map<int, std::unordered_map<long, std::shared_ptr<const Talkgroup>>>::const_iterator sys_it = number_index.find(sys_num);
 
-  for (std::vector<Talkgroup *>::iterator it = talkgroups.begin(); it != talkgroups.end(); ++it) {
-    Talkgroup *tg = (Talkgroup *)*it;
+  if (sys_it == number_index.end()) {
+    return NULL;
+  }
 
-    if ((tg->sys_num == sys_num) && (tg->number == tg_number)) {
-      tg_match = tg;
-      break;
-    }
+  std::unordered_map<long, std::shared_ptr<const Talkgroup>>::const_iterator it = sys_it->second.find(tg_number);
+
+  if (it == sys_it->second.end()) {
+    return NULL;
   }
-  return tg_match;
+  return it->second;
 }
 
-Talkgroup *Talkgroups::find_talkgroup_by_freq(int sys_num, double freq) {
-  Talkgroup *tg_match = NULL;
+std::shared_ptr<const Talkgroup> Talkgroups::find_talkgroup_by_freq(int sys_num, double freq) const {
+  std::unordered_map<int, std::unordered_map<double, std::shared_ptr<const Talkgroup>>>::const_iterator sys_it = freq_index.find(sys_num);
+
+  if (sys_it == freq_index.end()) {
+    return NULL;
+  }
 
-  for (std::vector<Talkgroup *>::iterator it = talkgroups.begin(); it != talkgroups.end(); ++it) {
-    Talkgroup *tg = (Talkgroup *)*it;
+  std::unordered_map<double, std::shared_ptr<const Talkgroup>>::const_iterator it = sys_it->second.find(freq);
 
-    if ((tg->sys_num == sys_num) && (tg->freq == freq)) {
-      tg_match = tg;
-      break;
-    }
+  if (it == sys_it->second.end()) {
+    return NULL;
   }
-  return tg_match;
+  return it->second;
 }
 
-std::vector<Talkgroup *> Talkgroups::get_talkgroups() {
+std::vector<std::shared_ptr<const Talkgroup>> Talkgroups::get_talkgroups() const {
   return talkgroups;
 }
@@ -3,18 +3,30 @@
 
 #include "talkgroup.h"
 #include <boost/algorithm/string.hpp>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+// Each Talkgroup is shared, so one that has been looked up stays valid after
+// a reload has replaced the Talkgroups it came from.
 class Talkgroups {
-  std::vector<Talkgroup *> talkgroups;
+  std::vector<std::shared_ptr<const Talkgroup>> talkgroups;
+  // Indexes into talkgroups by System number, then by Talkgroup number or Frequency
+  std::unordered_map<int, std::unordered_map<long, std::shared_ptr<const Talkgroup>>> number_index;
+  std::unordered_map<int, std::unordered_map<double, std::shared_ptr<const Talkgroup>>> freq_index;
+  void add_talkgroup(Talkgroup *tg);
 
 public:
   Talkgroups();
-  void load_talkgroups(int sys_num, std::string filename);
-  void load_channels(int sys_num, std::string filename);
-  Talkgroup *find_talkgroup(int sys_num, long tg);
-  Talkgroup *find_talkgroup_by_freq(int sys_num, double freq);
-  std::vector<Talkgroup *> get_talkgroups();
+  bool load_talkgroups(int sys_num, std::string filename);
+  bool load_channels(int sys_num, std::string filename);
+  std::shared_ptr<const Talkgroup> find_talkgroup(int sys_num, long tg) const;
+  std::shared_ptr<const Talkgroup> find_talkgroup_by_freq(int sys_num, double freq) const;
+  std::vector<std::shared_ptr<const Talkgroup>> get_talkgroups() const;
 };
+
+// A loaded set of Talkgroups is never changed, a reload builds a new one and
+// swaps it in. Calls hold on to the set they started with until they are done.
+typedef std::shared_ptr<const Talkgroups> Talkgroups_Snapshot;
 #endif // TALKGROUPS_H
@@ -13,18 +13,26 @@
 #include <fstream>
 #include <iostream>
 
-UnitTags::UnitTags() {}
+UnitTags::UnitTags() {
+  row_count = 0;
+}
 
-void UnitTags::load_unit_tags(std::string filename) {
+UnitTags::~UnitTags() {
+  for (std::vector<std::pair<int, UnitTag *>>::iterator it = pattern_tags.begin(); it != pattern_tags.end(); ++it) {
+    delete it->second;
+  }
+}
+
+bool UnitTags::load_unit_tags(std::string filename) {
   if (filename == "") {
-    return;
+    return true;
   }
 
   std::ifstream in(filename.c_str());
 
   if (!in.is_open()) {
     BOOST_LOG_TRIVIAL(error) << "Error Opening Unit Tag File: " << filename << std::endl;
-    return;
+    return false;
   }
 
   boost::escaped_list_separator<char> sep("\\", ",\t", "\"");
@@ -74,33 +82,78 @@ void UnitTags::load_unit_tags(std::string filename) {
   } else {
     BOOST_LOG_TRIVIAL(info) << "Read " << lines_pushed << " unit tags.";
   }
+  return true;
 }
 
-std::string UnitTags::find_unit_tag(long tg_number) {
-  std::string tg_num_str = std::to_string(tg_number);
+// Unit Tags are matched in the order they appear in the file. A literal row only wins
+// if none of the pattern rows above it match.
+std::string UnitTags::match_unit_tag(long unitID) {
+  std::string unit_id_str = std::to_string(unitID);
+  int exact_row = row_count;
   std::string tag = "";
 
-  for (std::vector<UnitTag *>::iterator it = unit_tags.begin(); it != unit_tags.end(); ++it) {
-    UnitTag *tg = (UnitTag *)*it;
+  std::unordered_map<std::string, std::pair<int, std::string>>::iterator exact_it = exact_tags.find(unit_id_str);
+  if (exact_it != exact_tags.end()) {
+    exact_row = exact_it->second.first;
+    tag = exact_it->second.second;
+  }
 
-    if (regex_match(tg_num_str, tg->pattern)) {
-      tag = regex_replace(tg_num_str, tg->pattern, tg->tag, boost::regex_constants::format_no_copy | boost::regex_constants::format_all);
+  for (std::vector<std::pair<int, UnitTag *>>::iterator it = pattern_tags.begin(); it != pattern_tags.end(); ++it) {
+    if (it->first > exact_row) {
       break;
     }
+    UnitTag *unit_tag = it->second;
+
+    if (regex_match(unit_id_str, unit_tag->pattern)) {
+      return regex_replace(unit_id_str, unit_tag->pattern, unit_tag->tag, boost::regex_constants::format_no_copy | boost::regex_constants::format_all);
+    }
+  }
+
+  return tag;
+}
+
+std::string UnitTags::find_unit_tag(long unitID) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+
+  std::unordered_map<long, std::list<std::pair<long, std::string>>::iterator>::iterator cache_it = cache_index.find(unitID);
+  if (cache_it != cache_index.end()) {
+    cache.splice(cache.begin(), cache, cache_it->second);
+    return cache_it->second->second;
   }
 
+  std::string tag = match_unit_tag(unitID);
+
+  cache.push_front(std::make_pair(unitID, tag));
+  cache_index[unitID] = cache.begin();
+  if (cache.size() > cache_size) {
+    cache_index.erase(cache.back().first);
+    cache.pop_back();
+  }
   return tag;
 }
 
 void UnitTags::add(std::string pattern, std::string tag) {
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  int row = row_count++;
+
+  cache.clear();
+  cache_index.clear();
+
   // If the pattern is like /someregex/
   if (pattern.substr(0, 1).compare("/") == 0 && pattern.substr(pattern.length()-1, 1).compare("/") == 0) {
     // then remove the / at the beginning and end
     pattern = pattern.substr(1, pattern.length()-2);
+    pattern_tags.push_back(std::make_pair(row, new UnitTag(pattern, tag)));
+  } else if (!pattern.empty() && (pattern.find_first_not_of("0123456789") == std::string::npos)) {
+    // a simple ID can be looked up directly, the tag is formatted now the same way the regex would have
+    if (exact_tags.find(pattern) == exact_tags.end()) {
+      UnitTag unit_tag("^" + pattern + "$", tag);
+      std::string formatted = regex_replace(pattern, unit_tag.pattern, unit_tag.tag, boost::regex_constants::format_no_copy | boost::regex_constants::format_all);
+      exact_tags[pattern] = std::make_pair(row, formatted);
+    }
   } else {
     // otherwise add ^ and $ to the pattern e.g. ^123$ to make a regex for simple IDs
     pattern = "^" + pattern + "$";
+    pattern_tags.push_back(std::make_pair(row, new UnitTag(pattern, tag)));
   }
-  UnitTag *unit_tag = new UnitTag(pattern, tag);
-  unit_tags.push_back(unit_tag);
 }
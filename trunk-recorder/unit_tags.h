@@ -3,16 +3,38 @@
 
 #include "unit_tag.h"
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class UnitTags {
-  std::vector<UnitTag *> unit_tags;
+  // Rows that are a plain Unit ID, keyed by the ID. Holds the row number and the finished tag.
+  std::unordered_map<std::string, std::pair<int, std::string>> exact_tags;
+  // Rows that are a /regex/, in the order they appear in the file
+  std::vector<std::pair<int, UnitTag *>> pattern_tags;
+  int row_count;
+
+  // Recently resolved Unit IDs, most recent first
+  static const size_t cache_size = 1024;
+  std::list<std::pair<long, std::string>> cache;
+  std::unordered_map<long, std::list<std::pair<long, std::string>>::iterator> cache_index;
+  std::mutex cache_mutex;
+
+  std::string match_unit_tag(long unitID);
 
 public:
   UnitTags();
-  void load_unit_tags(std::string filename);
+  ~UnitTags();
+  bool load_unit_tags(std::string filename);
   std::string find_unit_tag(long unitID);
   void add(std::string pattern, std::string tag);
 };
+
+// Like Talkgroups, a reload swaps in a new set of UnitTags rather than changing
+// the one in use. Only the lookup cache changes after loading.
+typedef std::shared_ptr<UnitTags> Unit_Tags_Snapshot;
 #endif // UNIT_TAGS_H